@@ -106,7 +106,7 @@ private:
      * write one polygon to output file.
      * Polygon coordinates are expected scaled by the polugon extraction function
      */
-    void OuputOnePolygon( SHAPE_LINE_CHAIN & aPolygon, const char* aBrdLayerName );
+    void OuputOnePolygon( const SHAPE_LINE_CHAIN& aPolygon, const char* aBrdLayerName );
 
 };
 
@@ -312,7 +312,7 @@ void BITMAPCONV_INFO::OuputFileEnd()
  * write one polygon to output file.
  * Polygon coordinates are expected scaled by the polygon extraction function
  */
-void BITMAPCONV_INFO::OuputOnePolygon( SHAPE_LINE_CHAIN & aPolygon, const char* aBrdLayerName )
+void BITMAPCONV_INFO::OuputOnePolygon( const SHAPE_LINE_CHAIN& aPolygon, const char* aBrdLayerName )
 {
     int ii, jj;
     VECTOR2I currpoint;
@@ -501,7 +501,7 @@ void BITMAPCONV_INFO::CreateOutputFile( BMP2CMP_MOD_LAYER aModLayer )
             // Output current resulting polygon(s)
             for( int ii = 0; ii < polyset_areas.OutlineCount(); ii++ )
             {
-                SHAPE_LINE_CHAIN& poly = polyset_areas.Outline( ii );
+                const SHAPE_LINE_CHAIN& poly = polyset_areas.COutline( ii );
                 OuputOnePolygon(poly, getBrdLayerName( aModLayer ) );
             }
 
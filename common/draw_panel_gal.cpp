@@ -147,10 +147,11 @@ void EDA_DRAW_PANEL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
     m_gal->BeginDrawing();
     m_gal->ClearScreen( m_painter->GetSettings()->GetBackgroundColor() );
 
+    // Limits redrawing to the changed part of the view, if the GAL supports it
+    m_view->ClearTargets();
+
     if( m_view->IsDirty() )
     {
-        m_view->ClearTargets();
-
         // Grid has to be redrawn only when the NONCACHED target is redrawn
         if( m_view->IsTargetDirty( KIGFX::TARGET_NONCACHED ) )
             m_gal->DrawGrid();
@@ -127,6 +127,30 @@ void CAIRO_COMPOSITOR::ClearBuffer()
 }
 
 
+void CAIRO_COMPOSITOR::ClearBuffer( const BOX2I& aArea )
+{
+    BOX2I area = BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( m_width, m_height ) ).Intersect( aArea );
+
+    if( area.GetArea() <= 0 )
+        return;
+
+    CAIRO_BUFFER& buffer = m_buffers[m_current];
+    unsigned int pitch = m_stride / sizeof(int);   // number of pixels in a row
+
+    cairo_surface_flush( buffer.surface );
+
+    // Clear the pixel storage row by row
+    for( int y = area.GetTop(); y < area.GetBottom(); ++y )
+    {
+        memset( buffer.bitmap.get() + y * pitch + area.GetLeft(), 0x00,
+                area.GetWidth() * sizeof(int) );
+    }
+
+    cairo_surface_mark_dirty_rectangle( buffer.surface, area.GetX(), area.GetY(),
+                                        area.GetWidth(), area.GetHeight() );
+}
+
+
 void CAIRO_COMPOSITOR::DrawBuffer( unsigned int aBufferHandle )
 {
     wxASSERT_MSG( aBufferHandle <= usedBuffers(), wxT( "Tried to use a not existing buffer" ) );
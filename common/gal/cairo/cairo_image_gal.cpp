@@ -0,0 +1,1134 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2012 Torsten Hueter, torstenhtr <at> gmx.de
+ * Copyright (C) 2012 Kicad Developers, see change_log.txt for contributors.
+ *
+ * CAIRO_IMAGE_GAL - Graphics Abstraction Layer for Cairo rendering to an image
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <wx/log.h>
+
+#include <gal/cairo/cairo_image_gal.h>
+#include <gal/cairo/cairo_compositor.h>
+#include <gal/definitions.h>
+
+#include <limits>
+
+using namespace KIGFX;
+
+
+const float CAIRO_IMAGE_GAL::LAYER_ALPHA = 0.8;
+
+
+CAIRO_IMAGE_GAL::CAIRO_IMAGE_GAL( int aWidth, int aHeight )
+{
+    // Initialize the flags
+    isGrouping          = false;
+    isInitialized       = false;
+    isScreenValid       = false;
+    validCompositor     = false;
+    groupCounter        = 0;
+
+    screenSize = VECTOR2I( aWidth, aHeight );
+
+    // Grid color settings are different in Cairo and OpenGL
+    SetGridColor( COLOR4D( 0.1, 0.1, 0.1, 0.8 ) );
+
+    // Allocate memory for pixel storage
+    allocateBitmaps();
+
+    initSurface();
+}
+
+
+CAIRO_IMAGE_GAL::~CAIRO_IMAGE_GAL()
+{
+    deinitSurface();
+    deleteBitmaps();
+
+    ClearCache();
+}
+
+
+void CAIRO_IMAGE_GAL::BeginDrawing()
+{
+    initSurface();
+
+    if( !validCompositor )
+        setCompositor();
+
+    // Redraw the whole screen, unless told otherwise by SetDamagedArea()
+    damagedArea = BOX2I( VECTOR2I( 0, 0 ), screenSize );
+
+    compositor->SetMainContext( context );
+    compositor->SetBuffer( mainBuffer );
+    clipDamagedArea();
+
+    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
+    cairo_push_group( currentContext );
+}
+
+
+void CAIRO_IMAGE_GAL::EndDrawing()
+{
+    // Force remaining objects to be drawn
+    Flush();
+
+    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
+    cairo_pop_group_to_source( currentContext );
+    cairo_paint_with_alpha( currentContext, LAYER_ALPHA );
+
+    if( damagedArea.GetArea() > 0 )
+    {
+        // Merge buffers, only the damaged part has changed
+        cairo_matrix_t matrix;
+        cairo_get_matrix( context, &matrix );
+        cairo_identity_matrix( context );
+        cairo_rectangle( context, damagedArea.GetX(), damagedArea.GetY(),
+                         damagedArea.GetWidth(), damagedArea.GetHeight() );
+        cairo_clip( context );
+        cairo_set_matrix( context, &matrix );
+
+        cairo_set_source_rgb( context, backgroundColor.r, backgroundColor.g, backgroundColor.b );
+        cairo_paint( context );
+
+        compositor->DrawBuffer( mainBuffer );
+        compositor->DrawBuffer( overlayBuffer );
+
+        cairo_surface_flush( surface );
+    }
+
+    isScreenValid = true;
+
+    deinitSurface();
+}
+
+
+void CAIRO_IMAGE_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    cairo_move_to( currentContext, aStartPoint.x, aStartPoint.y );
+    cairo_line_to( currentContext, aEndPoint.x, aEndPoint.y );
+    isElementAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                                   double aWidth )
+{
+    if( isFillEnabled )
+    {
+        // Filled tracks mode
+        SetLineWidth( aWidth );
+
+        cairo_move_to( currentContext, (double) aStartPoint.x, (double) aStartPoint.y );
+        cairo_line_to( currentContext, (double) aEndPoint.x, (double) aEndPoint.y );
+    }
+    else
+    {
+        // Outline mode for tracks
+        VECTOR2D startEndVector = aEndPoint - aStartPoint;
+        double   lineAngle      = atan2( startEndVector.y, startEndVector.x );
+        double   lineLength     = startEndVector.EuclideanNorm();
+
+        cairo_save( currentContext );
+
+        cairo_translate( currentContext, aStartPoint.x, aStartPoint.y );
+        cairo_rotate( currentContext, lineAngle );
+
+        cairo_arc( currentContext, 0.0,        0.0, aWidth / 2.0,  M_PI / 2.0, 3.0 * M_PI / 2.0 );
+        cairo_arc( currentContext, lineLength, 0.0, aWidth / 2.0, -M_PI / 2.0, M_PI / 2.0 );
+
+        cairo_move_to( currentContext, 0.0,        aWidth / 2.0 );
+        cairo_line_to( currentContext, lineLength, aWidth / 2.0 );
+
+        cairo_move_to( currentContext, 0.0,        -aWidth / 2.0 );
+        cairo_line_to( currentContext, lineLength, -aWidth / 2.0 );
+
+        cairo_restore( currentContext );
+    }
+
+    isElementAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
+{
+    // A circle is drawn using an arc
+    cairo_new_sub_path( currentContext );
+    cairo_arc( currentContext, aCenterPoint.x, aCenterPoint.y, aRadius, 0.0, 2 * M_PI );
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+                               double aEndAngle )
+{
+    SWAP( aStartAngle, >, aEndAngle );
+
+    cairo_new_sub_path( currentContext );
+    cairo_arc( currentContext, aCenterPoint.x, aCenterPoint.y, aRadius, aStartAngle, aEndAngle );
+
+    if( isFillEnabled )
+    {
+        VECTOR2D startPoint( cos( aStartAngle ) * aRadius + aCenterPoint.x,
+                             sin( aStartAngle ) * aRadius + aCenterPoint.y );
+        VECTOR2D endPoint( cos( aEndAngle ) * aRadius + aCenterPoint.x,
+                           sin( aEndAngle ) * aRadius + aCenterPoint.y );
+
+        cairo_move_to( currentContext, aCenterPoint.x, aCenterPoint.y );
+        cairo_line_to( currentContext, startPoint.x, startPoint.y );
+        cairo_line_to( currentContext, endPoint.x, endPoint.y );
+        cairo_close_path( currentContext );
+    }
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    // Always go around the rectangle in the same direction (the one of arcs), so rectangles
+    // filled together do not cancel each other out with the winding fill rule
+    VECTOR2D startPoint( std::min( aStartPoint.x, aEndPoint.x ),
+                         std::min( aStartPoint.y, aEndPoint.y ) );
+    VECTOR2D endPoint( std::max( aStartPoint.x, aEndPoint.x ),
+                       std::max( aStartPoint.y, aEndPoint.y ) );
+
+    // Calculate the diagonal points
+    VECTOR2D diagonalPointA( endPoint.x,  startPoint.y );
+    VECTOR2D diagonalPointB( startPoint.x, endPoint.y );
+
+    // The path is composed from 4 segments
+    cairo_move_to( currentContext, startPoint.x, startPoint.y );
+    cairo_line_to( currentContext, diagonalPointA.x, diagonalPointA.y );
+    cairo_line_to( currentContext, endPoint.x, endPoint.y );
+    cairo_line_to( currentContext, diagonalPointB.x, diagonalPointB.y );
+    cairo_close_path( currentContext );
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawPolyline( std::deque<VECTOR2D>& aPointList )
+{
+    // The direction does not change the stroke, but matters if the polyline is filled
+    drawPointList( aPointList );
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
+{
+    drawPointList( aPointList );
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
+                                 const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint )
+{
+    cairo_move_to( currentContext, aStartPoint.x, aStartPoint.y );
+    cairo_curve_to( currentContext, aControlPointA.x, aControlPointA.y, aControlPointB.x,
+                    aControlPointB.y, aEndPoint.x, aEndPoint.y );
+    cairo_line_to( currentContext, aEndPoint.x, aEndPoint.y );
+
+    isElementAdded = true;
+    isFillableAdded = true;
+}
+
+
+void CAIRO_IMAGE_GAL::ResizeScreen( int aWidth, int aHeight )
+{
+    screenSize = VECTOR2I( aWidth, aHeight );
+
+    // Recreate the bitmaps
+    deleteBitmaps();
+    allocateBitmaps();
+
+    if( validCompositor )
+        compositor->Resize( aWidth, aHeight );
+
+    validCompositor = false;
+}
+
+
+void CAIRO_IMAGE_GAL::Flush()
+{
+    storePath();
+}
+
+
+void CAIRO_IMAGE_GAL::ClearScreen( const COLOR4D& aColor )
+{
+    // The background is painted while compositing buffers in EndDrawing()
+    if( backgroundColor == aColor )
+        return;
+
+    backgroundColor = aColor;
+    isScreenValid = false;
+}
+
+
+void CAIRO_IMAGE_GAL::SetIsFill( bool aIsFillEnabled )
+{
+    // Primitives are added to the current path as long as the fill and stroke settings
+    // do not change
+    if( isGrouping || isFillEnabled != aIsFillEnabled )
+        storePath();
+
+    isFillEnabled = aIsFillEnabled;
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SET_FILL;
+        groupElement.boolArgument = aIsFillEnabled;
+        currentGroup->push_back( groupElement );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetIsStroke( bool aIsStrokeEnabled )
+{
+    if( isGrouping || isStrokeEnabled != aIsStrokeEnabled )
+        storePath();
+
+    isStrokeEnabled = aIsStrokeEnabled;
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SET_STROKE;
+        groupElement.boolArgument = aIsStrokeEnabled;
+        currentGroup->push_back( groupElement );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetStrokeColor( const COLOR4D& aColor )
+{
+    if( isGrouping || strokeColor != aColor )
+        storePath();
+
+    strokeColor = aColor;
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SET_STROKECOLOR;
+        groupElement.arguments[0] = strokeColor.r;
+        groupElement.arguments[1] = strokeColor.g;
+        groupElement.arguments[2] = strokeColor.b;
+        groupElement.arguments[3] = strokeColor.a;
+        currentGroup->push_back( groupElement );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetFillColor( const COLOR4D& aColor )
+{
+    if( isGrouping || fillColor != aColor )
+        storePath();
+
+    fillColor = aColor;
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SET_FILLCOLOR;
+        groupElement.arguments[0] = fillColor.r;
+        groupElement.arguments[1] = fillColor.g;
+        groupElement.arguments[2] = fillColor.b;
+        groupElement.arguments[3] = fillColor.a;
+        currentGroup->push_back( groupElement );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetLineWidth( double aLineWidth )
+{
+    lineWidth = aLineWidth;
+
+    if( isGrouping )
+    {
+        storePath();
+
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SET_LINE_WIDTH;
+        groupElement.arguments[0] = aLineWidth;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        // The current path is stored only if the width changes, filling does not depend on it
+        setCairoLineWidth( aLineWidth );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetLayerDepth( double aLayerDepth )
+{
+    super::SetLayerDepth( aLayerDepth );
+
+    if( isInitialized )
+    {
+        storePath();
+
+        cairo_pop_group_to_source( currentContext );
+        cairo_paint_with_alpha( currentContext, LAYER_ALPHA );
+
+        cairo_push_group( currentContext );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::Transform( const MATRIX3x3D& aTransformation )
+{
+    storePath();
+
+    cairo_matrix_t cairoTransformation;
+
+    cairo_matrix_init( &cairoTransformation,
+                       aTransformation.m_data[0][0],
+                       aTransformation.m_data[1][0],
+                       aTransformation.m_data[0][1],
+                       aTransformation.m_data[1][1],
+                       aTransformation.m_data[0][2],
+                       aTransformation.m_data[1][2] );
+
+    cairo_transform( currentContext, &cairoTransformation );
+}
+
+
+void CAIRO_IMAGE_GAL::Rotate( double aAngle )
+{
+    storePath();
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_ROTATE;
+        groupElement.arguments[0] = aAngle;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        cairo_rotate( currentContext, aAngle );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::Translate( const VECTOR2D& aTranslation )
+{
+    storePath();
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_TRANSLATE;
+        groupElement.arguments[0] = aTranslation.x;
+        groupElement.arguments[1] = aTranslation.y;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        cairo_translate( currentContext, aTranslation.x, aTranslation.y );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::Scale( const VECTOR2D& aScale )
+{
+    storePath();
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SCALE;
+        groupElement.arguments[0] = aScale.x;
+        groupElement.arguments[1] = aScale.y;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        cairo_scale( currentContext, aScale.x, aScale.y );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::Save()
+{
+    storePath();
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_SAVE;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        cairo_save( currentContext );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::Restore()
+{
+    storePath();
+
+    if( isGrouping )
+    {
+        GROUP_ELEMENT groupElement;
+        groupElement.command = CMD_RESTORE;
+        currentGroup->push_back( groupElement );
+    }
+    else
+    {
+        cairo_restore( currentContext );
+    }
+}
+
+
+int CAIRO_IMAGE_GAL::BeginGroup()
+{
+    initSurface();
+
+    // If the grouping is started: the actual path is stored in the group, when
+    // a attribute was changed or when grouping stops with the end group method.
+    storePath();
+
+    GROUP group;
+    int groupNumber = getNewGroupNumber();
+    groups.insert( std::make_pair( groupNumber, group ) );
+    currentGroup = &groups[groupNumber];
+    isGrouping   = true;
+
+    return groupNumber;
+}
+
+
+void CAIRO_IMAGE_GAL::EndGroup()
+{
+    storePath();
+    isGrouping = false;
+
+    deinitSurface();
+}
+
+
+void CAIRO_IMAGE_GAL::DrawGroup( int aGroupNumber )
+{
+    // This method implements a small Virtual Machine - all stored commands
+    // are executed; nested calling is also possible
+
+    // Stroked and filled paths are collected and drawn at once, as long as the stroke and fill
+    // settings do not change. Consecutive groups (e.g. tracks or pads of a layer) end up in a
+    // single Cairo path this way. Filled paths do not cancel each other out with the winding
+    // fill rule, as all primitives go around their area in the same direction.
+    if( isElementAdded )
+        storePath();
+
+    for( GROUP::iterator it = groups[aGroupNumber].begin();
+         it != groups[aGroupNumber].end(); ++it )
+    {
+        switch( it->command )
+        {
+        case CMD_SET_FILL:
+            isFillEnabled = it->boolArgument;
+            break;
+
+        case CMD_SET_STROKE:
+            isStrokeEnabled = it->boolArgument;
+            break;
+
+        case CMD_SET_FILLCOLOR:
+            {
+                COLOR4D color( it->arguments[0], it->arguments[1], it->arguments[2],
+                               it->arguments[3] );
+
+                if( color != fillColor )
+                {
+                    if( !groupFills.empty() )
+                        drawGroupPaths( groupFills, true );
+
+                    fillColor = color;
+                }
+            }
+            break;
+
+        case CMD_SET_STROKECOLOR:
+            {
+                COLOR4D color( it->arguments[0], it->arguments[1], it->arguments[2],
+                               it->arguments[3] );
+
+                if( color != strokeColor )
+                {
+                    if( !groupStrokes.empty() )
+                        drawGroupPaths( groupStrokes, false );
+
+                    strokeColor = color;
+                }
+            }
+            break;
+
+        case CMD_SET_LINE_WIDTH:
+            setCairoLineWidth( it->arguments[0] );
+            break;
+
+        case CMD_STROKE_PATH:
+            // Keep the drawing order of fills and strokes, unless they have the same color
+            if( !groupFills.empty() && fillColor != strokeColor )
+                drawGroupPaths( groupFills, true );
+
+            groupStrokes.push_back( it->cairoPath );
+            break;
+
+        case CMD_FILL_PATH:
+            if( !groupStrokes.empty() && fillColor != strokeColor )
+                drawGroupPaths( groupStrokes, false );
+
+            groupFills.push_back( it->cairoPath );
+            break;
+
+        case CMD_TRANSFORM:
+            storePath();
+            cairo_matrix_t matrix;
+            cairo_matrix_init( &matrix, it->arguments[0], it->arguments[1], it->arguments[2],
+                               it->arguments[3], it->arguments[4], it->arguments[5] );
+            cairo_transform( currentContext, &matrix );
+            break;
+
+        case CMD_ROTATE:
+            storePath();
+            cairo_rotate( currentContext, it->arguments[0] );
+            break;
+
+        case CMD_TRANSLATE:
+            storePath();
+            cairo_translate( currentContext, it->arguments[0], it->arguments[1] );
+            break;
+
+        case CMD_SCALE:
+            storePath();
+            cairo_scale( currentContext, it->arguments[0], it->arguments[1] );
+            break;
+
+        case CMD_SAVE:
+            storePath();
+            cairo_save( currentContext );
+            break;
+
+        case CMD_RESTORE:
+            storePath();
+            cairo_restore( currentContext );
+            break;
+
+        case CMD_CALL_GROUP:
+            DrawGroup( it->intArgument );
+            break;
+        }
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor )
+{
+    storePath();
+
+    for( GROUP::iterator it = groups[aGroupNumber].begin();
+         it != groups[aGroupNumber].end(); ++it )
+    {
+        if( it->command == CMD_SET_FILLCOLOR || it->command == CMD_SET_STROKECOLOR )
+        {
+            it->arguments[0] = aNewColor.r;
+            it->arguments[1] = aNewColor.g;
+            it->arguments[2] = aNewColor.b;
+            it->arguments[3] = aNewColor.a;
+        }
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::ChangeGroupDepth( int aGroupNumber, int aDepth )
+{
+    // Cairo does not have any possibilities to change the depth coordinate of stored items,
+    // it depends only on the order of drawing
+}
+
+
+void CAIRO_IMAGE_GAL::DeleteGroup( int aGroupNumber )
+{
+    storePath();
+
+    // Delete the Cairo paths
+    std::deque<GROUP_ELEMENT>::iterator it, end;
+
+    for( it = groups[aGroupNumber].begin(), end = groups[aGroupNumber].end(); it != end; ++it )
+    {
+        if( it->command == CMD_FILL_PATH || it->command == CMD_STROKE_PATH )
+        {
+            cairo_path_destroy( it->cairoPath );
+        }
+    }
+
+    // Delete the group
+    groups.erase( aGroupNumber );
+}
+
+
+void CAIRO_IMAGE_GAL::ClearCache()
+{
+    for( int i = groups.size() - 1; i >= 0; --i )
+    {
+        DeleteGroup( i );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SaveScreen()
+{
+    // Copy the current bitmap to the backup buffer
+    int offset = 0;
+
+    for( int j = 0; j < screenSize.y; j++ )
+    {
+        for( int i = 0; i < stride; i++ )
+        {
+            bitmapBufferBackup[offset + i] = bitmapBuffer[offset + i];
+            offset += stride;
+        }
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::RestoreScreen()
+{
+    int offset = 0;
+
+    for( int j = 0; j < screenSize.y; j++ )
+    {
+        for( int i = 0; i < stride; i++ )
+        {
+            bitmapBuffer[offset + i] = bitmapBufferBackup[offset + i];
+            offset += stride;
+        }
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::SetTarget( RENDER_TARGET aTarget )
+{
+    // If the compositor is not set, that means that there is a recaching process going on
+    // and we do not need the compositor now
+    if( !validCompositor )
+        return;
+
+    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
+    if( isInitialized )
+    {
+        storePath();
+
+        cairo_pop_group_to_source( currentContext );
+        cairo_paint_with_alpha( currentContext, LAYER_ALPHA );
+    }
+
+    switch( aTarget )
+    {
+    default:
+    case TARGET_CACHED:
+    case TARGET_NONCACHED:
+        compositor->SetBuffer( mainBuffer );
+        break;
+
+    case TARGET_OVERLAY:
+        compositor->SetBuffer( overlayBuffer );
+        break;
+    }
+
+    if( isInitialized )
+    {
+        clipDamagedArea();
+        cairo_push_group( currentContext );
+    }
+
+    currentTarget = aTarget;
+}
+
+
+RENDER_TARGET CAIRO_IMAGE_GAL::GetTarget() const
+{
+    return currentTarget;
+}
+
+
+void CAIRO_IMAGE_GAL::ClearTarget( RENDER_TARGET aTarget )
+{
+    // Save the current state
+    unsigned int currentBuffer = compositor->GetBuffer();
+
+    switch( aTarget )
+    {
+    // Cached and noncached items are rendered to the same buffer
+    default:
+    case TARGET_CACHED:
+    case TARGET_NONCACHED:
+        compositor->SetBuffer( mainBuffer );
+        break;
+
+    case TARGET_OVERLAY:
+        compositor->SetBuffer( overlayBuffer );
+        break;
+    }
+
+    compositor->ClearBuffer( damagedArea );
+
+    // Restore the previous state
+    compositor->SetBuffer( currentBuffer );
+}
+
+
+bool CAIRO_IMAGE_GAL::SetDamagedArea( const BOX2I& aArea )
+{
+    // Buffers have to be composited again on the whole screen
+    if( !isScreenValid || !isInitialized )
+        return false;
+
+    storePath();
+
+    // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
+    cairo_pop_group_to_source( currentContext );
+    cairo_paint_with_alpha( currentContext, LAYER_ALPHA );
+
+    BOX2I area( aArea );
+    area.Normalize();
+    damagedArea = BOX2I( VECTOR2I( 0, 0 ), screenSize ).Intersect( area );
+
+    clipDamagedArea();
+    cairo_push_group( currentContext );
+
+    return true;
+}
+
+
+bool CAIRO_IMAGE_GAL::SaveImage( const std::string& aFileName ) const
+{
+    if( !isScreenValid )
+        return false;
+
+    // Wrap the pixels of the last rendered frame, so they do not need to be copied
+    cairo_surface_t* image = cairo_image_surface_create_for_data( (unsigned char*) bitmapBuffer,
+                                                                  GAL_FORMAT, screenSize.x,
+                                                                  screenSize.y, stride );
+    cairo_status_t status = cairo_surface_write_to_png( image, aFileName.c_str() );
+    cairo_surface_destroy( image );
+
+    return status == CAIRO_STATUS_SUCCESS;
+}
+
+
+void CAIRO_IMAGE_GAL::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+{
+    cairo_move_to( currentContext, aStartPoint.x, aStartPoint.y );
+    cairo_line_to( currentContext, aEndPoint.x, aEndPoint.y );
+    cairo_set_source_rgb( currentContext, gridColor.r, gridColor.g, gridColor.b );
+    cairo_stroke( currentContext );
+}
+
+
+void CAIRO_IMAGE_GAL::storePath()
+{
+    if( !groupFills.empty() )
+        drawGroupPaths( groupFills, true );
+
+    if( !groupStrokes.empty() )
+        drawGroupPaths( groupStrokes, false );
+
+    if( isElementAdded )
+    {
+        // Lines and segments enclose no area, there is nothing to fill
+        bool fill = isFillEnabled && isFillableAdded;
+
+        isElementAdded = false;
+        isFillableAdded = false;
+
+        if( !isGrouping )
+        {
+            if( fill )
+            {
+                cairo_set_source_rgb( currentContext, fillColor.r, fillColor.g, fillColor.b );
+                cairo_fill_preserve( currentContext );
+            }
+
+            if( isStrokeEnabled )
+            {
+                cairo_set_source_rgb( currentContext, strokeColor.r, strokeColor.g,
+                                      strokeColor.b );
+                cairo_stroke_preserve( currentContext );
+            }
+        }
+        else
+        {
+            // Copy the actual path, append it to the global path list
+            // then check, if the path needs to be stroked/filled and
+            // add this command to the group list;
+            if( isStrokeEnabled )
+            {
+                GROUP_ELEMENT groupElement;
+                groupElement.cairoPath = cairo_copy_path( currentContext );
+                groupElement.command   = CMD_STROKE_PATH;
+                currentGroup->push_back( groupElement );
+            }
+
+            if( fill )
+            {
+                GROUP_ELEMENT groupElement;
+                groupElement.cairoPath = cairo_copy_path( currentContext );
+                groupElement.command   = CMD_FILL_PATH;
+                currentGroup->push_back( groupElement );
+            }
+        }
+
+        cairo_new_path( currentContext );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::drawGroupPaths( std::vector<cairo_path_t*>& aPaths, bool aFill )
+{
+    cairo_path_t* currentPath = NULL;
+
+    // Do not mix the paths with the path that is being currently drawn
+    if( isElementAdded )
+    {
+        currentPath = cairo_copy_path( currentContext );
+        cairo_new_path( currentContext );
+    }
+
+    for( std::vector<cairo_path_t*>::const_iterator it = aPaths.begin();
+         it != aPaths.end(); ++it )
+    {
+        cairo_append_path( currentContext, *it );
+    }
+
+    if( aFill )
+    {
+        cairo_set_source_rgb( currentContext, fillColor.r, fillColor.g, fillColor.b );
+        cairo_fill( currentContext );
+    }
+    else
+    {
+        cairo_set_source_rgb( currentContext, strokeColor.r, strokeColor.g, strokeColor.b );
+        cairo_stroke( currentContext );
+    }
+
+    aPaths.clear();
+
+    if( currentPath )
+    {
+        cairo_append_path( currentContext, currentPath );
+        cairo_path_destroy( currentPath );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::drawPointList( const std::deque<VECTOR2D>& aPointList )
+{
+    // Twice the signed area, positive for the direction of arcs drawn by Cairo
+    double area = 0.0;
+    std::deque<VECTOR2D>::const_iterator prev = aPointList.end() - 1;
+
+    for( std::deque<VECTOR2D>::const_iterator it = aPointList.begin();
+         it != aPointList.end(); prev = it, ++it )
+    {
+        area += prev->x * it->y - it->x * prev->y;
+    }
+
+    if( area >= 0.0 )
+    {
+        std::deque<VECTOR2D>::const_iterator it = aPointList.begin();
+
+        cairo_move_to( currentContext, it->x, it->y );
+
+        for( ++it; it != aPointList.end(); ++it )
+            cairo_line_to( currentContext, it->x, it->y );
+    }
+    else
+    {
+        std::deque<VECTOR2D>::const_reverse_iterator it = aPointList.rbegin();
+
+        cairo_move_to( currentContext, it->x, it->y );
+
+        for( ++it; it != aPointList.rend(); ++it )
+            cairo_line_to( currentContext, it->x, it->y );
+    }
+}
+
+
+void CAIRO_IMAGE_GAL::setCairoLineWidth( double aLineWidth )
+{
+    // Make lines appear at least 1 pixel wide, no matter of zoom
+    double x = 1.0, y = 1.0;
+    cairo_device_to_user_distance( currentContext, &x, &y );
+    double minWidth = std::min( fabs( x ), fabs( y ) );
+    double width = std::max( aLineWidth, minWidth );
+
+    // Paths drawn so far can be stroked together with the following ones
+    if( width == cairo_get_line_width( currentContext ) )
+        return;
+
+    // Collected fills do not depend on the line width, they may be drawn later
+    if( !groupStrokes.empty() )
+        drawGroupPaths( groupStrokes, false );
+
+    if( isElementAdded )
+        storePath();
+
+    cairo_set_line_width( currentContext, width );
+}
+
+
+void CAIRO_IMAGE_GAL::clipDamagedArea()
+{
+    cairo_matrix_t matrix;
+
+    cairo_get_matrix( currentContext, &matrix );
+    cairo_identity_matrix( currentContext );
+
+    cairo_reset_clip( currentContext );
+    cairo_rectangle( currentContext, damagedArea.GetX(), damagedArea.GetY(),
+                     damagedArea.GetWidth(), damagedArea.GetHeight() );
+    cairo_clip( currentContext );
+
+    cairo_set_matrix( currentContext, &matrix );
+}
+
+
+void CAIRO_IMAGE_GAL::allocateBitmaps()
+{
+    // Create buffer, use the system independent Cairo context backend
+    stride     = cairo_format_stride_for_width( GAL_FORMAT, screenSize.x );
+    bufferSize = stride * screenSize.y;
+
+    bitmapBuffer        = new unsigned int[bufferSize];
+    bitmapBufferBackup  = new unsigned int[bufferSize];
+
+    isScreenValid = false;
+}
+
+
+void CAIRO_IMAGE_GAL::deleteBitmaps()
+{
+    delete[] bitmapBuffer;
+    delete[] bitmapBufferBackup;
+}
+
+
+void CAIRO_IMAGE_GAL::initSurface()
+{
+    if( isInitialized )
+        return;
+
+    // Create the Cairo surface
+    surface = cairo_image_surface_create_for_data( (unsigned char*) bitmapBuffer, GAL_FORMAT,
+                                                   screenSize.x, screenSize.y, stride );
+    context = cairo_create( surface );
+#ifdef __WXDEBUG__
+    cairo_status_t status = cairo_status( context );
+    wxASSERT_MSG( status == CAIRO_STATUS_SUCCESS, wxT( "Cairo context creation error" ) );
+#endif /* __WXDEBUG__ */
+    currentContext = context;
+
+    cairo_set_antialias( context, CAIRO_ANTIALIAS_SUBPIXEL );
+
+    // Compute the world <-> screen transformations
+    ComputeWorldScreenMatrix();
+
+    cairo_matrix_init( &cairoWorldScreenMatrix, worldScreenMatrix.m_data[0][0],
+                       worldScreenMatrix.m_data[1][0], worldScreenMatrix.m_data[0][1],
+                       worldScreenMatrix.m_data[1][1], worldScreenMatrix.m_data[0][2],
+                       worldScreenMatrix.m_data[1][2] );
+
+    cairo_set_matrix( context, &cairoWorldScreenMatrix );
+
+    // Start drawing with a new path
+    cairo_new_path( context );
+    isElementAdded = true;
+    isFillableAdded = false;
+
+    cairo_set_line_join( context, CAIRO_LINE_JOIN_ROUND );
+    cairo_set_line_cap( context, CAIRO_LINE_CAP_ROUND );
+
+    lineWidth = 0;
+
+    isInitialized = true;
+}
+
+
+void CAIRO_IMAGE_GAL::deinitSurface()
+{
+    if( !isInitialized )
+        return;
+
+    // Destroy Cairo objects
+    cairo_destroy( context );
+    cairo_surface_destroy( surface );
+
+    isInitialized = false;
+}
+
+
+void CAIRO_IMAGE_GAL::setCompositor()
+{
+    // Recreate the compositor with the new Cairo context
+    compositor.reset( new CAIRO_COMPOSITOR( &currentContext ) );
+    compositor->Resize( screenSize.x, screenSize.y );
+
+    // Prepare buffers
+    mainBuffer = compositor->CreateBuffer();
+    overlayBuffer = compositor->CreateBuffer();
+
+    // New buffers are empty
+    isScreenValid = false;
+    validCompositor = true;
+}
+
+
+unsigned int CAIRO_IMAGE_GAL::getNewGroupNumber()
+{
+    wxASSERT_MSG( groups.size() < std::numeric_limits<unsigned int>::max(),
+                  wxT( "There are no free slots to store a group" ) );
+
+    while( groups.find( groupCounter ) != groups.end() )
+    {
+        groupCounter++;
+    }
+
+    return groupCounter++;
+}
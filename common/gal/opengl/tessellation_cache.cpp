@@ -0,0 +1,147 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file tessellation_cache.cpp
+ * @brief Class to store the results of polygon tessellation.
+ */
+
+#include <gal/opengl/tessellation_cache.h>
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+
+using namespace KIGFX;
+
+TESSELLATION_CACHE::TESSELLATION_CACHE( unsigned int aMaxPoints ) :
+    m_generation( 0 ), m_pointCount( 0 ), m_maxPoints( aMaxPoints )
+{
+}
+
+
+TESSELLATION_CACHE::TRIANGLES_PTR TESSELLATION_CACHE::Find( const std::deque<VECTOR2D>& aPolygon )
+{
+    std::size_t polyHash = hash( aPolygon );
+    MUTLOCK lock( m_lock );
+    ENTRY* entry = find( polyHash, aPolygon );
+
+    if( !entry )
+        return TRIANGLES_PTR();
+
+    entry->generation = m_generation;
+
+    return entry->triangles;
+}
+
+
+TESSELLATION_CACHE::TRIANGLES_PTR TESSELLATION_CACHE::Add( const std::deque<VECTOR2D>& aPolygon,
+                                                           TRIANGLES& aTriangles )
+{
+    std::size_t polyHash = hash( aPolygon );
+    TRIANGLES* triangles = new TRIANGLES;
+    triangles->swap( aTriangles );
+    TRIANGLES_PTR result( triangles );
+
+    MUTLOCK lock( m_lock );
+    ENTRY* entry = find( polyHash, aPolygon );
+
+    // Another thread could have stored the same polygon in the meantime
+    if( entry )
+        return entry->triangles;
+
+    unsigned int points = aPolygon.size() + result->size();
+
+    if( m_pointCount + points > m_maxPoints )
+        evict();
+
+    CACHE_MAP::iterator it = m_cache.insert( std::make_pair( polyHash, ENTRY() ) );
+    it->second.polygon.assign( aPolygon.begin(), aPolygon.end() );
+    it->second.triangles  = result;
+    it->second.generation = m_generation;
+    m_pointCount += points;
+
+    return result;
+}
+
+
+void TESSELLATION_CACHE::Clear()
+{
+    MUTLOCK lock( m_lock );
+
+    m_cache.clear();
+    m_pointCount = 0;
+}
+
+
+std::size_t TESSELLATION_CACHE::hash( const std::deque<VECTOR2D>& aPolygon )
+{
+    std::size_t seed = aPolygon.size();
+
+    for( std::deque<VECTOR2D>::const_iterator it = aPolygon.begin(); it != aPolygon.end(); ++it )
+    {
+        boost::hash_combine( seed, it->x );
+        boost::hash_combine( seed, it->y );
+    }
+
+    return seed;
+}
+
+
+TESSELLATION_CACHE::ENTRY* TESSELLATION_CACHE::find( std::size_t aHash,
+                                                     const std::deque<VECTOR2D>& aPolygon )
+{
+    std::pair<CACHE_MAP::iterator, CACHE_MAP::iterator> range = m_cache.equal_range( aHash );
+
+    for( CACHE_MAP::iterator it = range.first; it != range.second; ++it )
+    {
+        const std::vector<VECTOR2D>& polygon = it->second.polygon;
+
+        if( polygon.size() == aPolygon.size() &&
+                std::equal( polygon.begin(), polygon.end(), aPolygon.begin() ) )
+            return &it->second;
+    }
+
+    return NULL;
+}
+
+
+void TESSELLATION_CACHE::evict()
+{
+    CACHE_MAP::iterator it = m_cache.begin();
+
+    while( it != m_cache.end() )
+    {
+        if( it->second.generation != m_generation )
+        {
+            // Triangles that are still being drawn are kept alive by their shared pointers
+            m_pointCount -= it->second.polygon.size() + it->second.triangles->size();
+            it = m_cache.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    ++m_generation;
+}
@@ -35,6 +35,8 @@
 #include <gal/opengl/vertex_item.h>
 #include <confirm.h>
 
+#include <cstring>
+
 using namespace KIGFX;
 
 VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
@@ -99,6 +101,29 @@ void VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize ) co
 }
 
 
+void VERTEX_MANAGER::CopyVertices( const VERTEX aVertices[], unsigned int aSize ) const
+{
+    // flag to avoid hanging by calling DisplayError too many times:
+    static bool show_err = true;
+
+    // The whole chunk is allocated at once
+    VERTEX* newVertex = m_container->Allocate( aSize );
+
+    if( newVertex == NULL )
+    {
+        if( show_err )
+        {
+            DisplayError( NULL, wxT( "VERTEX_MANAGER::CopyVertices: Vertex allocation error" ) );
+            show_err = false;
+        }
+
+        return;
+    }
+
+    memcpy( newVertex, aVertices, aSize * VertexSize );
+}
+
+
 void VERTEX_MANAGER::SetItem( VERTEX_ITEM& aItem ) const
 {
     m_container->SetItem( &aItem );
@@ -163,6 +188,14 @@ VERTEX* VERTEX_MANAGER::GetVertices( const VERTEX_ITEM& aItem ) const
 }
 
 
+const VERTEX* VERTEX_MANAGER::GetAllVertices( unsigned int& aSize ) const
+{
+    aSize = m_container->GetUsedSize();
+
+    return m_container->GetAllVertices();
+}
+
+
 void VERTEX_MANAGER::SetShader( SHADER& aShader ) const
 {
     m_gpu->SetShader( aShader );
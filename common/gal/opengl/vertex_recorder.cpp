@@ -0,0 +1,84 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file vertex_recorder.cpp
+ * @brief Class to record groups of vertices in the system memory.
+ */
+
+#include <gal/opengl/vertex_recorder.h>
+
+using namespace KIGFX;
+
+VERTEX_RECORDER::VERTEX_RECORDER( const GAL& aGal, TESSELLATION_CACHE* aTessCache ) :
+    recordManager( false )
+{
+    // Painters may adapt the drawn shapes to the view (e.g. sizes given in pixels)
+    screenSize        = aGal.GetScreenPixelSize();
+    worldScale        = aGal.GetWorldScale();
+    worldScreenMatrix = aGal.GetWorldScreenMatrix();
+    screenWorldMatrix = aGal.GetScreenWorldMatrix();
+    SetLookAtPoint( aGal.GetLookAtPoint() );
+    SetZoomFactor( aGal.GetZoomFactor() );
+    SetDepthRange( VECTOR2D( aGal.GetMinDepth(), aGal.GetMaxDepth() ) );
+
+    currentManager = &recordManager;
+    tessCache = aTessCache;
+}
+
+
+int VERTEX_RECORDER::BeginGroup()
+{
+    unsigned int size;
+
+    recordManager.GetAllVertices( size );
+    groups.push_back( std::make_pair( size, 0u ) );
+
+    return groups.size() - 1;
+}
+
+
+void VERTEX_RECORDER::EndGroup()
+{
+    unsigned int size;
+
+    recordManager.GetAllVertices( size );
+    groups.back().second = size - groups.back().first;
+}
+
+
+void VERTEX_RECORDER::ClearCache()
+{
+    groups.clear();
+    recordManager.Clear();
+}
+
+
+const VERTEX* VERTEX_RECORDER::GetGroupVertices( int aGroupNumber, unsigned int& aSize ) const
+{
+    const VERTEX* vertices = recordManager.GetAllVertices( aSize );
+
+    aSize = groups[aGroupNumber].second;
+
+    return vertices + groups[aGroupNumber].first;
+}
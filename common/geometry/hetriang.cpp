@@ -127,22 +127,22 @@ EDGE_PTR TRIANGULATION::InitTwoEnclosingTriangles( NODES_CONTAINER::iterator aFi
     double dx = ( xmax - xmin ) / fac;
     double dy = ( ymax - ymin ) / fac;
 
-    NODE_PTR n1 = boost::make_shared<NODE>( xmin - dx, ymin - dy );
-    NODE_PTR n2 = boost::make_shared<NODE>( xmax + dx, ymin - dy );
-    NODE_PTR n3 = boost::make_shared<NODE>( xmax + dx, ymax + dy );
-    NODE_PTR n4 = boost::make_shared<NODE>( xmin - dx, ymax + dy );
+    NODE_PTR n1 = newNode( xmin - dx, ymin - dy );
+    NODE_PTR n2 = newNode( xmax + dx, ymin - dy );
+    NODE_PTR n3 = newNode( xmax + dx, ymax + dy );
+    NODE_PTR n4 = newNode( xmin - dx, ymax + dy );
 
     // diagonal
-    EDGE_PTR e1d = boost::make_shared<EDGE>();
-    EDGE_PTR e2d = boost::make_shared<EDGE>();
+    EDGE_PTR e1d = newEdge();
+    EDGE_PTR e2d = newEdge();
 
     // lower triangle
-    EDGE_PTR e11 = boost::make_shared<EDGE>();
-    EDGE_PTR e12 = boost::make_shared<EDGE>();
+    EDGE_PTR e11 = newEdge();
+    EDGE_PTR e12 = newEdge();
 
     // upper triangle
-    EDGE_PTR e21 = boost::make_shared<EDGE>();
-    EDGE_PTR e22 = boost::make_shared<EDGE>();
+    EDGE_PTR e21 = newEdge();
+    EDGE_PTR e22 = newEdge();
 
     // lower triangle
     e1d->SetSourceNode( n3 );
@@ -178,6 +178,31 @@ TRIANGULATION::TRIANGULATION()
 }
 
 
+TRIANGULATION::TRIANGULATION( const POOL_PTR& aPool ) :
+    m_pool( aPool )
+{
+    m_helper = new ttl::TRIANGULATION_HELPER( *this );
+}
+
+
+NODE_PTR TRIANGULATION::newNode( int aX, int aY )
+{
+    if( m_pool )
+        return boost::allocate_shared<NODE>( POOL_ALLOCATOR<NODE>( m_pool ), aX, aY );
+
+    return boost::make_shared<NODE>( aX, aY );
+}
+
+
+EDGE_PTR TRIANGULATION::newEdge()
+{
+    if( m_pool )
+        return boost::allocate_shared<EDGE>( POOL_ALLOCATOR<EDGE>( m_pool ) );
+
+    return boost::make_shared<EDGE>();
+}
+
+
 TRIANGULATION::TRIANGULATION( const TRIANGULATION& aTriangulation )
 {
     m_helper = 0;   // make coverity and static analysers quiet.
@@ -430,6 +455,34 @@ std::list<EDGE_PTR>* TRIANGULATION::GetEdges( bool aSkipBoundaryEdges ) const
 }
 
 
+void TRIANGULATION::GetEdges( std::vector<EDGE_PTR>& aEdges, bool aSkipBoundaryEdges ) const
+{
+    std::list<EDGE_PTR>::const_iterator it;
+    size_t first = aEdges.size();
+
+    aEdges.reserve( first + 3 * m_leadingEdges.size() / 2 + 3 );
+
+    for( it = m_leadingEdges.begin(); it != m_leadingEdges.end(); ++it )
+    {
+        EDGE_PTR edge = *it;
+        for( int i = 0; i < 3; ++i )
+        {
+            EDGE_PTR twinedge = edge->GetTwinEdge();
+            // only one of the half-edges
+
+            if( ( !twinedge && !aSkipBoundaryEdges )
+                    || ( twinedge && ( (size_t) edge.get() > (size_t) twinedge.get() ) ) )
+                aEdges.push_back( edge );
+
+            edge = edge->GetNextEdgeInFace();
+        }
+    }
+
+    // The list version adds edges at the front
+    std::reverse( aEdges.begin() + first, aEdges.end() );
+}
+
+
 EDGE_PTR TRIANGULATION::SplitTriangle( EDGE_PTR& aEdge, const NODE_PTR& aPoint )
 {
     // Add a node by just splitting a triangle into three triangles
@@ -453,12 +506,12 @@ EDGE_PTR TRIANGULATION::SplitTriangle( EDGE_PTR& aEdge, const NODE_PTR& aPoint )
     EDGE_PTR e3( e2->GetNextEdgeInFace() );
     NODE_PTR n3( e3->GetSourceNode() );
 
-    EDGE_PTR e1_n = boost::make_shared<EDGE>();
-    EDGE_PTR e11_n = boost::make_shared<EDGE>();
-    EDGE_PTR e2_n = boost::make_shared<EDGE>();
-    EDGE_PTR e22_n = boost::make_shared<EDGE>();
-    EDGE_PTR e3_n = boost::make_shared<EDGE>();
-    EDGE_PTR e33_n = boost::make_shared<EDGE>();
+    EDGE_PTR e1_n = newEdge();
+    EDGE_PTR e11_n = newEdge();
+    EDGE_PTR e2_n = newEdge();
+    EDGE_PTR e22_n = newEdge();
+    EDGE_PTR e3_n = newEdge();
+    EDGE_PTR e33_n = newEdge();
 
     e1_n->SetSourceNode( n1 );
     e11_n->SetSourceNode( aPoint );
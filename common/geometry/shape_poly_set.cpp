@@ -28,9 +28,15 @@
 
 #include <vector>
 #include <cstdio>
+#include <cassert>
 #include <set>
 #include <list>
 #include <algorithm>
+#include <limits>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
 
 #include <boost/foreach.hpp>
 
@@ -56,14 +62,17 @@ int SHAPE_POLY_SET::NewOutline()
 {
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
+
     poly.push_back( empty_path );
     m_polys.push_back( poly );
+    m_edgeIndex.push_back( POLYGON_INDEX() );
     return m_polys.size() - 1;
 }
 
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateEdgeIndex( m_polys.size() - 1 );
     m_polys.back().push_back( SHAPE_LINE_CHAIN() );
 
     return m_polys.back().size() - 2;
@@ -85,6 +94,7 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole )
     assert( aOutline < (int)m_polys.size() );
     assert( idx < (int)m_polys[aOutline].size() );
 
+    invalidateEdgeIndex( aOutline );
     m_polys[aOutline][idx].Append( x, y );
 
     return m_polys[aOutline][idx].PointCount();
@@ -144,6 +154,7 @@ VECTOR2I& SHAPE_POLY_SET::Vertex( int index, int aOutline , int aHole )
     assert( aOutline < (int)m_polys.size() );
     assert( idx < (int)m_polys[aOutline].size() );
 
+    invalidateEdgeIndex( aOutline );
     return m_polys[aOutline][idx].Point( index );
 }
 
@@ -157,6 +168,7 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
     poly.push_back( aOutline );
 
     m_polys.push_back( poly );
+    m_edgeIndex.push_back( POLYGON_INDEX() );
 
     return m_polys.size() - 1;
 }
@@ -173,6 +185,7 @@ int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 
     assert( poly.size() );
 
+    invalidateEdgeIndex( aOutline );
     poly.push_back( aHole );
 
     return poly.size() - 1;
@@ -337,6 +350,8 @@ void SHAPE_POLY_SET::importTree( PolyTree* tree)
             m_polys.push_back(paths);
         }
     }
+
+    resetEdgeIndex();
 }
 
 // Polygon fracturing code. Work in progress.
@@ -380,7 +395,71 @@ struct FractureEdge
 };
 
 
-typedef std::vector<FractureEdge*> FractureEdgeSet;
+/**
+ * Class FractureEdgeSet
+ * stores the edges of a polygon being fractured in a single pool, and keeps them
+ * in horizontal slabs, so that the edges crossing a horizontal line can be found
+ * without testing all the edges of the polygon.
+ *
+ * An edge is stored in all the slabs its vertical extent overlaps. The fracturing
+ * only shortens edges, so the slabs of an edge are always a superset of the slabs
+ * it actually crosses. Each slab keeps its edges in creation order, which is the
+ * order a linear search over all edges would meet them.
+ */
+class FractureEdgeSet
+{
+public:
+    /**
+     * @param aMaxEdges is the maximum number of edges the set will hold (the pool never
+     * grows, so that the edge pointers stay valid).
+     * @param aYMin, aYMax are the vertical limits of the edges.
+     */
+    FractureEdgeSet( int aMaxEdges, int aYMin, int aYMax ) :
+        m_yMin( aYMin ),
+        m_yMax( aYMax )
+    {
+        m_edges.reserve( aMaxEdges );
+        m_slabs.resize( std::max( 1, std::min( aMaxEdges / EDGES_PER_SLAB, MAX_SLABS ) ) );
+    }
+
+    FractureEdge* Add( const FractureEdge& aEdge )
+    {
+        assert( m_edges.size() < m_edges.capacity() );
+
+        m_edges.push_back( aEdge );
+
+        FractureEdge* edge = &m_edges.back();
+        int last = slab( std::max( edge->m_p1.y, edge->m_p2.y ) );
+
+        for( int i = slab( std::min( edge->m_p1.y, edge->m_p2.y ) ); i <= last; i++ )
+            m_slabs[i].push_back( edge );
+
+        return edge;
+    }
+
+    ///> Returns the edges which can cross the horizontal line at aY, in creation order
+    const std::vector<FractureEdge*>& EdgesAt( int aY ) const
+    {
+        return m_slabs[slab( aY )];
+    }
+
+private:
+    ///> Average number of edges in a slab, and max number of slabs
+    static const int EDGES_PER_SLAB = 4;
+    static const int MAX_SLABS = 65536;
+
+    int slab( int aY ) const
+    {
+        int64_t height = (int64_t) m_yMax - m_yMin + 1;
+
+        return (int) ( ( (int64_t) aY - m_yMin ) * (int64_t) m_slabs.size() / height );
+    }
+
+    int m_yMin, m_yMax;
+    std::vector<FractureEdge> m_edges;
+    std::vector<std::vector<FractureEdge*> > m_slabs;
+};
+
 
 static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 {
@@ -391,7 +470,10 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
     FractureEdge* e_nearest = NULL;
 
-    for( FractureEdgeSet::iterator i = edges.begin(); i != edges.end(); ++i )
+    const std::vector<FractureEdge*>& candidates = edges.EdgesAt( y );
+
+    for( std::vector<FractureEdge*>::const_iterator i = candidates.begin();
+         i != candidates.end(); ++i )
     {
         if( !(*i)->matches( y ) )
             continue;
@@ -417,13 +499,12 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
     {
         int count = 0;
 
-		FractureEdge* lead1 = new FractureEdge( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
-        FractureEdge* lead2 = new FractureEdge( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
-        FractureEdge* split_2 = new FractureEdge( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
-
-        edges.push_back( split_2 );
-        edges.push_back( lead1 );
-        edges.push_back( lead2 );
+        FractureEdge* split_2 = edges.Add( FractureEdge( true, VECTOR2I( x_nearest, y ),
+                                                         e_nearest->m_p2 ) );
+        FractureEdge* lead1 = edges.Add( FractureEdge( true, VECTOR2I( x_nearest, y ),
+                                                       VECTOR2I( x, y ) ) );
+        FractureEdge* lead2 = edges.Add( FractureEdge( true, VECTOR2I( x, y ),
+                                                       VECTOR2I( x_nearest, y ) ) );
 
         FractureEdge* link = e_nearest->m_next;
 
@@ -449,10 +530,17 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
     return 0;
 }
 
+
+///> Orders hole edges from left to right
+static bool compareEdgeX( const FractureEdge* aA, const FractureEdge* aB )
+{
+    return aA->m_p1.x < aB->m_p1.x;
+}
+
+
 void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 {
-    FractureEdgeSet edges;
-    FractureEdgeSet border_edges;
+    std::vector<FractureEdge*> border_edges;
     FractureEdge* root = NULL;
 
     bool first = true;
@@ -461,6 +549,23 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         return;
 
     int num_unconnected = 0;
+    int num_edges = 0;
+    int y_min = std::numeric_limits<int>::max();
+    int y_max = std::numeric_limits<int>::min();
+
+    BOOST_FOREACH( const SHAPE_LINE_CHAIN& path, paths )
+    {
+        num_edges += path.PointCount();
+
+        for( int i = 0; i < path.PointCount(); i++ )
+        {
+            y_min = std::min( y_min, path.CPoint( i ).y );
+            y_max = std::max( y_max, path.CPoint( i ).y );
+        }
+    }
+
+    // Each hole is connected to the outline by 3 new edges
+    FractureEdgeSet edges( num_edges + 3 * ( paths.size() - 1 ), y_min, y_max );
 
     BOOST_FOREACH( SHAPE_LINE_CHAIN& path, paths )
     {
@@ -480,7 +585,7 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
         for( int i = 0; i < path.PointCount(); i++ )
         {
-            FractureEdge* fe = new FractureEdge( first, &path, index++ );
+            FractureEdge* fe = edges.Add( FractureEdge( first, &path, index++ ) );
 
             if( !root )
                 root = fe;
@@ -495,7 +600,6 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
                 fe->m_next = first_edge;
 
             prev = fe;
-            edges.push_back( fe );
 
             if( !first )
             {
@@ -509,26 +613,30 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         first = false; // first path is always the outline
     }
 
+    // The start points of the hole edges are never changed, so the holes can be
+    // sorted once. The sort is stable, so on equal x the first edge found is used.
+    std::stable_sort( border_edges.begin(), border_edges.end(), compareEdgeX );
+
+    std::vector<FractureEdge*>::iterator smallestX = border_edges.begin();
+
     // keep connecting holes to the main outline, until there's no holes left...
     while( num_unconnected > 0 )
     {
-        int x_min = std::numeric_limits<int>::max();
+        // find the left-most hole edge and merge with the outline
+        while( smallestX != border_edges.end() && (*smallestX)->m_connected )
+            ++smallestX;
 
-        FractureEdge* smallestX = NULL;
+        if( smallestX == border_edges.end() )
+            break;
 
-        // find the left-most hole edge and merge with the outline
-        for( FractureEdgeSet::iterator i = border_edges.begin(); i != border_edges.end(); ++i )
-        {
-            int xt = (*i)->m_p1.x;
+        int count = processEdge( edges, *smallestX );
 
-            if( ( xt < x_min ) && ! (*i)->m_connected )
-            {
-                x_min = xt;
-                smallestX = *i;
-            }
-        }
+        // a hole which cannot be connected would be dropped from the outline:
+        // stop here rather than looping forever
+        if( count == 0 )
+            break;
 
-        num_unconnected -= processEdge( edges, smallestX );
+        num_unconnected -= count;
     }
 
     paths.clear();
@@ -543,9 +651,6 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
     newPath.Append( e->m_p1 );
 
-    for( FractureEdgeSet::iterator i = edges.begin(); i != edges.end(); ++i )
-        delete *i;
-
     paths.push_back( newPath );
 }
 
@@ -643,6 +748,7 @@ bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
         }
 
         m_polys.push_back( paths );
+        m_edgeIndex.push_back( POLYGON_INDEX() );
     }
     return true;
 }
@@ -668,18 +774,22 @@ const BOX2I SHAPE_POLY_SET::BBox( int aClearance ) const
 void SHAPE_POLY_SET::RemoveAllContours()
 {
     m_polys.clear();
+    m_edgeIndex.clear();
 }
 
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
     m_polys.erase( m_polys.begin() + aIdx );
+    m_edgeIndex.erase( m_edgeIndex.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    // the appended polygons keep their edge index
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
+    m_edgeIndex.insert( m_edgeIndex.end(), aSet.m_edgeIndex.begin(), aSet.m_edgeIndex.end() );
 }
 
 
@@ -689,22 +799,289 @@ void SHAPE_POLY_SET::Append( const VECTOR2I& aP, int aOutline, int aHole )
 }
 
 
-bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
+///> Result of the test of a polygon edge against a horizontal ray going right from a point
+enum EDGE_CROSSING
+{
+    EC_NONE,        ///> the edge does not cross the ray
+    EC_CROSS,       ///> the edge crosses the ray
+    EC_ON_EDGE      ///> the point is on the edge
+};
+
+
+/**
+ * Function edgeCrossing
+ * tests the edge aA-aB against the horizontal ray going right from aP (the edge test
+ * of ClipperLib::PointInPolygon()). Only edges spanning the height of aP can return
+ * something else than EC_NONE.
+ */
+static EDGE_CROSSING edgeCrossing( const VECTOR2I& aP, const VECTOR2I& aA, const VECTOR2I& aB )
 {
-    // fixme: support holes!
+    if( aB.y == aP.y )
+    {
+        if( ( aB.x == aP.x ) || ( aA.y == aP.y && ( ( aB.x > aP.x ) == ( aA.x < aP.x ) ) ) )
+            return EC_ON_EDGE;
+    }
+
+    if( ( aA.y < aP.y ) == ( aB.y < aP.y ) )
+        return EC_NONE;
+
+    if( aA.x >= aP.x && aB.x > aP.x )
+        return EC_CROSS;
+
+    if( aA.x < aP.x && aB.x <= aP.x )
+        return EC_NONE;
+
+    int64_t d = (int64_t)( aA.x - aP.x ) * (int64_t)( aB.y - aP.y ) -
+                (int64_t)( aB.x - aP.x ) * (int64_t)( aA.y - aP.y );
+
+    if( !d )
+        return EC_ON_EDGE;
+
+    return ( ( d > 0 ) == ( aB.y > aA.y ) ) ? EC_CROSS : EC_NONE;
+}
+
+
+/**
+ * Class SHAPE_POLY_SET::EDGE_INDEX
+ * keeps the edges (outline and holes) of a polygon in horizontal slabs, so a point or
+ * segment query only tests the edges at the same height.
+ *
+ * The index holds a copy of the edges, so it can be shared between copies of a set.
+ */
+class SHAPE_POLY_SET::EDGE_INDEX
+{
+public:
+    EDGE_INDEX( const POLYGON& aPolygon )
+    {
+        BOOST_FOREACH( const SHAPE_LINE_CHAIN& path, aPolygon )
+        {
+            int cnt = path.PointCount();
+
+            // same as pointInPolygon(), which ignores degenerate contours
+            if( cnt < 3 )
+                continue;
+
+            // polygon contours are always closed, whatever their closed flag
+            for( int i = 0; i < cnt; i++ )
+                m_edges.push_back( SEG( path.CPoint( i ), path.CPoint( i + 1 == cnt ? 0 : i + 1 ) ) );
+        }
+
+        if( m_edges.empty() )
+            return;
+
+        m_bbox = BOX2I( m_edges[0].A, VECTOR2I( 0, 0 ) );
+
+        BOOST_FOREACH( const SEG& e, m_edges )
+        {
+            m_bbox.Merge( e.A );
+        }
+
+        int nslabs = std::max( 1, std::min( (int) m_edges.size() / EDGES_PER_SLAB, MAX_SLABS ) );
+
+        m_slabStart.assign( nslabs + 1, 0 );
+
+        // count the edges of each slab, then store them in edge order
+        for( unsigned i = 0; i < m_edges.size(); i++ )
+        {
+            int first, last;
+
+            edgeSlabs( m_edges[i], first, last );
+
+            for( int j = first; j <= last; j++ )
+                m_slabStart[j + 1]++;
+        }
+
+        for( int j = 0; j < nslabs; j++ )
+            m_slabStart[j + 1] += m_slabStart[j];
+
+        std::vector<int> fill( m_slabStart.begin(), m_slabStart.end() - 1 );
+
+        m_slabEdges.resize( m_slabStart.back() );
+
+        for( unsigned i = 0; i < m_edges.size(); i++ )
+        {
+            int first, last;
+
+            edgeSlabs( m_edges[i], first, last );
+
+            for( int j = first; j <= last; j++ )
+                m_slabEdges[fill[j]++] = i;
+        }
+    }
+
+    bool Contains( const VECTOR2I& aP ) const
+    {
+        if( m_edges.empty() || !m_bbox.Contains( aP ) )
+            return false;
+
+        int first, last;
+        int result = 0;
+
+        slabRange( aP.y, aP.y, first, last );
+
+        for( int i = m_slabStart[first]; i < m_slabStart[first + 1]; i++ )
+        {
+            const SEG& e = m_edges[m_slabEdges[i]];
+
+            switch( edgeCrossing( aP, e.A, e.B ) )
+            {
+            case EC_ON_EDGE:
+                return true;
+
+            case EC_CROSS:
+                result = 1 - result;
+                break;
 
+            default:
+                break;
+            }
+        }
+
+        return result ? true : false;
+    }
+
+    ///> Returns true if one of the edges is closer than aClearance to aSeg
+    bool EdgeCollide( const SEG& aSeg, int aClearance ) const
+    {
+        if( m_edges.empty() )
+            return false;
+
+        int first, last;
+
+        if( !slabRange( std::min( aSeg.A.y, aSeg.B.y ) - aClearance,
+                        std::max( aSeg.A.y, aSeg.B.y ) + aClearance, first, last ) )
+            return false;
+
+        // edges spanning several slabs may be tested more than once, which is harmless
+        for( int i = m_slabStart[first]; i < m_slabStart[last + 1]; i++ )
+        {
+            if( m_edges[m_slabEdges[i]].Collide( aSeg, aClearance ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    const BOX2I& BBox() const
+    {
+        return m_bbox;
+    }
+
+private:
+    ///> Average number of edges in a slab, and max number of slabs of a polygon
+    static const int EDGES_PER_SLAB = 4;
+    static const int MAX_SLABS = 65536;
+
+    ///> Finds the slabs covering the heights aYMin..aYMax. Returns false if
+    ///> the range is outside the polygon.
+    bool slabRange( int aYMin, int aYMax, int& aFirst, int& aLast ) const
+    {
+        if( aYMax < m_bbox.GetTop() || aYMin > m_bbox.GetBottom() )
+            return false;
+
+        aFirst = slab( std::max( aYMin, m_bbox.GetTop() ) );
+        aLast = slab( std::min( aYMax, m_bbox.GetBottom() ) );
+
+        return true;
+    }
+
+    int slab( int aY ) const
+    {
+        int64_t height = (int64_t) m_bbox.GetHeight() + 1;
+
+        return (int) ( ( (int64_t) aY - m_bbox.GetTop() ) * (int64_t) ( m_slabStart.size() - 1 ) / height );
+    }
+
+    void edgeSlabs( const SEG& aEdge, int& aFirst, int& aLast ) const
+    {
+        aFirst = slab( std::min( aEdge.A.y, aEdge.B.y ) );
+        aLast = slab( std::max( aEdge.A.y, aEdge.B.y ) );
+    }
+
+    BOX2I m_bbox;
+    std::vector<SEG> m_edges;
+    std::vector<int> m_slabStart;   ///> edges of slab i are m_slabEdges[m_slabStart[i]..m_slabStart[i+1]-1]
+    std::vector<int> m_slabEdges;
+};
+
+
+const SHAPE_POLY_SET::EDGE_INDEX* SHAPE_POLY_SET::edgeIndex( int aPolygon ) const
+{
+    POLYGON_INDEX& entry = m_edgeIndex[aPolygon];
+    const EDGE_INDEX* index;
+
+    // Once built, the index is returned without locking
+#ifdef USE_OPENMP
+    #pragma omp atomic read
+#endif /* USE_OPENMP */
+    index = entry.m_ptr;
+
+    if( index )
+    {
+#ifdef USE_OPENMP
+        #pragma omp flush
+#endif /* USE_OPENMP */
+        return index;
+    }
+
+    int vertices = 0;
+
+    BOOST_FOREACH( const SHAPE_LINE_CHAIN& path, m_polys[aPolygon] )
+    {
+        vertices += path.PointCount();
+    }
+
+    if( vertices < INDEX_MIN_VERTICES )
+        return NULL;
+
+    // The index is built on the first query, which can come from concurrent readers.
+    // It is published only when it is complete, so the readers above never see a partial one.
+#ifdef USE_OPENMP
+    #pragma omp critical(shapePolySetIndex)
+#endif /* USE_OPENMP */
+    {
+        if( !entry.m_ptr )
+        {
+            entry.m_index.reset( new EDGE_INDEX( m_polys[aPolygon] ) );
+            index = entry.m_index.get();
+
+#ifdef USE_OPENMP
+            #pragma omp flush
+            #pragma omp atomic write
+#endif /* USE_OPENMP */
+            entry.m_ptr = index;
+        }
+
+        index = entry.m_ptr;
+    }
+
+    return index;
+}
+
+
+bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
+{
     if( m_polys.size() == 0 ) // empty set?
         return false;
 
     if( aSubpolyIndex >= 0 )
-        return pointInPolygon( aP, m_polys[aSubpolyIndex][0] );
+    {
+        const EDGE_INDEX* index = edgeIndex( aSubpolyIndex );
 
-    BOOST_FOREACH ( const POLYGON& polys, m_polys )
+        if( index )
+            return index->Contains( aP );
+
+        return pointInPolygon( aP, m_polys[aSubpolyIndex] );
+    }
+
+    for( unsigned i = 0; i < m_polys.size(); i++ )
     {
-        if( polys.size() == 0 )
+        if( m_polys[i].size() == 0 )
             continue;
 
-        if( pointInPolygon( aP, polys[0] ) )
+        const EDGE_INDEX* index = edgeIndex( i );
+
+        if( index ? index->Contains( aP ) : pointInPolygon( aP, m_polys[i] ) )
             return true;
     }
 
@@ -712,65 +1089,100 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
 }
 
 
-bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const
+bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 {
-    int result = 0;
-    int cnt = aPath.PointCount();
+    return Collide( SEG( aP, aP ), aClearance );
+}
 
-    if ( !aPath.BBox().Contains( aP ) ) // test with bounding box first
-        return false;
 
-    if( cnt < 3 )
-        return false;
+bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
+{
+    BOX2I segBox( aSeg.A, aSeg.B - aSeg.A );
 
-    VECTOR2I ip = aPath.CPoint( 0 );
+    segBox.Normalize();
+    segBox.Inflate( aClearance );
 
-    for( int i = 1; i <= cnt; ++i )
+    for( unsigned i = 0; i < m_polys.size(); i++ )
     {
-        VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
+        const POLYGON& poly = m_polys[i];
+
+        if( poly.size() == 0 )
+            continue;
+
+        const EDGE_INDEX* index = edgeIndex( i );
 
-        if( ipNext.y == aP.y )
+        if( index )
         {
-            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
-                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+            if( !index->BBox().Intersects( segBox ) )
+                continue;
+
+            // a segment inside the polygon has its end points inside, a segment
+            // crossing the polygon or too close to it collides with one of its edges
+            if( index->Contains( aSeg.A ) || index->Contains( aSeg.B )
+                    || index->EdgeCollide( aSeg, aClearance ) )
                 return true;
         }
-
-        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+        else
         {
-            if( ip.x >= aP.x )
+            if( pointInPolygon( aSeg.A, poly ) || pointInPolygon( aSeg.B, poly ) )
+                return true;
+
+            BOOST_FOREACH( const SHAPE_LINE_CHAIN& path, poly )
             {
-                if( ipNext.x > aP.x )
-                    result = 1 - result;
-                else
+                int cnt = path.PointCount();
+
+                for( int j = 0; j < cnt; j++ )
                 {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+                    SEG edge( path.CPoint( j ), path.CPoint( j + 1 == cnt ? 0 : j + 1 ) );
 
-                    if( !d )
+                    if( edge.Collide( aSeg, aClearance ) )
                         return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
                 }
             }
-            else
+        }
+    }
+
+    return false;
+}
+
+
+bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const POLYGON& aPolygon ) const
+{
+    int result = 0;
+
+    if( !aPolygon[0].BBox().Contains( aP ) ) // test with bounding box first
+        return false;
+
+    // The point is inside if a ray starting from it crosses the outline and the holes
+    // an odd number of times
+    BOOST_FOREACH( const SHAPE_LINE_CHAIN& path, aPolygon )
+    {
+        int cnt = path.PointCount();
+
+        if( cnt < 3 )
+            continue;
+
+        VECTOR2I ip = path.CPoint( 0 );
+
+        for( int i = 1; i <= cnt; ++i )
+        {
+            VECTOR2I ipNext = ( i == cnt ? path.CPoint( 0 ) : path.CPoint( i ) );
+
+            switch( edgeCrossing( aP, ip, ipNext ) )
             {
-                if( ipNext.x > aP.x )
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+            case EC_ON_EDGE:
+                return true;
 
-                if( !d )
-                    return true;
+            case EC_CROSS:
+                result = 1 - result;
+                break;
 
-                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                    result = 1 - result;
-                }
+            default:
+                break;
             }
-        }
 
-        ip = ipNext;
+            ip = ipNext;
+        }
     }
 
     return result ? true : false;
@@ -779,6 +1191,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    resetEdgeIndex();
+
     BOOST_FOREACH( POLYGON &poly, m_polys )
     {
         BOOST_FOREACH( SHAPE_LINE_CHAIN &path, poly )
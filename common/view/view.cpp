@@ -38,6 +38,10 @@
 #include <profile.h>
 #endif /* PROFILE  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 using namespace KIGFX;
 
 VIEW::VIEW( bool aIsDynamic ) :
@@ -46,7 +50,8 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_minScale( 4.0 ), m_maxScale( 15000 ),
     m_painter( NULL ),
     m_gal( NULL ),
-    m_dynamic( aIsDynamic )
+    m_dynamic( aIsDynamic ),
+    m_redrawDamagedOnly( false )
 {
     m_boundary.SetMaximum();
     m_needsUpdate.reserve( 32768 );
@@ -81,6 +86,7 @@ void VIEW::AddLayer( int aLayer, bool aDisplayOnly )
         m_layers[aLayer].visible        = true;
         m_layers[aLayer].displayOnly    = aDisplayOnly;
         m_layers[aLayer].target         = TARGET_CACHED;
+        m_layers[aLayer].minItemSize    = 0.0;
     }
 
     sortLayers();
@@ -97,11 +103,13 @@ void VIEW::Add( VIEW_ITEM* aItem )
     if( m_dynamic )
         aItem->viewAssign( this );
 
+    aItem->m_viewBBox = aItem->ViewBBox();
+
     for( int i = 0; i < layers_count; ++i )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
+        markDamaged( l.target, aItem->m_viewBBox );
     }
 
     aItem->ViewUpdate( VIEW_ITEM::ALL );
@@ -132,7 +140,7 @@ void VIEW::Remove( VIEW_ITEM* aItem )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
-        MarkTargetDirty( l.target );
+        markDamaged( l.target, aItem->m_viewBBox );
 
         // Clear the GAL cache
         int prevGroup = aItem->getGroup( layers[i] );
@@ -610,9 +618,12 @@ void VIEW::redrawRect( const BOX2I& aRect )
         {
             drawItem drawFunc( this, l->id );
 
+            // Minimal size of an item to be drawn, converted from pixels to world units
+            int minSize = l->minItemSize / m_gal->GetWorldScale();
+
             m_gal->SetTarget( l->target );
             m_gal->SetLayerDepth( l->renderingOrder );
-            l->items->Query( aRect, drawFunc );
+            l->items->Query( aRect, minSize, drawFunc );
         }
     }
 }
@@ -755,6 +766,43 @@ void VIEW::Clear()
 
 void VIEW::ClearTargets()
 {
+    VECTOR2D screenSize = m_gal->GetScreenPixelSize();
+
+    if( !IsDirty() )
+    {
+        // Nothing has changed, so nothing has to be redrawn
+        m_redrawArea = BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( 0, 0 ) );
+    }
+    else if( m_wholeViewDirty )
+    {
+        m_redrawArea = BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( screenSize ) );
+    }
+    else
+    {
+        // Compute the damaged screen area using floating point numbers, as the world area
+        // may be huge (e.g. items with unlimited bounding boxes)
+        VECTOR2D p1 = ToScreen( VECTOR2D( m_damagedArea.GetOrigin() ) );
+        VECTOR2D p2 = ToScreen( VECTOR2D( m_damagedArea.GetEnd() ) );
+
+        // Leave a margin for antialiasing
+        const double margin = 2.0;
+        double left   = std::max( std::min( p1.x, p2.x ) - margin, 0.0 );
+        double top    = std::max( std::min( p1.y, p2.y ) - margin, 0.0 );
+        double right  = std::min( std::max( p1.x, p2.x ) + margin, screenSize.x );
+        double bottom = std::min( std::max( p1.y, p2.y ) + margin, screenSize.y );
+
+        m_redrawArea = BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( 0, 0 ) );
+
+        if( left < right && top < bottom )
+        {
+            m_redrawArea.SetOrigin( (int) floor( left ), (int) floor( top ) );
+            m_redrawArea.SetEnd( (int) ceil( right ), (int) ceil( bottom ) );
+        }
+    }
+
+    bool limited = m_gal->SetDamagedArea( m_redrawArea );
+    m_redrawDamagedOnly = limited && IsDirty() && !m_wholeViewDirty;
+
     if( IsTargetDirty( TARGET_CACHED ) || IsTargetDirty( TARGET_NONCACHED ) )
     {
         // TARGET_CACHED and TARGET_NONCACHED have to be redrawn together, as they contain
@@ -762,7 +810,9 @@ void VIEW::ClearTargets()
         m_gal->ClearTarget( TARGET_NONCACHED );
         m_gal->ClearTarget( TARGET_CACHED );
 
-        MarkDirty();
+        // Redraw all the targets, as the cleared ones were composited with the others
+        for( int i = 0; i < TARGETS_NUMBER; ++i )
+            m_dirtyTargets[i] = true;
     }
 
     if( IsTargetDirty( TARGET_OVERLAY ) )
@@ -779,17 +829,27 @@ void VIEW::Redraw()
     prof_start( &totalRealTime );
 #endif /* PROFILE */
 
-    VECTOR2D screenSize = m_gal->GetScreenPixelSize();
-    BOX2I    rect( ToWorld( VECTOR2D( 0, 0 ) ),
-                   ToWorld( screenSize ) - ToWorld( VECTOR2D( 0, 0 ) ) );
+    VECTOR2D screenOrigin( 0, 0 );
+    VECTOR2D screenEnd = m_gal->GetScreenPixelSize();
+
+    if( m_redrawDamagedOnly )
+    {
+        screenOrigin = VECTOR2D( m_redrawArea.GetOrigin() );
+        screenEnd    = VECTOR2D( m_redrawArea.GetEnd() );
+    }
+
+    BOX2I rect( ToWorld( screenOrigin ), ToWorld( screenEnd ) - ToWorld( screenOrigin ) );
     rect.Normalize();
 
-    redrawRect( rect );
+    if( !m_redrawDamagedOnly || m_redrawArea.GetArea() > 0 )
+        redrawRect( rect );
 
     // All targets were redrawn, so nothing is dirty
     markTargetClean( TARGET_CACHED );
     markTargetClean( TARGET_NONCACHED );
     markTargetClean( TARGET_OVERLAY );
+    m_wholeViewDirty = false;
+    m_redrawDamagedOnly = false;
 
 #ifdef PROFILE
     prof_end( &totalRealTime );
@@ -840,12 +900,17 @@ void VIEW::clearGroupCache()
 
 void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
 {
+    // The item has to be redrawn both at its previous and its current position
+    BOX2I damaged = aItem->m_viewBBox;
+
     // updateLayers updates geometry too, so we do not have to update both of them at the same time
     if( aUpdateFlags & VIEW_ITEM::LAYERS )
         updateLayers( aItem );
     else if( aUpdateFlags & VIEW_ITEM::GEOMETRY )
         updateBbox( aItem );
 
+    damaged.Merge( aItem->m_viewBBox );
+
     int layers[VIEW_MAX_LAYERS], layers_count;
     aItem->ViewGetLayers( layers, layers_count );
 
@@ -863,7 +928,7 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         }
 
         // Mark those layers as dirty, so the VIEW will be refreshed
-        MarkTargetDirty( m_layers[layerId].target );
+        markDamaged( m_layers[layerId].target, damaged );
     }
 
     aItem->clearUpdateFlags();
@@ -937,8 +1002,9 @@ void VIEW::updateBbox( VIEW_ITEM* aItem )
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
     }
+
+    aItem->m_viewBBox = aItem->ViewBBox();
 }
 
 
@@ -953,7 +1019,7 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
-        MarkTargetDirty( l.target );
+        markDamaged( l.target, aItem->m_viewBBox );
 
         if( IsCached( l.id ) )
         {
@@ -971,16 +1037,31 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
     // Add the item to new layer set
     aItem->ViewGetLayers( layers, layers_count );
     aItem->saveLayers( layers, layers_count );
+    aItem->m_viewBBox = aItem->ViewBBox();
 
     for( int i = 0; i < layers_count; i++ )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
+        markDamaged( l.target, aItem->m_viewBBox );
     }
 }
 
 
+void VIEW::markDamaged( int aTarget, const BOX2I& aArea )
+{
+    wxASSERT( aTarget < TARGETS_NUMBER );
+
+    // Start collecting a new area if nothing was changed since the last redraw
+    if( !IsDirty() )
+        m_damagedArea = aArea;
+    else
+        m_damagedArea.Merge( aArea );
+
+    m_dirtyTargets[aTarget] = true;
+}
+
+
 bool VIEW::areRequiredLayersEnabled( int aLayerId ) const
 {
     wxASSERT( (unsigned) aLayerId < m_layers.size() );
@@ -999,6 +1080,182 @@ bool VIEW::areRequiredLayersEnabled( int aLayerId ) const
 }
 
 
+struct VIEW::collectItems
+{
+    collectItems( std::vector<VIEW_ITEM*>& aItems ) :
+        items( aItems )
+    {
+    }
+
+    bool operator()( VIEW_ITEM* aItem )
+    {
+        items.push_back( aItem );
+
+        return true;
+    }
+
+    std::vector<VIEW_ITEM*>& items;
+};
+
+
+///> An item to be recached on a layer, see VIEW::recacheConcurrently()
+struct RECACHE_JOB
+{
+    VIEW_ITEM*  item;
+    int         layer;
+    int         depth;
+    int         recorder;       ///< recorder that holds the geometry
+    int         group;          ///< group number in the recorder, -1 if the painter failed
+};
+
+
+bool VIEW::recacheConcurrently()
+{
+    int threads = 1;
+
+#ifdef USE_OPENMP
+    threads = omp_get_max_threads();
+#endif /* USE_OPENMP */
+
+    // There is nothing to gain with a single thread
+    if( threads < 2 )
+        return false;
+
+    // Each thread draws with its own recorder and painter
+    std::vector<GAL*> recorders;
+    std::vector<PAINTER*> painters;
+
+    for( int i = 0; i < threads; ++i )
+    {
+        GAL* recorder = m_gal->CreateGroupRecorder();
+        PAINTER* painter = recorder ? m_painter->Clone( recorder ) : NULL;
+
+        if( !painter )
+        {
+            delete recorder;
+            break;
+        }
+
+        recorders.push_back( recorder );
+        painters.push_back( painter );
+    }
+
+    if( (int) recorders.size() < threads )
+    {
+        for( unsigned int i = 0; i < recorders.size(); ++i )
+        {
+            delete painters[i];
+            delete recorders[i];
+        }
+
+        return false;
+    }
+
+    std::vector<RECACHE_JOB> jobs;
+    std::vector<VIEW_ITEM*> items;
+    BOX2I r;
+
+    r.SetMaximum();
+
+    for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+    {
+        VIEW_LAYER* l = &( ( *i ).second );
+
+        if( !IsCached( l->id ) )
+            continue;
+
+        collectItems visitor( items );
+        items.clear();
+        l->items->Query( r, visitor );
+
+        for( unsigned int j = 0; j < items.size(); ++j )
+        {
+            RECACHE_JOB job = { items[j], l->id, l->renderingOrder, 0, -1 };
+            jobs.push_back( job );
+        }
+    }
+
+#ifdef PROFILE
+    prof_counter geometryTime, uploadTime;
+    prof_start( &geometryTime );
+#endif /* PROFILE */
+
+    // Phase 1: the items are converted to vertices in the system memory
+    int count = jobs.size();
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) private(i)
+#endif /* USE_OPENMP */
+    for( i = 0; i < count; ++i )
+    {
+        int thread = 0;
+
+#ifdef USE_OPENMP
+        thread = omp_get_thread_num();
+#endif /* USE_OPENMP */
+
+        RECACHE_JOB& job = jobs[i];
+        GAL* recorder = recorders[thread];
+
+        recorder->SetLayerDepth( job.depth );
+        job.recorder = thread;
+        job.group = recorder->BeginGroup();
+
+        bool drawn = painters[thread]->Draw( job.item, job.layer );
+
+        recorder->EndGroup();
+
+        if( !drawn )
+            job.group = -1;
+    }
+
+#ifdef PROFILE
+    prof_end( &geometryTime );
+    prof_start( &uploadTime );
+#endif /* PROFILE */
+
+    // Phase 2: the vertices are copied to the GAL, one chunk per group
+    m_gal->SetTarget( TARGET_CACHED );
+
+    BOOST_FOREACH( RECACHE_JOB& job, jobs )
+    {
+        int group = job.item->getGroup( job.layer );
+
+        if( group >= 0 )
+            m_gal->DeleteGroup( group );
+
+        m_gal->SetLayerDepth( job.depth );
+        group = m_gal->BeginGroup();
+        job.item->setGroup( job.layer, group );
+
+        if( job.group >= 0 )
+            m_gal->DrawRecordedGroup( recorders[job.recorder], job.group );
+        else
+            job.item->ViewDraw( job.layer, m_gal ); // Alternative drawing method
+
+        m_gal->EndGroup();
+    }
+
+    MarkTargetDirty( TARGET_CACHED );
+
+#ifdef PROFILE
+    prof_end( &uploadTime );
+
+    wxLogDebug( wxT( "RecacheAllItems::geometry (%d threads): %.1f ms, upload: %.1f ms" ),
+                threads, geometryTime.msecs(), uploadTime.msecs() );
+#endif /* PROFILE */
+
+    for( unsigned int j = 0; j < recorders.size(); ++j )
+    {
+        delete painters[j];
+        delete recorders[j];
+    }
+
+    return true;
+}
+
+
 void VIEW::RecacheAllItems( bool aImmediately )
 {
     BOX2I r;
@@ -1010,17 +1267,20 @@ void VIEW::RecacheAllItems( bool aImmediately )
     prof_start( &totalRealTime );
 #endif /* PROFILE */
 
-    for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+    if( !aImmediately || !recacheConcurrently() )
     {
-        VIEW_LAYER* l = &( ( *i ).second );
-
-        if( IsCached( l->id ) )
+        for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
         {
-            m_gal->SetTarget( l->target );
-            m_gal->SetLayerDepth( l->renderingOrder );
-            recacheItem visitor( this, m_gal, l->id, aImmediately );
-            l->items->Query( r, visitor );
-            MarkTargetDirty( l->target );
+            VIEW_LAYER* l = &( ( *i ).second );
+
+            if( IsCached( l->id ) )
+            {
+                m_gal->SetTarget( l->target );
+                m_gal->SetLayerDepth( l->renderingOrder );
+                recacheItem visitor( this, m_gal, l->id, aImmediately );
+                l->items->Query( r, visitor );
+                MarkTargetDirty( l->target );
+            }
         }
     }
 
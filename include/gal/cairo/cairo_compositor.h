@@ -32,6 +32,7 @@
 #define CAIRO_COMPOSITOR_H_
 
 #include <gal/compositor.h>
+#include <math/box2.h>
 #include <cairo.h>
 #include <boost/smart_ptr/shared_array.hpp>
 #include <deque>
@@ -65,6 +66,14 @@ public:
     /// @copydoc COMPOSITOR::ClearBuffer()
     virtual void ClearBuffer();
 
+    /**
+     * Function ClearBuffer()
+     * clears a part of the currently used buffer.
+     *
+     * @param aArea is the area to be cleared (in screen coordinates).
+     */
+    void ClearBuffer( const BOX2I& aArea );
+
     /// @copydoc COMPOSITOR::DrawBuffer()
     virtual void DrawBuffer( unsigned int aBufferHandle );
 
@@ -27,13 +27,7 @@
 #ifndef CAIROGAL_H_
 #define CAIROGAL_H_
 
-#include <map>
-#include <iterator>
-
-#include <cairo.h>
-
-#include <gal/graphics_abstraction_layer.h>
-#include <boost/smart_ptr/shared_ptr.hpp>
+#include <gal/cairo/cairo_image_gal.h>
 #include <wx/dcbuffer.h>
 
 #if defined(__WXMSW__)
@@ -57,12 +51,11 @@
  * Cairo offers also backends for Postscript and PDF surfaces. So it can be used for printing
  * of KiCad graphics surfaces as well.
  *
+ * The drawing is done by CAIRO_IMAGE_GAL, this class displays the rendered image in a window.
  */
 namespace KIGFX
 {
-class CAIRO_COMPOSITOR;
-
-class CAIRO_GAL : public GAL, public wxWindow
+class CAIRO_GAL : public CAIRO_IMAGE_GAL, public wxWindow
 {
 public:
     /**
@@ -85,146 +78,15 @@ public:
 
     virtual ~CAIRO_GAL();
 
-    // ---------------
-    // Drawing methods
-    // ---------------
-
-    /// @copydoc GAL::BeginDrawing()
-    virtual void BeginDrawing();
-
     /// @copydoc GAL::EndDrawing()
     virtual void EndDrawing();
 
-    /// @copydoc GAL::DrawLine()
-    virtual void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint );
-
-    /// @copydoc GAL::DrawSegment()
-    virtual void DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint, double aWidth );
-
-    /// @copydoc GAL::DrawCircle()
-    virtual void DrawCircle( const VECTOR2D& aCenterPoint, double aRadius );
-
-    /// @copydoc GAL::DrawArc()
-    virtual void DrawArc( const VECTOR2D& aCenterPoint, double aRadius,
-                          double aStartAngle, double aEndAngle );
-
-    /// @copydoc GAL::DrawRectangle()
-    virtual void DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint );
-
-    /// @copydoc GAL::DrawPolyline()
-    virtual void DrawPolyline( std::deque<VECTOR2D>& aPointList );
-
-    /// @copydoc GAL::DrawPolygon()
-    virtual void DrawPolygon( const std::deque<VECTOR2D>& aPointList );
-
-    /// @copydoc GAL::DrawCurve()
-    virtual void DrawCurve( const VECTOR2D& startPoint, const VECTOR2D& controlPointA,
-                            const VECTOR2D& controlPointB, const VECTOR2D& endPoint );
-
-    // --------------
-    // Screen methods
-    // --------------
-
     /// @brief Resizes the canvas.
     virtual void ResizeScreen( int aWidth, int aHeight );
 
     /// @brief Shows/hides the GAL canvas
     virtual bool Show( bool aShow );
 
-    /// @copydoc GAL::Flush()
-    virtual void Flush();
-
-    /// @copydoc GAL::ClearScreen()
-    virtual void ClearScreen( const COLOR4D& aColor );
-
-    // -----------------
-    // Attribute setting
-    // -----------------
-
-    /// @copydoc GAL::SetIsFill()
-    virtual void SetIsFill( bool aIsFillEnabled );
-
-    /// @copydoc GAL::SetIsStroke()
-    virtual void SetIsStroke( bool aIsStrokeEnabled );
-
-    /// @copydoc GAL::SetStrokeColor()
-    virtual void SetStrokeColor( const COLOR4D& aColor );
-
-    /// @copydoc GAL::SetFillColor()
-    virtual void SetFillColor( const COLOR4D& aColor );
-
-    /// @copydoc GAL::SetLineWidth()
-    virtual void SetLineWidth( double aLineWidth );
-
-    /// @copydoc GAL::SetLayerDepth()
-    virtual void SetLayerDepth( double aLayerDepth );
-
-    // --------------
-    // Transformation
-    // --------------
-
-    /// @copydoc GAL::Transform()
-    virtual void Transform( const MATRIX3x3D& aTransformation );
-
-    /// @copydoc GAL::Rotate()
-    virtual void Rotate( double aAngle );
-
-    /// @copydoc GAL::Translate()
-    virtual void Translate( const VECTOR2D& aTranslation );
-
-    /// @copydoc GAL::Scale()
-    virtual void Scale( const VECTOR2D& aScale );
-
-    /// @copydoc GAL::Save()
-    virtual void Save();
-
-    /// @copydoc GAL::Restore()
-    virtual void Restore();
-
-    // --------------------------------------------
-    // Group methods
-    // ---------------------------------------------
-
-    /// @copydoc GAL::BeginGroup()
-    virtual int BeginGroup();
-
-    /// @copydoc GAL::EndGroup()
-    virtual void EndGroup();
-
-    /// @copydoc GAL::DrawGroup()
-    virtual void DrawGroup( int aGroupNumber );
-
-    /// @copydoc GAL::ChangeGroupColor()
-    virtual void ChangeGroupColor( int aGroupNumber, const COLOR4D& aNewColor );
-
-    /// @copydoc GAL::ChangeGroupDepth()
-    virtual void ChangeGroupDepth( int aGroupNumber, int aDepth );
-
-    /// @copydoc GAL::DeleteGroup()
-    virtual void DeleteGroup( int aGroupNumber );
-
-    /// @copydoc GAL::ClearCache()
-    virtual void ClearCache();
-
-    // --------------------------------------------------------
-    // Handling the world <-> screen transformation
-    // --------------------------------------------------------
-
-    /// @copydoc GAL::SaveScreen()
-    virtual void SaveScreen();
-
-    /// @copydoc GAL::RestoreScreen()
-    virtual void RestoreScreen();
-
-    /// @copydoc GAL::SetTarget()
-    virtual void SetTarget( RENDER_TARGET aTarget );
-
-    /// @copydoc GAL::GetTarget()
-    virtual RENDER_TARGET GetTarget() const;
-
-    /// @copydoc GAL::ClearTarget()
-    virtual void ClearTarget( RENDER_TARGET aTarget );
-
     // -------
     // Cursor
     // -------
@@ -259,87 +121,19 @@ public:
         paintListener = aPaintListener;
     }
 
-protected:
-    virtual void drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint );
-
 private:
     /// Super class definition
-    typedef GAL super;
-
-    // Compositing variables
-    boost::shared_ptr<CAIRO_COMPOSITOR> compositor; ///< Object for layers compositing
-    unsigned int            mainBuffer;             ///< Handle to the main buffer
-    unsigned int            overlayBuffer;          ///< Handle to the overlay buffer
-    RENDER_TARGET           currentTarget;          ///< Current rendering target
-    bool                    validCompositor;        ///< Compositor initialization flag
+    typedef CAIRO_IMAGE_GAL super;
 
     // Variables related to wxWidgets
     wxWindow*               parentWindow;           ///< Parent window
     wxEvtHandler*           mouseListener;          ///< Mouse listener
     wxEvtHandler*           paintListener;          ///< Paint listener
-    unsigned int            bufferSize;             ///< Size of buffers cairoOutput, bitmapBuffers
     unsigned char*          wxOutput;               ///< wxImage comaptible buffer
 
     // Cursor variables
-    std::deque<wxColour>    savedCursorPixels;      ///< Saved pixels of the cursor
-    bool                    isDeleteSavedPixels;    ///< True, if the saved pixels can be discarded
     wxPoint                 savedCursorPosition;    ///< The last cursor position
     wxBitmap*               cursorPixels;           ///< Cursor pixels
-    wxBitmap*               cursorPixelsSaved;      ///< Saved cursor pixels
-
-    /// Maximum number of arguments for one command
-    static const int MAX_CAIRO_ARGUMENTS = 6;
-
-    /// Definitions for the command recorder
-    enum GRAPHICS_COMMAND
-    {
-        CMD_SET_FILL,                               ///< Enable/disable filling
-        CMD_SET_STROKE,                             ///< Enable/disable stroking
-        CMD_SET_FILLCOLOR,                          ///< Set the fill color
-        CMD_SET_STROKECOLOR,                        ///< Set the stroke color
-        CMD_SET_LINE_WIDTH,                         ///< Set the line width
-        CMD_STROKE_PATH,                            ///< Set the stroke path
-        CMD_FILL_PATH,                              ///< Set the fill path
-        CMD_TRANSFORM,                              ///< Transform the actual context
-        CMD_ROTATE,                                 ///< Rotate the context
-        CMD_TRANSLATE,                              ///< Translate the context
-        CMD_SCALE,                                  ///< Scale the context
-        CMD_SAVE,                                   ///< Save the transformation matrix
-        CMD_RESTORE,                                ///< Restore the transformation matrix
-        CMD_CALL_GROUP                              ///< Call a group
-    };
-
-    /// Type definition for an graphics group element
-    typedef struct
-    {
-        GRAPHICS_COMMAND command;                   ///< Command to execute
-        double arguments[MAX_CAIRO_ARGUMENTS];      ///< Arguments for Cairo commands
-        bool boolArgument;                          ///< A bool argument
-        int intArgument;                            ///< An int argument
-        cairo_path_t* cairoPath;                    ///< Pointer to a Cairo path
-    } GROUP_ELEMENT;
-
-    // Variables for the grouping function
-    bool                        isGrouping;         ///< Is grouping enabled ?
-    bool                        isElementAdded;     ///< Was an graphic element added ?
-    typedef std::deque<GROUP_ELEMENT> GROUP;        ///< A graphic group type definition
-    std::map<int, GROUP>        groups;             ///< List of graphic groups
-    unsigned int                groupCounter;       ///< Counter used for generating keys for groups
-    GROUP*                      currentGroup;       ///< Currently used group
-
-    // Variables related to Cairo <-> wxWidgets
-    cairo_matrix_t      cairoWorldScreenMatrix; ///< Cairo world to screen transformation matrix
-    cairo_t*            currentContext;         ///< Currently used Cairo context for drawing
-    cairo_t*            context;                ///< Cairo image
-    cairo_surface_t*    surface;                ///< Cairo surface
-    unsigned int*       bitmapBuffer;           ///< Storage of the cairo image
-    unsigned int*       bitmapBufferBackup;     ///< Backup storage of the cairo image
-    int                 stride;                 ///< Stride value for Cairo
-    bool                isInitialized;          ///< Are Cairo image & surface ready to use
-    COLOR4D             backgroundColor;        ///< Background color
-
-    // Methods
-    void storePath();                           ///< Store the actual path
 
     // Event handlers
     /**
@@ -364,35 +158,15 @@ private:
     /**
      * @brief Blits cursor into the current screen.
      */
-    virtual void blitCursor( wxBufferedDC& clientDC );
-
-    /// Prepare Cairo surfaces for drawing
-    void initSurface();
-
-    /// Destroy Cairo surfaces when are not needed anymore
-    void deinitSurface();
-
-    /// Allocate the bitmaps for drawing
-    void allocateBitmaps();
-
-    /// Allocate the bitmaps for drawing
-    void deleteBitmaps();
-
-    /// Prepare the compositor
-    void setCompositor();
+    virtual void blitCursor( wxDC& clientDC );
 
     /**
-     * @brief Returns a valid key that can be used as a new group number.
+     * @brief Copies a part of the rendered image to the window.
      *
-     * @return An unique group number that is not used by any other group.
+     * @param aDC is the device context of the window.
+     * @param aArea is the area to be copied (in screen coordinates).
      */
-    unsigned int getNewGroupNumber();
-
-    /// Format used to store pixels
-    static const cairo_format_t GAL_FORMAT = CAIRO_FORMAT_RGB24;
-
-    ///> Opacity of a single layer
-    static const float LAYER_ALPHA;
+    void blitArea( wxDC& aDC, const BOX2I& aArea );
 };
 } // namespace KIGFX
 
@@ -32,6 +32,7 @@
 #include <limits>
 
 #include <math/matrix3x3.h>
+#include <math/box2.h>
 
 #include <gal/color4d.h>
 #include <gal/definitions.h>
@@ -413,6 +414,25 @@ public:
      */
     virtual void ClearCache() {};
 
+    /**
+     * @brief Create a GAL that records groups in memory, without using this GAL.
+     *
+     * Each recorder may be used by a different thread, so the contents of groups can be prepared
+     * concurrently and then added to this GAL with DrawRecordedGroup(). The recorder inherits
+     * the current view settings (world scale, zoom, etc.).
+     *
+     * @return a new recorder (to be deleted by the caller) or NULL if recording is not supported.
+     */
+    virtual GAL* CreateGroupRecorder() { return NULL; };
+
+    /**
+     * @brief Add the contents of a recorded group to the group being created.
+     *
+     * @param aRecorder is a recorder created by CreateGroupRecorder().
+     * @param aGroupNumber is the number of the group, as returned by aRecorder->BeginGroup().
+     */
+    virtual void DrawRecordedGroup( GAL* aRecorder, int aGroupNumber ) {};
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -612,6 +632,19 @@ public:
      */
     virtual void ClearTarget( RENDER_TARGET aTarget ) {};
 
+    /**
+     * @brief Limits redrawing of the current frame to a part of the screen.
+     *
+     * Clearing targets, drawing and refreshing the screen are then limited to the damaged area,
+     * the rest of the screen keeps the contents of the previous frame. It has to be called after
+     * BeginDrawing(), before the targets are cleared.
+     *
+     * @param aArea is the damaged area in screen coordinates.
+     * @return true if the GAL limits redrawing to the area, false if the whole screen has to be
+     * redrawn.
+     */
+    virtual bool SetDamagedArea( const BOX2I& aArea ) { return false; };
+
     // -------------
     // Grid methods
     // -------------
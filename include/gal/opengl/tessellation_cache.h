@@ -0,0 +1,125 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file tessellation_cache.h
+ * @brief Class to store the results of polygon tessellation.
+ */
+
+#ifndef TESSELLATION_CACHE_H_
+#define TESSELLATION_CACHE_H_
+
+#include <math/vector2d.h>
+#include <ki_mutex.h>
+
+#include <deque>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/smart_ptr/shared_ptr.hpp>
+
+namespace KIGFX
+{
+/**
+ * @brief Class TESSELLATION_CACHE stores triangles obtained by tessellating polygons.
+ *
+ * Polygons are identified by their contents (a hash of the points, verified by comparing all
+ * the points), so the triangles are reused whenever the same polygon is drawn again, regardless
+ * of the color, layer depth or rendering target. Polygons that were not drawn since the last
+ * eviction are removed when the cache grows over its size limit.
+ *
+ * All the methods are thread safe.
+ */
+class TESSELLATION_CACHE
+{
+public:
+    /// List of triangles, every three consecutive points make a triangle
+    typedef std::vector<VECTOR2D> TRIANGLES;
+    typedef boost::shared_ptr<const TRIANGLES> TRIANGLES_PTR;
+
+    /**
+     * @brief Constructor TESSELLATION_CACHE
+     *
+     * @param aMaxPoints is the maximal number of points (both polygon and triangle points) stored.
+     */
+    TESSELLATION_CACHE( unsigned int aMaxPoints = DEFAULT_MAX_POINTS );
+
+    /**
+     * @brief Returns the triangles of a previously stored polygon.
+     *
+     * @param aPolygon is the list of polygon points.
+     * @return The triangles or empty pointer if the polygon is not cached.
+     */
+    TRIANGLES_PTR Find( const std::deque<VECTOR2D>& aPolygon );
+
+    /**
+     * @brief Stores triangles obtained by tessellating a polygon.
+     *
+     * @param aPolygon is the list of polygon points.
+     * @param aTriangles is the result of tessellation. Its contents are moved to the cache.
+     * @return The stored triangles.
+     */
+    TRIANGLES_PTR Add( const std::deque<VECTOR2D>& aPolygon, TRIANGLES& aTriangles );
+
+    /**
+     * @brief Removes all the stored polygons.
+     */
+    void Clear();
+
+    /**
+     * @brief Returns the number of stored polygons.
+     */
+    unsigned int GetSize() const
+    {
+        return m_cache.size();
+    }
+
+    static const unsigned int DEFAULT_MAX_POINTS = 2 * 1024 * 1024;
+
+private:
+    struct ENTRY
+    {
+        std::vector<VECTOR2D>   polygon;        ///< Points of the tessellated polygon
+        TRIANGLES_PTR           triangles;      ///< Result of the tessellation
+        unsigned int            generation;     ///< Generation of the last use
+    };
+
+    typedef boost::unordered_multimap<std::size_t, ENTRY> CACHE_MAP;
+
+    /// Computes hash of the polygon points
+    static std::size_t hash( const std::deque<VECTOR2D>& aPolygon );
+
+    /// Returns the entry storing the polygon or NULL if there is none
+    ENTRY* find( std::size_t aHash, const std::deque<VECTOR2D>& aPolygon );
+
+    /// Removes polygons that were not used in the current generation and starts a new one
+    void evict();
+
+    CACHE_MAP       m_cache;
+    MUTEX           m_lock;
+    unsigned int    m_generation;           ///< Current generation, increased by evict()
+    unsigned int    m_pointCount;           ///< Number of points stored in the cache
+    unsigned int    m_maxPoints;            ///< Limit for m_pointCount
+};
+} // namespace KIGFX
+
+#endif  // TESSELLATION_CACHE_H_
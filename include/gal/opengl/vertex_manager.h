@@ -96,6 +96,17 @@ public:
      */
     void Vertices( const VERTEX aVertices[], unsigned int aSize ) const;
 
+    /**
+     * Function CopyVertices()
+     * adds vertices to the currently set item as they are, i.e. their color & shader parameters
+     * are kept and the current transformation matrix is not applied. It is meant for vertices
+     * prepared by another VERTEX_MANAGER (see GetAllVertices()).
+     *
+     * @param aVertices contains vertices to be added
+     * @param aSize is the number of vertices to be added.
+     */
+    void CopyVertices( const VERTEX aVertices[], unsigned int aSize ) const;
+
     /**
      * Function Color()
      * changes currently used color that will be applied to newly added vertices.
@@ -273,6 +284,15 @@ public:
      */
     VERTEX* GetVertices( const VERTEX_ITEM& aItem ) const;
 
+    /**
+     * Function GetAllVertices()
+     * returns all the vertices stored in the container.
+     *
+     * @param aSize is set to the number of stored vertices.
+     * @return Pointer to the vertices.
+     */
+    const VERTEX* GetAllVertices( unsigned int& aSize ) const;
+
     const glm::mat4& GetTransformation() const
     {
         return m_transform;
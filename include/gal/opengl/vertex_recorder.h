@@ -0,0 +1,82 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file vertex_recorder.h
+ * @brief Class to record groups of vertices in the system memory.
+ */
+
+#ifndef VERTEX_RECORDER_H_
+#define VERTEX_RECORDER_H_
+
+#include <gal/opengl/vertex_gal.h>
+
+#include <vector>
+#include <utility>
+
+namespace KIGFX
+{
+/**
+ * @brief Class VERTEX_RECORDER stores the vertices of groups in the system memory.
+ *
+ * It does not need an OpenGL context, so it may be used by any thread. The recorded groups
+ * are added to the OPENGL_GAL with OPENGL_GAL::DrawRecordedGroup().
+ */
+class VERTEX_RECORDER : public VERTEX_GAL
+{
+public:
+    /**
+     * @brief Constructor VERTEX_RECORDER
+     *
+     * @param aGal is the GAL whose view settings (world scale, zoom, etc.) are copied.
+     * @param aTessCache is the tessellation cache to be used (it may be shared between threads).
+     */
+    VERTEX_RECORDER( const GAL& aGal, TESSELLATION_CACHE* aTessCache = NULL );
+
+    /// @copydoc GAL::BeginGroup()
+    virtual int BeginGroup();
+
+    /// @copydoc GAL::EndGroup()
+    virtual void EndGroup();
+
+    /// @copydoc GAL::ClearCache()
+    virtual void ClearCache();
+
+    /**
+     * @brief Returns the vertices of a recorded group.
+     *
+     * @param aGroupNumber is the group number.
+     * @param aSize is set to the number of vertices of the group.
+     * @return Pointer to the vertices, valid until another group is recorded.
+     */
+    const VERTEX* GetGroupVertices( int aGroupNumber, unsigned int& aSize ) const;
+
+private:
+    VERTEX_MANAGER          recordManager;          ///< Container for the recorded vertices
+
+    /// Offset of the first vertex and number of vertices of each group
+    std::vector< std::pair<unsigned int, unsigned int> > groups;
+};
+} // namespace KIGFX
+
+#endif  // VERTEX_RECORDER_H_
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <cstdio>
+#include <boost/shared_ptr.hpp>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 
@@ -39,7 +40,11 @@
  * Represents a set of closed polygons. Polygons may be nonconvex, self-intersecting
  * and have holes. Provides boolean operations (using Clipper library as the backend).
  *
- * TODO: add convex partitioning & spatial index
+ * Point and segment queries (Contains(), Collide()) on large polygons use an edge index
+ * per polygon, built on the first query and dropped when the polygon is modified
+ * (including handing out a non-const reference to it).
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -96,7 +101,8 @@ class SHAPE_POLY_SET : public SHAPE
 
             T& Get()
             {
-                return m_poly->Polygon( m_currentOutline )[0].Point( m_currentVertex );
+                // the edge index of the iterated outlines is dropped by Iterate()
+                return m_poly->m_polys[m_currentOutline][0].Point( m_currentVertex );
             }
 
             T& operator*()
@@ -172,18 +178,21 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            invalidateEdgeIndex( aIndex );
             return m_polys[aIndex][0];
         }
 
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            invalidateEdgeIndex( aOutline );
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            invalidateEdgeIndex( aIndex );
             return m_polys[aIndex];
         }
 
@@ -212,6 +221,9 @@ class SHAPE_POLY_SET : public SHAPE
             iter.m_lastOutline = aLast < 0 ? OutlineCount() - 1 : aLast;
             iter.m_currentVertex = 0;
 
+            for( int i = aFirst; i <= iter.m_lastOutline; i++ )
+                invalidateEdgeIndex( i );
+
             return iter;
         }
 
@@ -309,13 +321,17 @@ class SHAPE_POLY_SET : public SHAPE
 
         const BOX2I BBox( int aClearance = 0 ) const;
 
-        // fixme: add collision support
-        bool Collide( const VECTOR2I& aP, int aClearance = 0 ) const { return false; }
-        bool Collide( const SEG& aSeg, int aClearance = 0 ) const { return false; }
+        ///> Returns true if the point aP is inside the set, or closer than aClearance
+        ///> to one of its outlines or holes
+        bool Collide( const VECTOR2I& aP, int aClearance = 0 ) const;
 
+        ///> Returns true if the segment aSeg is inside the set, crosses it, or is closer than
+        ///> aClearance to one of its outlines or holes
+        bool Collide( const SEG& aSeg, int aClearance = 0 ) const;
 
         ///> Returns true is a given subpolygon contains the point aP. If aSubpolyIndex < 0 (default value),
-        ///> checks all polygons in the set
+        ///> checks all polygons in the set. Points inside holes are not contained, points on
+        ///> the outline or hole edges are.
         bool Contains( const VECTOR2I& aP, int aSubpolyIndex = -1 ) const;
 
         ///> Returns true if the set is empty (no polygons at all)
@@ -334,6 +350,22 @@ class SHAPE_POLY_SET : public SHAPE
         void DeletePolygon( int aIdx );
 
     private:
+        class EDGE_INDEX;
+
+        ///> Polygons with fewer vertices are queried without building an edge index
+        static const int INDEX_MIN_VERTICES = 64;
+
+        ///> Edge index of one polygon, shared between copies of the set until the polygon
+        ///> is modified
+        struct POLYGON_INDEX
+        {
+            POLYGON_INDEX() : m_ptr( NULL ) {}
+
+            boost::shared_ptr<EDGE_INDEX> m_index;
+
+            ///> m_index, published once it is completely built, so it can be read without locking
+            const EDGE_INDEX* m_ptr;
+        };
 
         SHAPE_LINE_CHAIN& getContourForCorner( int aCornerId, int& aIndexWithinContour );
         VECTOR2I& vertex( int aCornerId );
@@ -361,7 +393,23 @@ class SHAPE_POLY_SET : public SHAPE
                         const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, bool aFastMode = false );
 
-        bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
+        bool pointInPolygon( const VECTOR2I& aP, const POLYGON& aPolygon ) const;
+
+        ///> Returns the edge index of aPolygon (building it if needed), or NULL if the
+        ///> polygon is too small to need one
+        const EDGE_INDEX* edgeIndex( int aPolygon ) const;
+
+        ///> Drops the edge index of aPolygon, to be called when the polygon is modified
+        void invalidateEdgeIndex( int aPolygon )
+        {
+            m_edgeIndex[aPolygon] = POLYGON_INDEX();
+        }
+
+        ///> Drops the edge index of all polygons, to be called after the set is rebuilt
+        void resetEdgeIndex()
+        {
+            m_edgeIndex.assign( m_polys.size(), POLYGON_INDEX() );
+        }
 
         const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
         const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
@@ -369,6 +417,9 @@ class SHAPE_POLY_SET : public SHAPE
         typedef std::vector<POLYGON> Polyset;
 
         Polyset m_polys;
+
+        ///> Edge indexes of the polygons, m_edgeIndex[i] is the one of m_polys[i]
+        mutable std::vector<POLYGON_INDEX> m_edgeIndex;
 };
 
 #endif
@@ -249,6 +249,31 @@ public:
         return rc;
     }
 
+    /**
+     * Function Intersect
+     * @return BOX2 - the common area of this rectangle and the argument rectangle, or an empty
+     * rectangle if they do not intersect.
+     */
+    BOX2<Vec> Intersect( const BOX2<Vec>& aRect ) const
+    {
+        BOX2<Vec>   me( *this );
+        BOX2<Vec>   rect( aRect );
+        me.Normalize();         // ensure size is >= 0
+        rect.Normalize();       // ensure size is >= 0
+
+        Vec topLeft, bottomRight;
+
+        topLeft.x     = std::max( me.m_Pos.x, rect.m_Pos.x );
+        bottomRight.x = std::min( me.m_Pos.x + me.m_Size.x, rect.m_Pos.x + rect.m_Size.x );
+        topLeft.y     = std::max( me.m_Pos.y, rect.m_Pos.y );
+        bottomRight.y = std::min( me.m_Pos.y + me.m_Size.y, rect.m_Pos.y + rect.m_Size.y );
+
+        if( topLeft.x < bottomRight.x && topLeft.y < bottomRight.y )
+            return BOX2<Vec>( topLeft, bottomRight - topLeft );
+        else
+            return BOX2<Vec>( Vec( 0, 0 ), Vec( 0, 0 ) );
+    }
+
     const std::string Format() const
     {
         std::stringstream ss;
@@ -301,6 +301,18 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function Clone
+     * creates a copy of the painter, with the same settings, that draws using another GAL.
+     * Different copies may draw items concurrently (from different threads).
+     * @param aGal is the GAL to be used by the copy.
+     * @return the copy (to be deleted by the caller) or NULL if the painter cannot be copied.
+     */
+    virtual PAINTER* Clone( GAL* aGal ) const
+    {
+        return NULL;
+    }
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
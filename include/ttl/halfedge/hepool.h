@@ -0,0 +1,203 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file hepool.h
+ * @brief Pooled allocation of the nodes and edges of the half-edge data structure.
+ */
+
+#ifndef _HE_POOL_H_
+#define _HE_POOL_H_
+
+#include <new>
+#include <vector>
+#include <utility>
+#include <boost/pool/pool.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace hed
+{
+
+/**
+ * Class POOL
+ * hands out fixed size memory blocks, taken from large chunks and recycled through a
+ * free list. Nodes and edges (together with their shared_ptr reference counters) are
+ * small objects which are created and destroyed by thousands on every ratsnest update,
+ * so that is much cheaper than going through the heap for each of them.
+ *
+ * A pool is not thread safe: it is meant to be used by one thread at a time (e.g. the
+ * ratsnest of a single net).
+ */
+class POOL : public boost::noncopyable
+{
+public:
+    ~POOL()
+    {
+        for( unsigned i = 0; i < m_pools.size(); ++i )
+            delete m_pools[i].second;
+    }
+
+    void* Allocate( std::size_t aSize )
+    {
+        void* block = getPool( aSize ).malloc();
+
+        if( !block )
+            throw std::bad_alloc();
+
+        return block;
+    }
+
+    void Free( void* aBlock, std::size_t aSize )
+    {
+        getPool( aSize ).free( aBlock );
+    }
+
+private:
+    ///> Number of blocks allocated at once, when a pool runs out of free blocks
+    static const std::size_t CHUNK_BLOCKS = 256;
+
+    boost::pool<>& getPool( std::size_t aSize )
+    {
+        // There are only a few object sizes (node, edge, ratsnest edge), a linear search is fine
+        for( unsigned i = 0; i < m_pools.size(); ++i )
+        {
+            if( m_pools[i].first == aSize )
+                return *m_pools[i].second;
+        }
+
+        m_pools.push_back( std::make_pair( aSize, new boost::pool<>( aSize, CHUNK_BLOCKS ) ) );
+
+        return *m_pools.back().second;
+    }
+
+    ///> Pools of blocks, by block size
+    std::vector<std::pair<std::size_t, boost::pool<>*> > m_pools;
+};
+
+
+typedef boost::shared_ptr<POOL> POOL_PTR;
+
+
+/**
+ * Class POOL_ALLOCATOR
+ * is a standard allocator taking single objects from a POOL, to be used with
+ * boost::allocate_shared(). Every allocator holds a reference to the pool, so the pool
+ * lives as long as any object allocated from it.
+ */
+template <class T>
+class POOL_ALLOCATOR
+{
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef POOL_ALLOCATOR<U> other;
+    };
+
+    POOL_ALLOCATOR( const POOL_PTR& aPool ) :
+        m_pool( aPool )
+    {
+    }
+
+    template <class U>
+    POOL_ALLOCATOR( const POOL_ALLOCATOR<U>& aOther ) :
+        m_pool( aOther.Pool() )
+    {
+    }
+
+    pointer allocate( size_type aCount, const void* = 0 )
+    {
+        if( aCount == 1 )
+            return static_cast<pointer>( m_pool->Allocate( sizeof( T ) ) );
+
+        return static_cast<pointer>( ::operator new( aCount * sizeof( T ) ) );
+    }
+
+    void deallocate( pointer aPtr, size_type aCount )
+    {
+        if( aCount == 1 )
+            m_pool->Free( aPtr, sizeof( T ) );
+        else
+            ::operator delete( aPtr );
+    }
+
+    void construct( pointer aPtr, const T& aValue )
+    {
+        new( aPtr ) T( aValue );
+    }
+
+    void destroy( pointer aPtr )
+    {
+        aPtr->~T();
+    }
+
+    pointer address( reference aRef ) const
+    {
+        return &aRef;
+    }
+
+    const_pointer address( const_reference aRef ) const
+    {
+        return &aRef;
+    }
+
+    size_type max_size() const
+    {
+        return std::size_t( -1 ) / sizeof( T );
+    }
+
+    const POOL_PTR& Pool() const
+    {
+        return m_pool;
+    }
+
+private:
+    POOL_PTR m_pool;
+};
+
+
+template <class T, class U>
+bool operator==( const POOL_ALLOCATOR<T>& aFirst, const POOL_ALLOCATOR<U>& aSecond )
+{
+    return aFirst.Pool() == aSecond.Pool();
+}
+
+
+template <class T, class U>
+bool operator!=( const POOL_ALLOCATOR<T>& aFirst, const POOL_ALLOCATOR<U>& aSecond )
+{
+    return aFirst.Pool() != aSecond.Pool();
+}
+
+} // namespace hed
+
+#endif /* _HE_POOL_H_ */
@@ -52,6 +52,7 @@
 #include <ttl/ttl_util.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <ttl/halfedge/hepool.h>
 #include <layers_id_colors_and_visibility.h>
 
 class BOARD_CONNECTED_ITEM;
@@ -369,6 +370,15 @@ protected:
 
     ttl::TRIANGULATION_HELPER* m_helper;
 
+    /// Pool for the created nodes and edges (if not set, they are allocated on the heap)
+    POOL_PTR m_pool;
+
+    /// Creates a node, taken from the pool if there is one
+    NODE_PTR newNode( int aX, int aY );
+
+    /// Creates an edge, taken from the pool if there is one
+    EDGE_PTR newEdge();
+
     void addLeadingEdge( EDGE_PTR& aEdge )
     {
         aEdge->SetAsLeadingEdge();
@@ -433,6 +443,9 @@ public:
     /// Default constructor
     TRIANGULATION();
 
+    /// Constructor, creating the nodes and edges in aPool
+    TRIANGULATION( const POOL_PTR& aPool );
+
     /// Copy constructor
     TRIANGULATION( const TRIANGULATION& aTriangulation );
 
@@ -482,6 +495,10 @@ public:
     /// Returns a list of half-edges (one half-edge for each arc)
     std::list<EDGE_PTR>* GetEdges( bool aSkipBoundaryEdges = false ) const;
 
+    /// Appends the half-edges (one half-edge for each arc) to aEdges, in the same order
+    /// as the list returned by GetEdges()
+    void GetEdges( std::vector<EDGE_PTR>& aEdges, bool aSkipBoundaryEdges = false ) const;
+
 #ifdef TTL_USE_NODE_FLAG
     /// Sets flag in all the nodes
     void FlagNodes( bool aFlag ) const;
@@ -366,6 +366,20 @@ public:
         m_layers[aLayer].target = aTarget;
     }
 
+    /**
+     * Function SetLayerMinItemSize()
+     * Sets the minimal on-screen size of items drawn on a particular layer. Items whose bounding
+     * box is smaller than the limit in both dimensions are not drawn (level of details).
+     * @param aLayer is the layer.
+     * @param aPixels is the minimal size expressed in pixels, 0 disables the limit.
+     */
+    inline void SetLayerMinItemSize( int aLayer, double aPixels )
+    {
+        wxASSERT( aLayer < (int) m_layers.size() );
+
+        m_layers[aLayer].minItemSize = aPixels;
+    }
+
     /**
      * Function SetLayerOrder()
      * Sets rendering order of a particular layer. Lower values are rendered first.
@@ -450,13 +464,14 @@ public:
 
     /**
      * Function ClearTargets()
-     * Clears targets that are marked as dirty.
+     * Clears targets that are marked as dirty. If the GAL supports it, clearing and the following
+     * Redraw() are limited to the part of the screen covered by the changed items.
      */
     void ClearTargets();
 
     /**
      * Function Redraw()
-     * Immediately redraws the whole view.
+     * Immediately redraws the whole view (or its damaged part, see ClearTargets()).
      */
     void Redraw();
 
@@ -517,6 +532,7 @@ public:
         wxASSERT( aTarget < TARGETS_NUMBER );
 
         m_dirtyTargets[aTarget] = true;
+        m_wholeViewDirty = true;
     }
 
     /// Returns true if the layer is cached
@@ -542,6 +558,8 @@ public:
     {
         for( int i = 0; i < TARGETS_NUMBER; ++i )
             m_dirtyTargets[i] = true;
+
+        m_wholeViewDirty = true;
     }
 
     /**
@@ -574,6 +592,7 @@ private:
         int                     id;              ///< layer ID
         RENDER_TARGET           target;          ///< where the layer should be rendered
         std::set<int>           requiredLayers;  ///< layers that have to be enabled to show the layer
+        double                  minItemSize;     ///< items smaller than this (in pixels) are not drawn
     };
 
     // Convenience typedefs
@@ -590,6 +609,7 @@ private:
     struct updateItemsColor;
     struct changeItemsDepth;
     struct extentsVisitor;
+    struct collectItems;
 
 
     ///* Redraws contents within rect aRect
@@ -602,6 +622,15 @@ private:
         m_dirtyTargets[aTarget] = false;
     }
 
+    /**
+     * Function markDamaged()
+     * Marks a target as dirty, but only in the given area, so the rest of the screen
+     * does not have to be redrawn (if the GAL supports it).
+     * @param aTarget is the target to be marked.
+     * @param aArea is the changed area (in world coordinates).
+     */
+    void markDamaged( int aTarget, const BOX2I& aArea );
+
     /**
      * Function draw()
      * Draws an item, but on a specified layers. It has to be marked that some of drawing settings
@@ -634,6 +663,14 @@ private:
      */
     void draw( VIEW_GROUP* aGroup, bool aImmediate = false );
 
+    /**
+     * Function recacheConcurrently()
+     * Rebuilds GAL display lists in two phases: the geometry of items is generated by several
+     * threads, then it is added to the GAL by the calling thread.
+     * @return false if the GAL or the painter do not allow it (nothing is recached then).
+     */
+    bool recacheConcurrently();
+
     ///* Sorts m_orderedLayers when layer rendering order has changed
     void sortLayers();
 
@@ -710,6 +747,18 @@ private:
     /// Flags to mark targets as dirty, so they have to be redrawn on the next refresh event
     bool m_dirtyTargets[TARGETS_NUMBER];
 
+    /// Area that has changed since the last redraw (in world coordinates)
+    BOX2I m_damagedArea;
+
+    /// Whether the whole screen has to be redrawn, regardless of the damaged area
+    bool m_wholeViewDirty;
+
+    /// Whether the current frame is limited to m_redrawArea (set by ClearTargets())
+    bool m_redrawDamagedOnly;
+
+    /// Screen area redrawn in the current frame
+    BOX2I m_redrawArea;
+
     /// Rendering order modifier for layers that are marked as top layers
     static const int TOP_LAYER_MODIFIER;
 
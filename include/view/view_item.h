@@ -304,6 +304,9 @@ protected:
     /// Stores layer numbers used by the item.
     std::bitset<VIEW::VIEW_MAX_LAYERS> m_layers;
 
+    /// Bounding box of the item at the moment it was indexed by the VIEW.
+    BOX2I m_viewBBox;
+
     /**
      * Function saveLayers()
      * Saves layers used by the item.
@@ -85,7 +85,64 @@ public:
         VIEW_RTREE_BASE::Search( mmin, mmax, aVisitor );
     }
 
+    /**
+     * Function Query()
+     * Executes a function object aVisitor for each item whose bounding box intersects
+     * with aBounds and is not smaller than aMinSize in both dimensions. Subtrees that are
+     * entirely below the size limit are skipped without visiting their items.
+     */
+    template <class Visitor>
+    void Query( const BOX2I& aBounds, int aMinSize, Visitor& aVisitor )    // const
+    {
+        if( aMinSize <= 0 )
+        {
+            Query( aBounds, aVisitor );
+            return;
+        }
+
+        Rect rect;
+
+        rect.m_min[0] = aBounds.GetX();
+        rect.m_min[1] = aBounds.GetY();
+        rect.m_max[0] = aBounds.GetRight();
+        rect.m_max[1] = aBounds.GetBottom();
+
+        querySized( m_root, &rect, aMinSize, aVisitor );
+    }
+
 private:
+    /// Returns true if the rectangle is smaller than aMinSize in both dimensions
+    static bool isTooSmall( const Rect& aRect, int aMinSize )
+    {
+        return ( aRect.m_max[0] - aRect.m_min[0] ) < aMinSize &&
+               ( aRect.m_max[1] - aRect.m_min[1] ) < aMinSize;
+    }
+
+    template <class Visitor>
+    bool querySized( Node* aNode, Rect* aRect, int aMinSize, Visitor& aVisitor )
+    {
+        for( int i = 0; i < aNode->m_count; ++i )
+        {
+            Branch& branch = aNode->m_branch[i];
+
+            // A branch bounding box contains all of its children, so if it is too small,
+            // then there is nothing to be drawn in the whole subtree
+            if( !Overlap( aRect, &branch.m_rect ) || isTooSmall( branch.m_rect, aMinSize ) )
+                continue;
+
+            if( aNode->IsInternalNode() )
+            {
+                if( !querySized( branch.m_child, aRect, aMinSize, aVisitor ) )
+                    return false;
+            }
+            else if( !aVisitor( branch.m_data ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
 };
 } // namespace KIGFX
 
@@ -199,6 +199,20 @@ protected:
      */
     void duplicateZone( wxDC* aDC, ZONE_CONTAINER* aZone );
 
+    /**
+     * Function fillZones
+     * fills the given zones concurrently, on working copies of them, and stores the
+     * fillings in the zones from the calling thread.
+     * @param aZones = the zones to fill (keepout areas excluded).
+     * @param aActiveWindow = the parent of the progress dialog, or NULL to not show it.
+     * @param aFailedZones = if not NULL, receives the zones whose filling cannot be built
+     *                       (malformed outlines).
+     * @return true if all the zones are filled, false if the fill was aborted (the
+     * zones filled before the abort keep their new filling).
+     */
+    bool fillZones( const std::vector<ZONE_CONTAINER*>& aZones, wxWindow* aActiveWindow,
+                    std::vector<ZONE_CONTAINER*>* aFailedZones = NULL );
+
     /**
      * Function moveExact
      * Move the selected item exactly
@@ -1399,12 +1413,27 @@ public:
      * Function Fill_All_Zones
      *  Fill all zones on the board
      * The old fillings are removed
+     * The fillings are calculated concurrently (see fillZones()).
      * @param aActiveWindow = the current active window, if a progress bar is shown
      *                      = NULL to do not display a progress bar
-     * @param aVerbose = true to show error messages
+     * @param aVerbose = true to show the zones which cannot be filled
+     * @return error level (0 = no error, 1 = the fill was aborted or some zones
+     *         cannot be filled)
      */
     int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
 
+    /**
+     * Function Fill_Dirty_Zones
+     * Refill only the filled zones touched by an edit since they were filled (see
+     * BOARD::GetDirtyZones()), so the cost depends on the edit and not on the board size.
+     * The zones are filled like in Fill_All_Zones(), but the old zone segments are kept.
+     * The connectivity and the ratsnest are updated for the nets of the refilled zones.
+     * @param aActiveWindow = the current active window, if a progress bar is shown
+     *                      = NULL to do not display a progress bar
+     * @return the number of refilled zones
+     */
+    int Fill_Dirty_Zones( wxWindow* aActiveWindow );
+
 
     /**
      * Function Add_Zone_Cutout
@@ -0,0 +1,62 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_listener.h
+ * @brief Interface of the objects notified of the changes of a BOARD.
+ */
+
+#ifndef BOARD_LISTENER_H
+#define BOARD_LISTENER_H
+
+class BOARD_ITEM;
+
+/**
+ * Class BOARD_LISTENER
+ * is notified of the changes of a BOARD it is registered to (see BOARD::AddListener()),
+ * so that data built from the board items can be updated instead of rebuilt.
+ * Notifications are sent from BOARD::Add(), BOARD::Remove() and the undo/redo code,
+ * the listener must not modify the board while handling them.
+ */
+class BOARD_LISTENER
+{
+public:
+    virtual ~BOARD_LISTENER() {}
+
+    ///> Called after aItem has been added to the board.
+    virtual void OnBoardItemAdded( BOARD_ITEM* aItem ) {}
+
+    ///> Called after aItem has been removed from the board (it is not deleted yet).
+    virtual void OnBoardItemRemoved( BOARD_ITEM* aItem ) {}
+
+    ///> Called when aItem is about to be modified (moved, rotated, properties edited...).
+    virtual void OnBoardItemChanged( BOARD_ITEM* aItem ) {}
+
+    ///> Called when any item may have been modified without notice (e.g. by a netlist update).
+    virtual void OnBoardChanged() {}
+
+    ///> Called when the board is being destroyed, the listener is unregistered.
+    virtual void OnBoardDestroyed() {}
+};
+
+#endif /* BOARD_LISTENER_H */
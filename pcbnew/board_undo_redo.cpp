@@ -299,6 +299,58 @@ void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
 }
 
 
+/**
+ * Function markZonesDirtyAtPreviousPlace
+ * marks as dirty the zones around the place an item had before a command.
+ * Legacy tools save the command after the edit, so BOARD::MarkZonesDirtyOnEdit()
+ * only sees the new place of the item.
+ * @param aPcb = the board
+ * @param aItem = the edited item, at its new place
+ * @param aImage = the copy of the item before the edit (UR_CHANGED only), or NULL
+ * @param aCommand = the command applied to aItem
+ * @param aTransformPoint = the move vector, or the rotation/flip center
+ * @param aRotationAngle = the rotation angle, in 0.1 degrees
+ */
+static void markZonesDirtyAtPreviousPlace( BOARD* aPcb, BOARD_ITEM* aItem, BOARD_ITEM* aImage,
+                                           UNDO_REDO_T aCommand, const wxPoint& aTransformPoint,
+                                           int aRotationAngle )
+{
+    switch( aCommand )
+    {
+    case UR_CHANGED:
+        if( aImage )
+            aPcb->MarkZonesDirty( aImage );
+        break;
+
+    case UR_MOVED:
+        aPcb->MarkZonesDirty( aItem, -aTransformPoint );
+        break;
+
+    case UR_ROTATED:
+    case UR_ROTATED_CLOCKWISE:
+    case UR_FLIPPED:
+    {
+        // Build the item at its previous place, the same way undo does
+        BOARD_ITEM* previous = static_cast<BOARD_ITEM*>( aItem->Clone() );
+
+        if( aCommand == UR_ROTATED )
+            previous->Rotate( aTransformPoint, -aRotationAngle );
+        else if( aCommand == UR_ROTATED_CLOCKWISE )
+            previous->Rotate( aTransformPoint, aRotationAngle );
+        else
+            previous->Flip( aTransformPoint );
+
+        aPcb->MarkZonesDirty( previous );
+        delete previous;
+    }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
 void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
                                          UNDO_REDO_T    aCommandType,
                                          const wxPoint& aTransformPoint )
@@ -318,6 +370,15 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
         aCommandType = UR_CHANGED;
     }
 
+    // The zones around the item must be refilled: the ones at its current place
+    // (marked again when the dirty zones are requested, to catch the edit when the
+    // command is saved before it) and, for tools saving the command after the edit,
+    // the ones at its previous place.
+    GetBoard()->MarkZonesDirtyOnEdit( aItem );
+    markZonesDirtyAtPreviousPlace( GetBoard(), aItem, NULL, aCommandType,
+                                   aTransformPoint, m_rotationAngle );
+    GetBoard()->NotifyItemChanged( aItem );
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -412,6 +473,15 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
         wxASSERT( item );
 
+        // The zones around the item must be refilled: the ones at its current place
+        // (marked again when the dirty zones are requested) and the ones at its
+        // previous place, given by the image supplied by the caller or by the command.
+        GetBoard()->MarkZonesDirtyOnEdit( item );
+        markZonesDirtyAtPreviousPlace( GetBoard(), item,
+                                       (BOARD_ITEM*) commandToUndo->GetPickedItemLink( ii ),
+                                       command, aTransformPoint, m_rotationAngle );
+        GetBoard()->NotifyItemChanged( item );
+
         switch( command )
         {
         case UR_CHANGED:
@@ -508,6 +578,14 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
 
         item->ClearFlags();
 
+        // The zones around the item, before and after the change, must be refilled.
+        // Added and removed items are handled by BOARD::Add() and BOARD::Remove()
+        if( status != UR_NEW && status != UR_DELETED )
+        {
+            GetBoard()->MarkZonesDirtyOnEdit( item );
+            GetBoard()->NotifyItemChanged( item );
+        }
+
         // see if we must rebuild ratsnets and pointers lists
         switch( item->Type() )
         {
@@ -42,6 +42,7 @@
 #include <reporter.h>
 #include <base_units.h>
 #include <ratsnest_data.h>
+#include <connectivity.h>
 #include <ratsnest_viewitem.h>
 #include <worksheet_viewitem.h>
 
@@ -105,13 +106,21 @@ BOARD::BOARD() :
     m_designSettings.SetCustomViaSize( m_designSettings.GetCurrentViaSize() );
     m_designSettings.SetCustomViaDrill( m_designSettings.GetCurrentViaDrill() );
 
-    // Initialize ratsnest
+    // Initialize connectivity and ratsnest (which feeds the connectivity with the board changes)
+    m_connectivity = new CONNECTIVITY_DATA( this );
     m_ratsnest = new RN_DATA( this );
 }
 
 
 BOARD::~BOARD()
 {
+    // Listeners must not be notified of the items deleted below
+    std::vector<BOARD_LISTENER*> listeners;
+    listeners.swap( m_listeners );
+
+    for( unsigned i = 0; i < listeners.size(); ++i )
+        listeners[i]->OnBoardDestroyed();
+
     while( m_ZoneDescriptorList.size() )
     {
         ZONE_CONTAINER* area_to_remove = m_ZoneDescriptorList[0];
@@ -119,6 +128,7 @@ BOARD::~BOARD()
     }
 
     delete m_ratsnest;
+    delete m_connectivity;
 
     m_FullRatsnest.clear();
     m_LocalRatsnest.clear();
@@ -749,6 +759,10 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
     }
 
     m_ratsnest->Add( aBoardItem );
+    MarkZonesDirty( aBoardItem );
+
+    for( unsigned i = 0; i < m_listeners.size(); ++i )
+        m_listeners[i]->OnBoardItemAdded( aBoardItem );
 }
 
 
@@ -813,11 +827,189 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
     }
 
     m_ratsnest->Remove( aBoardItem );
+    MarkZonesDirty( aBoardItem );
+
+    // Its place has just been marked, and its address may be reused by a new item
+    m_editedItems.erase( aBoardItem );
+
+    for( unsigned i = 0; i < m_listeners.size(); ++i )
+        m_listeners[i]->OnBoardItemRemoved( aBoardItem );
 
     return aBoardItem;
 }
 
 
+void BOARD::AddListener( BOARD_LISTENER* aListener )
+{
+    if( std::find( m_listeners.begin(), m_listeners.end(), aListener ) == m_listeners.end() )
+        m_listeners.push_back( aListener );
+}
+
+
+void BOARD::RemoveListener( BOARD_LISTENER* aListener )
+{
+    std::vector<BOARD_LISTENER*>::iterator it =
+        std::find( m_listeners.begin(), m_listeners.end(), aListener );
+
+    if( it != m_listeners.end() )
+        m_listeners.erase( it );
+}
+
+
+void BOARD::NotifyItemChanged( BOARD_ITEM* aItem )
+{
+    for( unsigned i = 0; i < m_listeners.size(); ++i )
+        m_listeners[i]->OnBoardItemChanged( aItem );
+}
+
+
+void BOARD::NotifyBoardChanged() const
+{
+    for( unsigned i = 0; i < m_listeners.size(); ++i )
+        m_listeners[i]->OnBoardChanged();
+}
+
+
+void BOARD::MarkZonesDirty( const EDA_RECT& aArea, LSET aLayers, const ZONE_CONTAINER* aSkip )
+{
+    for( unsigned i = 0; i < m_ZoneDescriptorList.size(); ++i )
+    {
+        ZONE_CONTAINER* zone = m_ZoneDescriptorList[i];
+
+        // Keepout areas are never filled
+        if( zone == aSkip || zone->GetIsKeepout() || !aLayers[zone->GetLayer()] )
+            continue;
+
+        // Items are removed from the zone with the zone clearance, or used to build
+        // thermal reliefs, so the zone can be changed by items a bit outside of it
+        EDA_RECT zoneArea = zone->GetBoundingBox();
+        zoneArea.Inflate( zone->GetZoneClearance() + zone->GetThermalReliefGap() +
+                          zone->GetMinThickness() );
+
+        if( zoneArea.Intersects( aArea ) )
+            zone->MarkDirty( aArea );
+    }
+}
+
+
+void BOARD::MarkZonesDirty( BOARD_ITEM* aItem, const wxPoint& aOffset )
+{
+    if( m_ZoneDescriptorList.empty() )
+        return;
+
+    LSET layers = aItem->GetLayerSet();
+    int  clearance = GetDesignSettings().GetBiggestClearanceValue();
+
+    switch( aItem->Type() )
+    {
+    case PCB_MARKER_T:
+    case PCB_ZONE_T:        // obsolete zone segments are not used to fill zones
+        return;
+
+    case PCB_MODULE_T:
+        // Pad holes are removed from the zones on all the copper layers, and pads can
+        // have a local clearance
+        layers = LSET::AllLayersMask();
+
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+            clearance = std::max( clearance, pad->GetClearance() );
+
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        clearance = std::max( clearance, static_cast<TRACK*>( aItem )->GetClearance() );
+        break;
+
+    default:
+        // Board edges are removed from the zones on all the layers
+        if( layers[Edge_Cuts] )
+            layers = LSET::AllLayersMask();
+
+        break;
+    }
+
+    EDA_RECT area = aItem->GetBoundingBox();
+    area.Move( aOffset );
+    area.Inflate( clearance );
+
+    MarkZonesDirty( area, layers, dynamic_cast<ZONE_CONTAINER*>( aItem ) );
+}
+
+
+void BOARD::MarkZonesDirtyOnEdit( BOARD_ITEM* aItem )
+{
+    MarkZonesDirty( aItem );
+
+    if( aItem->Type() == PCB_ZONE_AREA_T )
+    {
+        ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*>( aItem );
+        zone->MarkDirty( zone->GetBoundingBox() );
+    }
+
+    m_editedItems.insert( aItem );
+}
+
+
+void BOARD::markEditedItemsZonesDirty()
+{
+    if( m_editedItems.empty() )
+        return;
+
+    // Edited items can have been deleted without BOARD::Remove() since they were recorded:
+    // only the ones still on the board can be used
+    std::vector<BOARD_ITEM*> boardItems;
+
+    for( TRACK* track = m_Track; track; track = track->Next() )
+        boardItems.push_back( track );
+
+    for( MODULE* module = m_Modules; module; module = module->Next() )
+        boardItems.push_back( module );
+
+    for( BOARD_ITEM* item = m_Drawings; item; item = item->Next() )
+        boardItems.push_back( item );
+
+    boardItems.insert( boardItems.end(), m_ZoneDescriptorList.begin(),
+                       m_ZoneDescriptorList.end() );
+
+    std::sort( boardItems.begin(), boardItems.end() );
+
+    for( std::set<BOARD_ITEM*>::const_iterator it = m_editedItems.begin();
+         it != m_editedItems.end(); ++it )
+    {
+        if( std::binary_search( boardItems.begin(), boardItems.end(), *it ) )
+            MarkZonesDirty( *it );
+    }
+
+    m_editedItems.clear();
+}
+
+
+void BOARD::GetDirtyZones( std::vector<ZONE_CONTAINER*>& aZones )
+{
+    markEditedItemsZonesDirty();
+
+    aZones.clear();
+
+    for( unsigned i = 0; i < m_ZoneDescriptorList.size(); ++i )
+    {
+        ZONE_CONTAINER* zone = m_ZoneDescriptorList[i];
+
+        if( zone->IsDirty() && zone->IsFilled() && !zone->GetIsKeepout() )
+            aZones.push_back( zone );
+    }
+}
+
+
+void BOARD::ClearZonesDirty()
+{
+    m_editedItems.clear();
+
+    for( unsigned i = 0; i < m_ZoneDescriptorList.size(); ++i )
+        m_ZoneDescriptorList[i]->ClearDirty();
+}
+
+
 void BOARD::DeleteMARKERs()
 {
     // the vector does not know how to delete the MARKER_PCB, it holds pointers
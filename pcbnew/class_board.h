@@ -31,6 +31,8 @@
 #define CLASS_BOARD_H_
 
 
+#include <set>
+
 #include <dlist.h>
 
 #include <common.h>                         // PAGE_INFO
@@ -42,6 +44,7 @@
 #include <class_title_block.h>
 #include <class_zone_settings.h>
 #include <pcb_plot_params.h>
+#include <board_listener.h>
 
 
 class PCB_BASE_FRAME;
@@ -57,6 +60,7 @@ class MSG_PANEL_ITEM;
 class NETLIST;
 class REPORTER;
 class RN_DATA;
+class CONNECTIVITY_DATA;
 class SHAPE_POLY_SET;
 
 // non-owning container of item candidates when searching for items on the same track.
@@ -191,6 +195,7 @@ private:
     EDA_RECT                m_BoundingBox;
     NETINFO_LIST            m_NetInfo;              ///< net info list (name, design constraints ..
     RN_DATA*                m_ratsnest;
+    CONNECTIVITY_DATA*      m_connectivity;
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     ZONE_SETTINGS           m_zoneSettings;
@@ -205,6 +210,20 @@ private:
     /// Number of unconnected nets in the current rats nest.
     int                     m_unconnectedNetCount;
 
+    /// Items being edited, whose new place must be marked dirty in the zones (not owned).
+    /// Items are recorded once and forgotten when removed from the board.
+    std::set<BOARD_ITEM*>   m_editedItems;
+
+    /// Objects notified of the board changes (not owned).
+    std::vector<BOARD_LISTENER*> m_listeners;
+
+    /**
+     * Function markEditedItemsZonesDirty
+     * marks the zones touched by the current place of the edited items (the ones which
+     * are still on the board) as dirty, and clears the list of edited items.
+     */
+    void markEditedItemsZonesDirty();
+
     /**
      * Function chainMarkedSegments
      * is used by MarkTrace() to set the BUSY flag of connected segments of the trace
@@ -314,6 +333,44 @@ public:
         return m_ratsnest;
     }
 
+    /**
+     * Function GetConnectivity()
+     * returns the clusters of items connected together, used by the ratsnest connection
+     * queries and the zone subnets.
+     * @return CONNECTIVITY_DATA* is the object maintaining the clusters of connected items.
+     */
+    CONNECTIVITY_DATA* GetConnectivity() const
+    {
+        return m_connectivity;
+    }
+
+    /**
+     * Function AddListener
+     * registers an object to be notified of the changes of the board items.
+     * @param aListener is the listener, which is not owned by the board.
+     */
+    void AddListener( BOARD_LISTENER* aListener );
+
+    /**
+     * Function RemoveListener
+     * unregisters an object added with AddListener().
+     */
+    void RemoveListener( BOARD_LISTENER* aListener );
+
+    /**
+     * Function NotifyItemChanged
+     * tells the listeners that aItem is about to be modified.
+     * @param aItem is the item which will be modified.
+     */
+    void NotifyItemChanged( BOARD_ITEM* aItem );
+
+    /**
+     * Function NotifyBoardChanged
+     * tells the listeners that any item may have been modified without notice, so
+     * everything built from the board items has to be rebuilt.
+     */
+    void NotifyBoardChanged() const;
+
     /**
      * Function DeleteMARKERs
      * deletes ALL MARKERS from the board.
@@ -1082,6 +1139,52 @@ public:
         return (int) m_ZoneDescriptorList.size();
     }
 
+    /**
+     * Function MarkZonesDirty
+     * marks the zones which can be affected by a change of the board items inside aArea,
+     * on one of the layers of aLayers, as dirty (see ZONE_CONTAINER::MarkDirty()).
+     * @param aArea = the bounding box of the changed items.
+     * @param aLayers = the layers of the changed items.
+     * @param aSkip = a zone which must not be marked, or NULL.
+     */
+    void MarkZonesDirty( const EDA_RECT& aArea, LSET aLayers,
+                         const ZONE_CONTAINER* aSkip = NULL );
+
+    /**
+     * Function MarkZonesDirty
+     * marks the zones which can be affected by aItem, at its current place, as dirty.
+     * Used when aItem is added to or removed from the board. If aItem is a zone, it is
+     * not marked itself, because its filling does not depend on its presence.
+     * @param aItem = the added or removed item.
+     * @param aOffset = an offset applied to the place of aItem, for instance to mark
+     *                  the place it had before a move.
+     */
+    void MarkZonesDirty( BOARD_ITEM* aItem, const wxPoint& aOffset = wxPoint( 0, 0 ) );
+
+    /**
+     * Function MarkZonesDirtyOnEdit
+     * marks the zones which can be affected by aItem, at its current place, as dirty,
+     * and remembers aItem so that the zones at its place after the edit are marked too,
+     * when the dirty zones are requested. If aItem is a zone, it is marked itself.
+     * Used when aItem is about to be modified.
+     */
+    void MarkZonesDirtyOnEdit( BOARD_ITEM* aItem );
+
+    /**
+     * Function GetDirtyZones
+     * collects the filled zones which are dirty, i.e. which must be refilled because
+     * board items touching them have changed since they were filled.
+     * @param aZones = the list to fill.
+     */
+    void GetDirtyZones( std::vector<ZONE_CONTAINER*>& aZones );
+
+    /**
+     * Function ClearZonesDirty
+     * marks all the zones as up to date, for instance after a board is loaded or all
+     * the zones are refilled.
+     */
+    void ClearZonesDirty();
+
     /* Functions used in test, merge and cut outlines */
 
     /**
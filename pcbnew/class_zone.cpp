@@ -55,6 +55,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
 {
     m_CornerSelection = -1;
     m_IsFilled = false;                         // fill status : true when the zone is filled
+    m_isDirty = false;                          // true when the filling may be outdated
     m_FillMode = 0;                             // How to fill areas: 0 = use filled polygons, != 0 fill with segments
     m_priority = 0;
     m_smoothedPoly = NULL;
@@ -82,6 +83,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     // For corner moving, corner index to drag, or -1 if no selection
     m_CornerSelection = -1;
     m_IsFilled = aZone.m_IsFilled;
+    m_isDirty = false;
     m_ZoneClearance = aZone.m_ZoneClearance;     // clearance value
     m_ZoneMinThickness = aZone.m_ZoneMinThickness;
     m_FillMode = aZone.m_FillMode;               // Filling mode (segments/polygons)
@@ -109,6 +111,7 @@ ZONE_CONTAINER::~ZONE_CONTAINER()
 {
     delete m_Poly;
     m_Poly = NULL;
+    delete m_smoothedPoly;
 }
 
 
@@ -118,6 +121,34 @@ EDA_ITEM* ZONE_CONTAINER::Clone() const
 }
 
 
+void ZONE_CONTAINER::TakeFilledAreas( ZONE_CONTAINER& aZone )
+{
+    m_FilledPolysList = aZone.m_FilledPolysList;
+    aZone.m_FilledPolysList.RemoveAllContours();
+
+    m_FillSegmList.clear();
+    m_FillSegmList.swap( aZone.m_FillSegmList );
+
+    m_IsFilled = aZone.m_IsFilled;
+    aZone.m_IsFilled = false;
+
+    std::swap( m_smoothedPoly, aZone.m_smoothedPoly );
+
+    ClearDirty();
+}
+
+
+void ZONE_CONTAINER::MarkDirty( const EDA_RECT& aArea )
+{
+    if( m_isDirty )
+        m_dirtyArea.Merge( aArea );
+    else
+        m_dirtyArea = aArea;
+
+    m_isDirty = true;
+}
+
+
 bool ZONE_CONTAINER::UnFill()
 {
     bool change = ( !m_FilledPolysList.IsEmpty() ) ||
@@ -193,6 +193,28 @@ public:
     bool IsFilled() const { return m_IsFilled; }
     void SetIsFilled( bool isFilled ) { m_IsFilled = isFilled; }
 
+    /**
+     * Function MarkDirty
+     * records that board items inside aArea have changed since the zone was filled,
+     * so the filling may be outdated.
+     * @param aArea = the bounding box of the changed items.
+     */
+    void MarkDirty( const EDA_RECT& aArea );
+
+    /**
+     * Function IsDirty
+     * @return true if board items touching the zone have changed since it was filled.
+     */
+    bool IsDirty() const { return m_isDirty; }
+
+    /**
+     * Function GetDirtyArea
+     * @return the union of the areas given to MarkDirty() since the zone was filled.
+     */
+    const EDA_RECT& GetDirtyArea() const { return m_dirtyArea; }
+
+    void ClearDirty() { m_isDirty = false; m_dirtyArea = EDA_RECT(); }
+
     int GetZoneClearance() const { return m_ZoneClearance; }
     void SetZoneClearance( int aZoneClearance ) { m_ZoneClearance = aZoneClearance; }
 
@@ -278,6 +300,8 @@ public:
      * if not null:
      * Only the zone outline (with holes, if any) is stored in aOutlineBuffer
      * with holes linked. Therefore only one polygon is created
+     * and the zone itself is not modified, so other zones can use its outline
+     * while they are filled concurrently.
      *
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
@@ -521,6 +545,16 @@ public:
         m_FillSegmList.insert( m_FillSegmList.end(), aSegments.begin(), aSegments.end() );
     }
 
+    /**
+     * Function TakeFilledAreas
+     * replaces the filling of this zone (filled polygons, fill segments, fill state
+     * and corner-smoothed outline) by the filling of aZone, which is left unfilled.
+     * Used to commit a filling computed on a working copy of this zone, so this zone
+     * is no longer dirty.
+     * @param aZone = the zone to take the filling from.
+     */
+    void TakeFilledAreas( ZONE_CONTAINER& aZone );
+
     virtual wxString GetSelectMenuText() const;
 
     virtual BITMAP_DEF GetMenuImage() const { return  add_zone_xpm; }
@@ -549,6 +583,13 @@ public:
 private:
     void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures );
 
+    /**
+     * Function buildSmoothedPoly
+     * @return a new corner-smoothed version of m_Poly, according to the corner
+     * smoothing settings. The caller owns the returned polygon.
+     */
+    CPolyLine* buildSmoothedPoly() const;
+
     CPolyLine*            m_Poly;                ///< Outline of the zone.
     CPolyLine*            m_smoothedPoly;        // Corner-smoothed version of m_Poly
     int                   m_cornerSmoothingType;
@@ -583,6 +624,12 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /// True when board items touching the zone have changed since it was filled.
+    bool                  m_isDirty;
+
+    /// Union of the bounding boxes of the items changed since the zone was filled.
+    EDA_RECT              m_dirtyArea;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
@@ -37,12 +37,11 @@
 
 // Helper classes to handle connection points
 #include <connect.h>
-
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb );
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode );
+#include <connectivity.h>
 
 // Local functions
 static void RebuildTrackChain( BOARD* pcb );
+static void setSubNetsFromClusters( BOARD* aPcb, int aNetcode );
 
 
 CONNECTIONS::CONNECTIONS( BOARD * aBrd )
@@ -64,45 +63,6 @@ void CONNECTIONS::BuildPadsList( int aNetcode )
     m_brd->GetSortedPadListByXthenYCoord( m_sortedPads, aNetcode < 0 ? -1 : aNetcode );
 }
 
-/* Explores the list of pads and adds to m_PadsConnected member
- * of each pad pads connected to
- * Here, connections are due to intersecting pads, not tracks
- */
-void CONNECTIONS::SearchConnectionsPadsToIntersectingPads()
-{
-    std::vector<CONNECTED_POINT*> candidates;
-
-    BuildPadsCandidatesList();
-
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD* pad = m_sortedPads[ii];
-
-        pad->m_PadsConnected.clear();
-        candidates.clear();
-
-        CollectItemsNearTo( candidates, pad->ShapePos(), pad->GetBoundingRadius() );
-
-        // add pads to pad.m_PadsConnected, if they are connected
-        for( unsigned jj = 0; jj < candidates.size(); jj++ )
-        {
-            CONNECTED_POINT* item = candidates[jj];
-
-            D_PAD* candidate_pad = item->GetPad();
-
-            if( pad == candidate_pad )
-                continue;
-
-            if( !( pad->GetLayerSet() & candidate_pad->GetLayerSet() ).any() )
-                continue;
-            if( pad->HitTest( item->GetPoint() ) )
-            {
-                pad->m_PadsConnected.push_back( candidate_pad );
-            }
-        }
-    }
-}
-
 /* Explores the list of pads
  * Adds to m_PadsConnected member of each track the pad(s) connected to
  * Adds to m_TracksConnected member of each pad the track(s) connected to
@@ -141,99 +101,63 @@ void CONNECTIONS::SearchTracksConnectedToPads( bool add_to_padlist, bool add_to_
     }
 }
 
+/// Visitor for RTree::Search(), gathers the indices of the candidates found.
+struct CANDIDATE_COLLECTOR
+{
+    CANDIDATE_COLLECTOR( std::vector<int>& aIndices ) :
+        m_indices( aIndices )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_indices.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_indices;
+};
+
+
 void CONNECTIONS::CollectItemsNearTo( std::vector<CONNECTED_POINT*>& aList,
                                        const wxPoint& aPosition, int aDistMax )
 {
     /* Search items in m_Candidates that position is <= aDistMax from aPosition
      * (Rectilinear distance)
-     * m_Candidates is sorted by X then Y values, so a fast binary search is used
-     * to locate the "best" entry point in list
-     * The best entry is a pad having its m_Pos.x == (or near) aPosition.x
-     * All candidates are near this candidate in list
-     * So from this entry point, a linear search is made to find all candidates
+     * The spatial index returns only the candidates inside the search box, so the cost
+     * does not depend on the number of candidates having a X coordinate near aPosition.x
+     * (e.g. tracks ends or pads aligned on a vertical line)
      */
-    int idxmax = m_candidates.size()-1;
-
-    int delta = m_candidates.size();
-
-    int idx = 0;        // Starting index is the beginning of list
-    while( delta )
-    {
-        // Calculate half size of remaining interval to test.
-        // Ensure the computed value is not truncated (too small)
-        if( (delta & 1) && ( delta > 1 ) )
-            delta++;
-        delta /= 2;
+    const int mmin[2] = { aPosition.x - aDistMax, aPosition.y - aDistMax };
+    const int mmax[2] = { aPosition.x + aDistMax, aPosition.y + aDistMax };
 
-        CONNECTED_POINT& item = m_candidates[idx];
+    m_nearCandidates.clear();
 
-        int dist = item.GetPoint().x - aPosition.x;
-        if( abs(dist) <= aDistMax )
-        {
-            break;   // A good entry point is found. The list can be scanned from this point.
-        }
+    CANDIDATE_COLLECTOR collector( m_nearCandidates );
+    m_candidatesIndex.Search( mmin, mmax, collector );
 
-        else if( item.GetPoint().x < aPosition.x ) // We should search after this item
-        {
-            idx += delta;
-            if( idx > idxmax )
-                idx = idxmax;
-        }
-        else    // We should search before this item
-        {
-            idx -= delta;
-            if( idx < 0 )
-                idx = 0;
-        }
-    }
+    // Keep the candidates order, so the results do not depend on the index layout
+    std::sort( m_nearCandidates.begin(), m_nearCandidates.end() );
 
-    /* Now explore the candidate list from the "best" entry point found
-     * (candidate "near" aPosition.x)
-     * We explore the list until abs(candidate->m_Point.x - aPosition.x) > aDistMax
-     * because the list is sorted by X position (and for a given X pos, by Y pos)
-     * Currently a linear search is made because the number of candidates
-     * having the right X position is usually small
-     */
-    // search next candidates in list
-    wxPoint diff;
-    for( int ii = idx; ii <= idxmax; ii++ )
-    {
-        CONNECTED_POINT* item = &m_candidates[ii];
-        diff = item->GetPoint() - aPosition;
-        if( abs(diff.x) > aDistMax )
-            break;    // Exit: the distance is to long, we cannot find other candidates
-        if( abs(diff.y) > aDistMax )
-            continue;    // the y distance is to long, but we can find other candidates
-        // We have here a good candidate: add it
-        aList.push_back( item );
-    }
-    // search previous candidates in list
-    for(  int ii = idx-1; ii >=0; ii-- )
-    {
-        CONNECTED_POINT * item = &m_candidates[ii];
-        diff = item->GetPoint() - aPosition;
-        if( abs(diff.x) > aDistMax )
-            break;
-        if( abs(diff.y) > aDistMax )
-            continue;
-        // We have here a good candidate:add it
-        aList.push_back( item );
-    }
+    for( unsigned ii = 0; ii < m_nearCandidates.size(); ii++ )
+        aList.push_back( &m_candidates[m_nearCandidates[ii]] );
 }
 
 
-void CONNECTIONS::BuildPadsCandidatesList()
+void CONNECTIONS::buildCandidatesIndex()
 {
-    m_candidates.clear();
-    m_candidates.reserve( m_sortedPads.size() );
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
+    m_candidatesIndex.RemoveAll();
+
+    for( unsigned ii = 0; ii < m_candidates.size(); ii++ )
     {
-        D_PAD * pad = m_sortedPads[ii];
-        CONNECTED_POINT candidate( pad, pad->GetPosition() );
-        m_candidates.push_back( candidate );
+        const wxPoint& point = m_candidates[ii].GetPoint();
+        const int mmin[2] = { point.x, point.y };
+
+        m_candidatesIndex.Insert( mmin, mmin, (int) ii );
     }
 }
 
+
 /* sort function used to sort .m_Connected by X the Y values
  * items are sorted by X coordinate value,
  * and for same X value, by Y coordinate value.
@@ -288,6 +212,8 @@ void CONNECTIONS::BuildTracksCandidatesList( TRACK* aBegin, TRACK* aEnd)
     // and for increasing Y coordinate when items have the same X coordinate
     // So candidates to the same location are consecutive in list.
     sort( m_candidates.begin(), m_candidates.end(), sortConnectedPointByXthenYCoordinates );
+
+    buildCandidatesIndex();
 }
 
 
@@ -449,278 +375,45 @@ int CONNECTIONS::searchEntryPointInCandidatesList( const wxPoint& aPoint )
     return -1;
 }
 
-/* Used after a track change (delete a track ou add a track)
- * Connections to pads are recalculated
- * Note also aFirstTrack (and aLastTrack ) can be NULL
- */
-void CONNECTIONS::Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK* aLastTrack, int aNetcode )
-{
-    m_firstTrack = aFirstTrack;     // The first track used to build m_Candidates
-    m_lastTrack = aLastTrack;       // The last track used to build m_Candidates
-
-    // Pads subnets are expected already cleared, because this function
-    // does not know the full list of pads
-    BuildTracksCandidatesList( aFirstTrack, aLastTrack );
-    TRACK* curr_track;
-    for( curr_track = aFirstTrack; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        // Clear track subnet id (Pads subnets are cleared outside this function)
-        curr_track->SetSubNet( 0 );
-        curr_track->m_TracksConnected.clear();
-        curr_track->m_PadsConnected.clear();
-
-        // Update connections between tracks:
-        SearchConnectedTracks( curr_track );
-        curr_track->m_TracksConnected = m_connected;
-
-        if( curr_track == aLastTrack )
-            break;
-    }
-
-    // Update connections between tracks and pads
-    BuildPadsList( aNetcode );
-    SearchTracksConnectedToPads();
-
-    // Update connections between intersecting pads (no tracks)
-    SearchConnectionsPadsToIntersectingPads();
-
-    // Creates sub nets (clusters) for the current net:
-    Propagate_SubNets();
-}
-
-
-/**
- * Change a subnet value to a new value, in m_sortedPads pad list
- * After that, 2 cluster (or subnets) are merged into only one.
- * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_PadsSubNets( int aOldSubNet, int aNewSubNet )
-{
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
-
-    // Examine connections between intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD * curr_pad = m_sortedPads[ii];
-        if( curr_pad->GetSubNet() != aOldSubNet )
-            continue;
-
-        change_count++;
-        curr_pad->SetSubNet( aNewSubNet );
-    }
-
-    return change_count;
-}
-
-/*
- * Change a subnet value to a new value, for tracks and pads which are connected to.
- * The result is merging 2 clusters (or subnets) into only one cluster.
- * Note: the resulting sub net value is the smallest between aOldSubNet et aNewSubNet
+/* Set the subnet of pads and tracks to their cluster in the board connectivity.
+ * Items which are not connected to any other item (or filled area) have no subnet (0).
+ * aNetcode = netcode to update, or -1 for all nets
  */
-int CONNECTIONS::Merge_SubNets( int aOldSubNet, int aNewSubNet )
+static void setSubNetsFromClusters( BOARD* aPcb, int aNetcode )
 {
-    TRACK* curr_track;
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
-
-    curr_track = (TRACK*)m_firstTrack;
+    CONNECTIVITY_DATA* connectivity = aPcb->GetConnectivity();
 
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
+    for( unsigned ii = 0; ii < aPcb->GetPadCount(); ++ii )
     {
-        if( curr_track->GetSubNet() != aOldSubNet )
-        {
-            if( curr_track == m_lastTrack )
-                break;
+        D_PAD* pad = aPcb->GetPad( ii );
 
+        if( aNetcode >= 0 && pad->GetNetCode() != aNetcode )
             continue;
-        }
 
-        change_count++;
-        curr_track->SetSubNet( aNewSubNet );
-
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-            if( pad->GetSubNet() == aOldSubNet )
-            {
-                pad->SetSubNet( curr_track->GetSubNet() );
-            }
-        }
-
-        if( curr_track == m_lastTrack )
-            break;
+        if( connectivity->GetClusterSize( pad ) < 2 )
+            pad->SetSubNet( 0 );
+        else
+            pad->SetSubNet( connectivity->GetClusterCode( pad ) );
     }
 
-    return change_count;
-}
-
+    TRACK* track = aPcb->m_Track;
 
-/* Test a list of track segments, to create or propagate a sub netcode to pads and
- * segments connected together.
- * The track list must be sorted by nets, and all segments
- * from m_firstTrack to m_lastTrack have the same net
- * When 2 items are connected (a track to a pad, or a track to an other track),
- * they are grouped in a cluster.
- * The .m_Subnet member is the cluster identifier (subnet id)
- * For a given net, if all tracks are created, there is only one cluster.
- * but if not all tracks are created, there are more than one cluster,
- * and some ratsnests will be left active.
- * A ratsnest is active when it "connect" 2 items having different subnet id
- */
-void CONNECTIONS::Propagate_SubNets()
-{
-    int sub_netcode = 1;
+    if( aNetcode >= 0 && track )
+        track = track->GetStartNetCode( aNetcode );
 
-    TRACK* curr_track = (TRACK*)m_firstTrack;
-    if( curr_track )
-        curr_track->SetSubNet( sub_netcode );
-
-    // Examine connections between tracks and pads
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
+    for( ; track; track = track->Next() )
     {
-        // First: handling connections to pads
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-
-            if( curr_track->GetSubNet() )        // the track segment is already a cluster member
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    Merge_SubNets( pad->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    /* The pad is not yet attached to a cluster , so we can add this pad to
-                     * the cluster */
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else                              // the track segment is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // it is connected to a pad in a cluster, merge this track
-                    curr_track->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    /* it is connected to a pad not in a cluster, so we must create a new
-                     * cluster (only with the 2 items: the track and the pad) */
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-        }
-
-        // Test connections between segments
-        for( unsigned ii = 0; ii < curr_track->m_TracksConnected.size(); ii++ )
-        {
-            BOARD_CONNECTED_ITEM* track = curr_track->m_TracksConnected[ii];
-
-            if( curr_track->GetSubNet() )   // The current track is already a cluster member
-            {
-                // The other track is already a cluster member, so we can merge the 2 clusters
-                if( track->GetSubNet() )
-                {
-                    Merge_SubNets( track->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    // The other track is not yet attached to a cluster , so we can add this
-                    // other track to the cluster
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else        // the current track segment is not yet attached to a cluster
-            {
-                if( track->GetSubNet() )
-                {
-                    // The other track is already a cluster member, so we can add
-                    // the current segment to the cluster
-                    curr_track->SetSubNet( track->GetSubNet() );
-                }
-                else
-                {
-                    // it is connected to an other segment not in a cluster, so we must
-                    // create a new cluster (only with the 2 track segments)
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-        }
-
-        if( curr_track == m_lastTrack )
+        if( aNetcode >= 0 && track->GetNetCode() != aNetcode )
             break;
-    }
-
-    // Examine connections between intersecting pads, and propagate
-    // sub_netcodes to intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD* curr_pad = m_sortedPads[ii];
 
-        for( unsigned jj = 0; jj < curr_pad->m_PadsConnected.size(); jj++ )
-        {
-            D_PAD* pad = curr_pad->m_PadsConnected[jj];
-
-            if( curr_pad->GetSubNet() )   // the current pad is already attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    // Store the initial subnets, which will be modified by Merge_PadsSubNets
-                    int subnet1 = pad->GetSubNet();
-                    int subnet2 = curr_pad->GetSubNet();
-
-                    // merge subnets of pads only, even those not connected by tracks
-                    Merge_PadsSubNets( subnet1, subnet2 );
-
-                    // merge subnets of tracks (and pads, which are already merged)
-                    Merge_SubNets( subnet1, subnet2 );
-                }
-                else
-                {
-                    // The pad is not yet attached to a cluster,
-                    // so we can add this pad to the cluster
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-            else   // the current pad is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // the connected pad is in a cluster,
-                    // so we can add the current pad to the cluster
-                    curr_pad->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    // the connected pad is not in a cluster,
-                    // so we must create a new cluster, with the 2 pads.
-                    sub_netcode++;
-                    curr_pad->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-        }
+        if( connectivity->GetClusterSize( track ) < 2 )
+            track->SetSubNet( 0 );
+        else
+            track->SetSubNet( connectivity->GetClusterCode( track ) );
     }
 }
 
+
 /*
  * Test all connections of the board,
  * and update subnet variable of pads and tracks
@@ -729,54 +422,13 @@ void CONNECTIONS::Propagate_SubNets()
  */
 void PCB_BASE_FRAME::TestConnections()
 {
-    // Clear the cluster identifier for all pads
-    for( unsigned i = 0;  i< m_Pcb->GetPadCount();  ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        pad->SetZoneSubNet( 0 );
-        pad->SetSubNet( 0 );
-    }
-
+    // Legacy tools modify items without notifying the connectivity, so all nets are
+    // rebuilt here (and the zone subnets are updated)
     m_Pcb->Test_Connections_To_Copper_Areas();
 
-    // Test existing connections net by net
-    // note some nets can have no tracks, and pads intersecting
-    // so Build_CurrNet_SubNets_Connections must be called for each net
-    CONNECTIONS connections( m_Pcb );
-
-    int last_net_tested = 0;
-    int current_net_code = 0;
-
-    for( TRACK* track = m_Pcb->m_Track; track; )
-    {
-        // At this point, track is the first track of a given net
-        current_net_code = track->GetNetCode();
-
-        // Get last track of the current net
-        TRACK* lastTrack = track->GetEndNetCode( current_net_code );
-
-        if( current_net_code > 0 )  // do not spend time if net code = 0 ( dummy net )
-        {
-            // Test all previous nets having no tracks
-            for( int net = last_net_tested+1; net < current_net_code; net++ )
-                connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-            connections.Build_CurrNet_SubNets_Connections( track, lastTrack, current_net_code );
-            last_net_tested = current_net_code;
-        }
-
-        track = lastTrack->Next();    // this is now the first track of the next net
-    }
-
-    // Test last nets without tracks, if any
-    int netsCount = m_Pcb->GetNetCount();
-    for( int net = last_net_tested+1; net < netsCount; net++ )
-        connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb );
-
-    return;
+    // The subnets (clusters of pads and tracks connected by tracks, intersecting pads
+    // or filled areas) are the connectivity clusters
+    setSubNetsFromClusters( m_Pcb, -1 );
 }
 
 
@@ -789,36 +441,8 @@ void PCB_BASE_FRAME::TestNetConnection( wxDC* aDC, int aNetCode )
     if( (m_Pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
         Compile_Ratsnest( aDC, true );
 
-    // Clear the cluster identifier (subnet) of pads for this net
-    // Pads are grouped by netcode (and in netname alphabetic order)
-    for( unsigned i = 0; i < m_Pcb->GetPadCount(); ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        if( m_Pcb->GetPad(i)->GetNetCode() == aNetCode )
-            pad->SetSubNet( 0 );
-    }
-
     m_Pcb->Test_Connections_To_Copper_Areas( aNetCode );
-
-    // Search for the first and the last segment relative to the given net code
-    if( m_Pcb->m_Track )
-    {
-        CONNECTIONS connections( m_Pcb );
-
-        TRACK* lastTrack = NULL;
-        TRACK* firstTrack = m_Pcb->m_Track.GetFirst()->GetStartNetCode( aNetCode );
-
-        if( firstTrack )
-            lastTrack = firstTrack->GetEndNetCode( aNetCode );
-
-        if( firstTrack && lastTrack ) // i.e. if there are segments
-        {
-            connections.Build_CurrNet_SubNets_Connections( firstTrack, lastTrack, aNetCode );
-        }
-    }
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb, aNetCode );
+    setSubNetsFromClusters( m_Pcb, aNetCode );
 
     // rebuild the active ratsnest for this net
     DrawGeneralRatsnest( aDC, aNetCode );
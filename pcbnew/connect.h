@@ -32,6 +32,7 @@
 
 #include <class_track.h>
 #include <class_board.h>
+#include <geometry/rtree.h>
 
 
 // Helper classes to handle connection points (i.e. candidates) for tracks
@@ -99,6 +100,8 @@ private:
     const TRACK * m_firstTrack;                 // The first track used to build m_Candidates
     const TRACK * m_lastTrack;                  // The last track used to build m_Candidates
     std::vector<D_PAD*> m_sortedPads;           // list of sorted pads by X (then Y) coordinate
+    RTree<int, int, 2> m_candidatesIndex;       // spatial index of m_candidates (item indices)
+    std::vector<int> m_nearCandidates;          // candidates found by CollectItemsNearTo
 
 public:
     CONNECTIONS( BOARD * aBrd );
@@ -119,22 +122,6 @@ public:
      */
     std::vector<D_PAD*>& GetPadsList() { return m_sortedPads; }
 
-    /**
-     * Function Build_CurrNet_SubNets_Connections
-     * should be called after a track change (delete or add a track):
-     * Connections to pads and to tracks are recalculated
-     *   If a track is deleted, the other pointers to pads do not change.
-     *   When a new track is added in track list, its pointers to pads are already initialized
-     * Builds the subnets inside a net (tracks from aFirstTrack to aFirstTrack).
-     * subnets are clusters of pads and tracks that are connected together.
-     * When all tracks are created relative to the net, there is only a cluster
-     * when not tracks there are a cluster per pad
-     * @param aFirstTrack = first track of the given net
-     * @param aLastTrack = last track of the given net
-     * @param aNetcode = the netcode of the given net
-     */
-    void Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK* aLastTrack, int aNetcode );
-
     /**
      * Function BuildTracksCandidatesList
      * Fills m_Candidates with all connecting points (track ends or via location)
@@ -145,13 +132,6 @@ public:
      */
     void BuildTracksCandidatesList( TRACK * aBegin, TRACK * aEnd = NULL);
 
-    /**
-     * Function BuildPadsCandidatesList
-     * Populates m_candidates with all pads connecting points (pads position)
-     * m_sortedPads is expected to be populated by the pad candidates list
-     */
-    void BuildPadsCandidatesList();
-
     /**
      * function SearchConnectedTracks
      * Populates .m_connected with tracks/vias connected to aTrack
@@ -172,15 +152,6 @@ public:
         aTrack->m_TracksConnected = m_connected;
     }
 
-    /**
-     * function SearchConnectionsPadsToIntersectingPads
-     * Explores the list of pads and adds to m_PadsConnected member
-     * of each pad pads connected to
-     * Here, connections are due to intersecting pads, not tracks
-     * m_sortedPads must be initialized
-     */
-    void SearchConnectionsPadsToIntersectingPads();
-
     /**
      * function SearchTracksConnectedToPads
      * Explores the list of pads.
@@ -198,8 +169,10 @@ public:
     /**
      * function CollectItemsNearTo
      * Used by SearchTracksConnectedToPads
-     * Fills aList with pads near to aPosition
-     * near means aPosition to pad position <= aDistMax
+     * Fills aList with candidates near to aPosition, found using the spatial index
+     * of the candidates.
+     * near means aPosition to candidate position <= aDistMax (on both X and Y axis)
+     * Candidates are added in the m_candidates order (i.e. sorted by X then Y)
      * @param aList = list to fill
      * @param aPosition = aPosition to use as reference
      * @param aDistMax = dist max from aPosition to a candidate to select it
@@ -207,22 +180,6 @@ public:
     void CollectItemsNearTo( std::vector<CONNECTED_POINT*>& aList,
                             const wxPoint& aPosition, int aDistMax );
 
-    /**
-     * Function Propagate_SubNets
-     * Test a list of tracks, to create or propagate a sub netcode to pads and
-     * segments connected together.
-     * The track list must be sorted by nets, and all segments
-     * from m_firstTrack to m_lastTrack have the same net.
-     * When 2 items are connected (a track to a pad, or a track to an other track),
-     * they are grouped in a cluster.
-     * For pads, this is the .m_physical_connexion member which is a cluster identifier
-     * For tracks, this is the .m_Subnet member which is a cluster identifier
-     * For a given net, if all tracks are created, there is only one cluster.
-     * but if not all tracks are created, there are more than one cluster,
-     * and some ratsnests will be left active.
-     */
-    void Propagate_SubNets();
-
 private:
     /**
      * function searchEntryPointInCandidatesList
@@ -236,28 +193,10 @@ private:
     int searchEntryPointInCandidatesList( const wxPoint & aPoint);
 
     /**
-     * Function Merge_SubNets
-     * Change a subnet old value to a new value, for tracks and pads which are connected to
-     * tracks from m_firstTrack to m_lastTrack and their connected pads.
-     * and modify the subnet parameter (change the old value to the new value).
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting sub net value is the smallest between aOldSubNet and aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
-     */
-    int Merge_SubNets( int aOldSubNet, int aNewSubNet );
-
-    /**
-     * Function Merge_PadsSubNets
-     * Change a subnet value to a new value, in m_sortedPads pad list
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
+     * function buildCandidatesIndex
+     * Builds the spatial index of m_candidates, used by CollectItemsNearTo
      */
-    int Merge_PadsSubNets( int aOldSubNet, int aNewSubNet );
+    void buildCandidatesIndex();
 };
 
 #endif      //  ifndef CONNECT_H
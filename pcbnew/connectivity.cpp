@@ -0,0 +1,574 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity.cpp
+ */
+
+#include <connectivity.h>
+#include <ratsnest_data.h>          // RN_ITEM_TYPE
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+
+#include <geometry/shape_poly_set.h>
+#include <trigo.h>
+
+#include <cassert>
+#include <algorithm>
+
+
+/// Visitor for RTree::Search(), gathers the indices of the nodes found.
+struct CN_NODE_COLLECTOR
+{
+    CN_NODE_COLLECTOR( std::vector<int>& aNodes ) :
+        m_nodes( aNodes )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_nodes.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_nodes;
+};
+
+
+/// Returns true if aItem is handled by the connectivity (pads, tracks, vias and zones).
+static bool isConnectivityItem( const BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        return true;
+
+    case PCB_ZONE_AREA_T:
+        return static_cast<const ZONE_CONTAINER*>( aItem )->IsOnCopperLayer();
+
+    default:
+        return false;
+    }
+}
+
+
+/// Returns the RN_ITEM_TYPE flag of an item.
+static int itemTypeFlag( const BOARD_CONNECTED_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:         return RN_PADS;
+    case PCB_VIA_T:         return RN_VIAS;
+    case PCB_TRACE_T:       return RN_TRACKS;
+    case PCB_ZONE_AREA_T:   return RN_ZONES;
+    default:                return 0;
+    }
+}
+
+
+/// Collects the points of aItem which connect it to other items.
+static void getAnchors( const BOARD_CONNECTED_ITEM* aItem, std::vector<wxPoint>& aAnchors )
+{
+    aAnchors.clear();
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+        // Zones are connected to the center of the pad shape, not to the pad position
+        aAnchors.push_back( static_cast<const D_PAD*>( aItem )->ShapePos() );
+        break;
+
+    case PCB_VIA_T:
+        aAnchors.push_back( static_cast<const VIA*>( aItem )->GetStart() );
+        break;
+
+    case PCB_TRACE_T:
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        aAnchors.push_back( track->GetStart() );
+
+        if( track->GetEnd() != track->GetStart() )
+            aAnchors.push_back( track->GetEnd() );
+    }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/**
+ * Function isAnchoredTo
+ * checks if one of the anchors of aItem touches aTarget (the outline aOutline for zones).
+ */
+static bool isAnchoredTo( const std::vector<wxPoint>& aAnchors, const BOARD_CONNECTED_ITEM* aItem,
+                          const BOARD_CONNECTED_ITEM* aTarget, int aOutline )
+{
+    switch( aTarget->Type() )
+    {
+    case PCB_PAD_T:
+        {
+            const D_PAD* pad = static_cast<const D_PAD*>( aTarget );
+
+            for( unsigned i = 0; i < aAnchors.size(); ++i )
+            {
+                if( pad->HitTest( aAnchors[i] ) )
+                    return true;
+            }
+        }
+        break;
+
+    case PCB_ZONE_AREA_T:
+        {
+            const SHAPE_POLY_SET& polys =
+                    static_cast<const ZONE_CONTAINER*>( aTarget )->GetFilledPolysList();
+
+            for( unsigned i = 0; i < aAnchors.size(); ++i )
+            {
+                if( polys.Contains( VECTOR2I( aAnchors[i].x, aAnchors[i].y ), aOutline ) )
+                    return true;
+            }
+        }
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        {
+            // Track ends are connected when they are closer than the half width
+            // of one of the segments (as in CONNECTIONS::SearchConnectedTracks())
+            if( aItem->Type() != PCB_TRACE_T && aItem->Type() != PCB_VIA_T )
+                break;
+
+            std::vector<wxPoint> targetAnchors;
+            getAnchors( aTarget, targetAnchors );
+
+            double maxDist = std::max( static_cast<const TRACK*>( aItem )->GetWidth(),
+                                       static_cast<const TRACK*>( aTarget )->GetWidth() ) / 2;
+
+            for( unsigned i = 0; i < aAnchors.size(); ++i )
+            {
+                for( unsigned j = 0; j < targetAnchors.size(); ++j )
+                {
+                    if( EuclideanNorm( aAnchors[i] - targetAnchors[j] ) <= maxDist )
+                        return true;
+                }
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+
+CONNECTIVITY_DATA::CONNECTIVITY_DATA( const BOARD* aBoard ) :
+    m_board( aBoard ), m_hasDirtyNets( false )
+{
+}
+
+
+void CONNECTIVITY_DATA::Add( const BOARD_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->Pads().GetFirst(); pad; pad = pad->Next() )
+            Add( pad );
+
+        return;
+    }
+
+    if( !isConnectivityItem( aItem ) )
+        return;
+
+    const BOARD_CONNECTED_ITEM* item = static_cast<const BOARD_CONNECTED_ITEM*>( aItem );
+
+    if( m_items.count( item ) )
+        removeItem( item );
+
+    addItem( const_cast<BOARD_CONNECTED_ITEM*>( item ) );
+}
+
+
+void CONNECTIVITY_DATA::Remove( const BOARD_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->Pads().GetFirst(); pad; pad = pad->Next() )
+            removeItem( pad );
+
+        return;
+    }
+
+    if( isConnectivityItem( aItem ) )
+        removeItem( static_cast<const BOARD_CONNECTED_ITEM*>( aItem ) );
+}
+
+
+void CONNECTIVITY_DATA::Update( const BOARD_ITEM* aItem )
+{
+    Remove( aItem );
+    Add( aItem );
+}
+
+
+void CONNECTIVITY_DATA::MarkDirty( int aNetCode )
+{
+    if( aNetCode < 0 )
+    {
+        // Create the nets which are not known yet, they are filled when the board is walked
+        if( m_board->GetNetCount() > 1 )
+            getNet( m_board->GetNetCount() - 1 );
+
+        for( unsigned i = 0; i < m_nets.size(); ++i )
+            m_nets[i].m_dirty = true;
+    }
+    else if( aNetCode > 0 )
+    {
+        getNet( aNetCode ).m_dirty = true;
+    }
+
+    m_hasDirtyNets = true;
+}
+
+
+bool CONNECTIVITY_DATA::AreConnected( const BOARD_CONNECTED_ITEM* aItem,
+                                      const BOARD_CONNECTED_ITEM* aOther )
+{
+    int code = GetClusterCode( aItem );
+
+    return code > 0 && aItem->GetNetCode() == aOther->GetNetCode()
+           && code == GetClusterCode( aOther );
+}
+
+
+int CONNECTIVITY_DATA::GetClusterCode( const BOARD_CONNECTED_ITEM* aItem )
+{
+    const CN_ENTRY* entry = findEntry( aItem );
+
+    if( !entry || entry->m_count == 0 )
+        return 0;
+
+    return m_nets[entry->m_net].m_clusters.Find( entry->m_node ) + 1;
+}
+
+
+int CONNECTIVITY_DATA::GetClusterSize( const BOARD_CONNECTED_ITEM* aItem )
+{
+    const CN_ENTRY* entry = findEntry( aItem );
+
+    if( !entry || entry->m_count == 0 )
+        return 0;
+
+    return m_nets[entry->m_net].m_clusters.ClusterSize( entry->m_node );
+}
+
+
+void CONNECTIVITY_DATA::GetClusterCodes( const BOARD_CONNECTED_ITEM* aItem,
+                                         std::vector<int>& aCodes )
+{
+    const CN_ENTRY* entry = findEntry( aItem );
+
+    if( !entry )
+        return;
+
+    CN_NET& net = m_nets[entry->m_net];
+
+    for( int i = 0; i < entry->m_count; ++i )
+        aCodes.push_back( net.m_clusters.Find( entry->m_node + i ) + 1 );
+}
+
+
+void CONNECTIVITY_DATA::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
+                                           std::list<BOARD_CONNECTED_ITEM*>& aOutput,
+                                           int aTypes )
+{
+    std::vector<int> codes;
+    GetClusterCodes( aItem, codes );
+
+    if( codes.empty() )
+        return;
+
+    CN_NET& net = m_nets[m_items.find( aItem )->second.m_net];
+    const BOARD_CONNECTED_ITEM* last = NULL;
+
+    for( unsigned i = 0; i < net.m_nodes.size(); ++i )
+    {
+        BOARD_CONNECTED_ITEM* item = net.m_nodes[i].m_item;
+
+        // Nodes of a zone are consecutive, report the zone only once
+        if( item == last || !( itemTypeFlag( item ) & aTypes ) )
+            continue;
+
+        int code = net.m_clusters.Find( i ) + 1;
+
+        if( std::find( codes.begin(), codes.end(), code ) != codes.end() )
+        {
+            aOutput.push_back( item );
+            last = item;
+        }
+    }
+}
+
+
+void CONNECTIVITY_DATA::addItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    int netCode = aItem->GetNetCode();
+
+    if( netCode < 1 )           // do not process unconnected items
+        return;
+
+    CN_NET& net = getNet( netCode );
+
+    // The item will be found when the net is rebuilt
+    if( net.m_dirty )
+        return;
+
+    CN_ENTRY entry;
+    entry.m_net = netCode;
+    entry.m_node = net.m_nodes.size();
+    entry.m_count = 0;
+
+    CN_NODE node;
+    node.m_item = aItem;
+    node.m_outline = -1;
+
+    if( aItem->Type() == PCB_ZONE_AREA_T )
+    {
+        const SHAPE_POLY_SET& polys =
+                static_cast<const ZONE_CONTAINER*>( aItem )->GetFilledPolysList();
+
+        for( int outline = 0; outline < polys.OutlineCount(); ++outline )
+        {
+            node.m_outline = outline;
+            addNode( net, node );
+            ++entry.m_count;
+        }
+    }
+    else
+    {
+        addNode( net, node );
+        ++entry.m_count;
+    }
+
+    m_items[aItem] = entry;
+}
+
+
+void CONNECTIVITY_DATA::removeItem( const BOARD_CONNECTED_ITEM* aItem )
+{
+    ITEM_MAP::iterator it = m_items.find( aItem );
+
+    if( it == m_items.end() )
+        return;
+
+    // Clusters cannot be split, the net is rebuilt on the next query
+    m_nets[it->second.m_net].m_dirty = true;
+    m_hasDirtyNets = true;
+    m_items.erase( it );
+}
+
+
+void CONNECTIVITY_DATA::addNode( CN_NET& aNet, const CN_NODE& aNode )
+{
+    int mmin[2], mmax[2];
+
+    if( aNode.m_outline >= 0 )
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aNode.m_item );
+        BOX2I bbox = zone->GetFilledPolysList().COutline( aNode.m_outline ).BBox();
+
+        mmin[0] = bbox.GetX();
+        mmin[1] = bbox.GetY();
+        mmax[0] = bbox.GetRight();
+        mmax[1] = bbox.GetBottom();
+    }
+    else
+    {
+        EDA_RECT bbox = aNode.m_item->GetBoundingBox();
+        bbox.Normalize();
+
+        mmin[0] = bbox.GetX();
+        mmin[1] = bbox.GetY();
+        mmax[0] = bbox.GetRight();
+        mmax[1] = bbox.GetBottom();
+    }
+
+    // Look for the nodes touching the new one before inserting it
+    m_candidates.clear();
+
+    CN_NODE_COLLECTOR collector( m_candidates );
+    aNet.m_index.Search( mmin, mmax, collector );
+
+    int index = aNet.m_clusters.Add();
+    aNet.m_nodes.push_back( aNode );
+    aNet.m_index.Insert( mmin, mmax, index );
+
+    std::vector<wxPoint> anchors;
+    getAnchors( aNode.m_item, anchors );
+
+    std::vector<wxPoint> otherAnchors;
+    LSET layers = aNode.m_item->GetLayerSet() & LSET::AllCuMask();
+
+    for( unsigned i = 0; i < m_candidates.size(); ++i )
+    {
+        const CN_NODE& other = aNet.m_nodes[m_candidates[i]];
+
+        if( other.m_item == aNode.m_item )
+            continue;
+
+        if( aNet.m_clusters.Connected( index, m_candidates[i] ) )
+            continue;
+
+        if( !( other.m_item->GetLayerSet() & layers ).any() )
+            continue;
+
+        getAnchors( other.m_item, otherAnchors );
+
+        if( isAnchoredTo( anchors, aNode.m_item, other.m_item, other.m_outline )
+            || isAnchoredTo( otherAnchors, other.m_item, aNode.m_item, aNode.m_outline ) )
+        {
+            aNet.m_clusters.Union( index, m_candidates[i] );
+        }
+    }
+}
+
+
+void CONNECTIVITY_DATA::rebuildDirtyNets()
+{
+    // Forget the items of the dirty nets (they may have been deleted, so only
+    // the item pointers are used here), and empty the nets
+    for( ITEM_MAP::iterator it = m_items.begin(); it != m_items.end(); )
+    {
+        if( m_nets[it->second.m_net].m_dirty )
+            it = m_items.erase( it );
+        else
+            ++it;
+    }
+
+    std::vector<bool> rebuilt( m_nets.size(), false );
+
+    for( unsigned i = 0; i < m_nets.size(); ++i )
+    {
+        CN_NET& net = m_nets[i];
+
+        if( !net.m_dirty )
+            continue;
+
+        net.m_nodes.clear();
+        net.m_clusters.Reset( 0 );
+        net.m_index.RemoveAll();
+        net.m_dirty = false;
+        rebuilt[i] = true;
+    }
+
+    m_hasDirtyNets = false;
+
+    // Walk the board items once for all the dirty nets
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads().GetFirst(); pad; pad = pad->Next() )
+        {
+            int netCode = pad->GetNetCode();
+
+            if( netCode > 0 && netCode < (int) rebuilt.size() && rebuilt[netCode] )
+                addItem( pad );
+        }
+    }
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+    {
+        int netCode = track->GetNetCode();
+
+        if( netCode > 0 && netCode < (int) rebuilt.size() && rebuilt[netCode] )
+            addItem( track );
+    }
+
+    for( int i = 0; i < m_board->GetAreaCount(); ++i )
+    {
+        ZONE_CONTAINER* zone = m_board->GetArea( i );
+        int netCode = zone->GetNetCode();
+
+        if( netCode > 0 && netCode < (int) rebuilt.size() && rebuilt[netCode]
+            && zone->IsOnCopperLayer() )
+        {
+            addItem( zone );
+        }
+    }
+}
+
+
+const CONNECTIVITY_DATA::CN_ENTRY* CONNECTIVITY_DATA::findEntry(
+        const BOARD_CONNECTED_ITEM* aItem )
+{
+    int netCode = aItem->GetNetCode();
+
+    if( netCode < 1 )
+        return NULL;
+
+    ITEM_MAP::iterator it = m_items.find( aItem );
+
+    // An item whose net was changed without an update is stored in its former net
+    if( it != m_items.end() && it->second.m_net != netCode )
+    {
+        m_nets[it->second.m_net].m_dirty = true;
+        getNet( netCode ).m_dirty = true;
+        m_hasDirtyNets = true;
+    }
+
+    if( m_hasDirtyNets )
+    {
+        rebuildDirtyNets();
+        it = m_items.find( aItem );
+    }
+
+    if( it == m_items.end() )
+        return NULL;
+
+    return &it->second;
+}
+
+
+CONNECTIVITY_DATA::CN_NET& CONNECTIVITY_DATA::getNet( int aNetCode )
+{
+    assert( aNetCode >= 0 );
+
+    while( (int) m_nets.size() <= aNetCode )
+        m_nets.push_back( new CN_NET );
+
+    return m_nets[aNetCode];
+}
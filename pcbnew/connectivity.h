@@ -0,0 +1,202 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity.h
+ * @brief Clusters of copper items connected together, kept up to date with the board changes.
+ */
+
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <vector>
+#include <list>
+
+#include <boost/unordered_map.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <geometry/rtree.h>
+#include <union_find.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+
+/**
+ * Class CONNECTIVITY_DATA
+ * groups the pads, vias, tracks and filled zone areas of a BOARD in clusters of items
+ * connected with copper, net by net. It is owned by the BOARD and fed with the item changes
+ * by RN_DATA. It answers the RN_DATA connection queries (AreConnected(), GetConnectedItems()),
+ * gives the zone subnets (BOARD::Test_Connections_To_Copper_Areas()) and the legacy subnets
+ * (PCB_BASE_FRAME::TestConnections()). Only the ratsnest graphs of RN_DATA are still built
+ * on their own.
+ *
+ * Items are the nodes of a union-find structure (a zone gives one node per filled outline).
+ * An added item is merged with the items it touches, found with a spatial index of the net.
+ * The union-find cannot split a cluster, so a removed or modified item marks its net dirty,
+ * and a dirty net is rebuilt from the board items on the next query.
+ *
+ * Items are connected if they share a copper layer and:
+ * - an end of a track or a via is located at an end of another track or a via,
+ * - an end of a track, a via or a pad shape position is inside a pad,
+ * - an end of a track, a via or a pad shape position is inside a filled zone outline.
+ */
+class CONNECTIVITY_DATA
+{
+public:
+    /**
+     * Constructor
+     * @param aBoard is the board to be processed.
+     */
+    CONNECTIVITY_DATA( const BOARD* aBoard );
+
+    /**
+     * Function Add()
+     * adds an item (or the pads of a footprint) and merges it with the items it touches.
+     * An item which is already known is updated.
+     * @param aItem is the added item.
+     */
+    void Add( const BOARD_ITEM* aItem );
+
+    /**
+     * Function Remove()
+     * removes an item (or the pads of a footprint). The clusters of its net will be rebuilt
+     * on the next query.
+     * @param aItem is the removed item.
+     */
+    void Remove( const BOARD_ITEM* aItem );
+
+    /**
+     * Function Update()
+     * has to be called after an item was modified (moved, zone refilled, net changed...).
+     * @param aItem is the modified item.
+     */
+    void Update( const BOARD_ITEM* aItem );
+
+    /**
+     * Function MarkDirty()
+     * forces the clusters of a net to be rebuilt from the board items on the next query.
+     * It is used by tools which modify items without reporting each change.
+     * @param aNetCode is the net code, or -1 for all the nets.
+     */
+    void MarkDirty( int aNetCode = -1 );
+
+    /**
+     * Function AreConnected()
+     * checks if two items are connected with copper.
+     * @return true if they are in the same cluster.
+     */
+    bool AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNECTED_ITEM* aOther );
+
+    /**
+     * Function GetClusterCode()
+     * returns an identifier of the cluster containing an item, which is the same for all
+     * the items of the cluster and is valid until the board is modified.
+     * Identifiers are unique inside a net only.
+     * @return the cluster identifier (> 0), or 0 if the item is not known.
+     */
+    int GetClusterCode( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function GetClusterSize()
+     * returns the number of nodes in the cluster containing an item (a zone counts once
+     * per filled outline).
+     * @return the cluster size, or 0 if the item is not known.
+     */
+    int GetClusterSize( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function GetClusterCodes()
+     * appends to aCodes the cluster identifiers of all the nodes of an item
+     * (i.e. of each filled outline, for a zone).
+     */
+    void GetClusterCodes( const BOARD_CONNECTED_ITEM* aItem, std::vector<int>& aCodes );
+
+    /**
+     * Function GetConnectedItems()
+     * adds the items connected to aItem (including aItem) to a list.
+     * @param aItem is the reference item.
+     * @param aOutput is the list that will contain found items.
+     * @param aTypes allows to filter by item types (RN_ITEM_TYPE flags).
+     */
+    void GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
+                            std::list<BOARD_CONNECTED_ITEM*>& aOutput, int aTypes );
+
+private:
+    ///> Node of the clusters graph: an item, or a filled outline of a zone.
+    struct CN_NODE
+    {
+        BOARD_CONNECTED_ITEM* m_item;
+        int m_outline;          ///> index of the filled outline for zones, -1 otherwise
+    };
+
+    ///> Clusters of the items of a net.
+    struct CN_NET
+    {
+        CN_NET() : m_dirty( false ) {}
+
+        std::vector<CN_NODE> m_nodes;
+        UNION_FIND m_clusters;
+        RTree<int, int, 2> m_index;     ///> bounding boxes of m_nodes (node indices)
+        bool m_dirty;
+    };
+
+    ///> Location of an item: its net and its first node (zones have consecutive nodes).
+    struct CN_ENTRY
+    {
+        int m_net;
+        int m_node;
+        int m_count;
+    };
+
+    typedef boost::unordered_map<const BOARD_CONNECTED_ITEM*, CN_ENTRY> ITEM_MAP;
+
+    ///> Adds a single connected item (not a footprint).
+    void addItem( BOARD_CONNECTED_ITEM* aItem );
+
+    ///> Removes a single connected item (not a footprint).
+    void removeItem( const BOARD_CONNECTED_ITEM* aItem );
+
+    ///> Adds a node to a net and merges it with the nodes it touches.
+    void addNode( CN_NET& aNet, const CN_NODE& aNode );
+
+    ///> Rebuilds the clusters of the dirty nets, with a single walk through the board items.
+    void rebuildDirtyNets();
+
+    ///> Returns the entry of an item after rebuilding its net if needed, or NULL if the
+    ///> item is not known.
+    const CN_ENTRY* findEntry( const BOARD_CONNECTED_ITEM* aItem );
+
+    ///> Returns the net data for a net code, resizing the net list if needed.
+    CN_NET& getNet( int aNetCode );
+
+    const BOARD* m_board;
+    bool m_hasDirtyNets;
+    boost::ptr_vector<CN_NET> m_nets;
+    ITEM_MAP m_items;
+
+    ///> Nodes found by the spatial index in addNode(), kept to avoid reallocations.
+    std::vector<int> m_candidates;
+};
+
+#endif /* CONNECTIVITY_H */
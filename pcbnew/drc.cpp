@@ -45,10 +45,13 @@
 
 #include <pcbnew.h>
 #include <drc_stuff.h>
+#include <drc_copper_index.h>
 
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
 
+#include <algorithm>
+
 
 void DRC::ShowDialog()
 {
@@ -97,6 +100,20 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 {
     m_mainWindow = aPcbWindow;
     m_pcb = aPcbWindow->GetBoard();
+    init();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_mainWindow = NULL;
+    m_pcb = aBoard;
+    init();
+}
+
+
+void DRC::init()
+{
     m_ui  = 0;
 
     // establish initial values for everything:
@@ -112,14 +129,6 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
-
-    m_segmAngle  = 0;
-    m_segmLength = 0;
-
-    m_xcliplo = 0;
-    m_ycliplo = 0;
-    m_xcliphi = 0;
-    m_ycliphi = 0;
 }
 
 
@@ -457,22 +466,45 @@ void DRC::testPad2Pad()
 
     // Test the pads
     D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    int     padCount = sortedPads.size();
+    int     i;
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
-    {
-        D_PAD* pad = sortedPads[i];
+    std::vector<DRC_MARKER_ENTRY> markers;
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+    // Each pad is tested by a single task, with its own test context and marker list.
+    // Note: the bounding radius of each pad is cached above, before the parallel section.
+#ifdef USE_OPENMP
+    #pragma omp parallel shared(markers) private(i)
+#endif /* USE_OPENMP */
+    {
+        DRC_TEST_CONTEXT              ctx;
+        std::vector<DRC_MARKER_ENTRY> taskMarkers;
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 64)
+#endif /* USE_OPENMP */
+        for( i = 0; i < padCount; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            D_PAD* pad = sortedPads[i];
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !doPadToPadsDrc( ctx, pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                wxASSERT( ctx.m_currentMarker );
+                taskMarkers.push_back( DRC_MARKER_ENTRY( ctx.m_currentMarker, i ) );
+                ctx.m_currentMarker = NULL;
+            }
         }
-    }
+
+#ifdef USE_OPENMP
+        #pragma omp critical
+#endif /* USE_OPENMP */
+        markers.insert( markers.end(), taskMarkers.begin(), taskMarkers.end() );
+    }  /* end of parallel section */
+
+    addMarkersToPcb( markers );
 }
 
 
@@ -481,9 +513,13 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+
+    // Only the neighbours of each segment are tested, they are found using a spatial index
+    DRC_COPPER_INDEX index;
+    index.Build( m_pcb );
+
+    // The last segment is not used as reference: it was tested against all the others
+    int count = (int) index.Tracks().size() - 1;
 
     int deltamax = count/delta;
 
@@ -496,39 +532,116 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    std::vector<DRC_MARKER_ENTRY> markers;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+    // Segments are tested by blocks of delta segments, in parallel inside a block.
+    // The progress bar is updated (from this thread) between blocks.
+    for( int block = 0; block * delta < count; ++block )
     {
-        if ( ii++ > delta )
-        {
-            ii = 0;
-            count++;
+        testTrackRange( index, block * delta, std::min( ( block + 1 ) * delta, count ),
+                        markers );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+        if( progressDialog )
+        {
+            if( !progressDialog->Update( std::min( block + 1, deltamax ), wxEmptyString ) )
+                break;  // Aborted by user
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+            // Work around a dialog z-order issue on OS X
+            if( block + 1 == deltamax )
+                aActiveWindow->Raise();
 #endif
+        }
+    }
+
+    addMarkersToPcb( markers );
+
+    if( progressDialog )
+        progressDialog->Destroy();
+}
+
+
+void DRC::testTrackRange( DRC_COPPER_INDEX& aIndex, int aFrom, int aTo,
+                          std::vector<DRC_MARKER_ENTRY>& aMarkers )
+{
+    const std::vector<TRACK*>& tracks = aIndex.Tracks();
+    int refIndex;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel shared(aMarkers) private(refIndex)
+#endif /* USE_OPENMP */
+    {
+        DRC_TEST_CONTEXT              ctx;
+        std::vector<DRC_MARKER_ENTRY> taskMarkers;
+        std::vector<TRACK*>           nearTracks;
+        std::vector<D_PAD*>           nearPads;
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif /* USE_OPENMP */
+        for( refIndex = aFrom; refIndex < aTo; ++refIndex )
+        {
+            aIndex.QueryPads( refIndex, nearPads );
+            aIndex.QueryTracks( refIndex, nearTracks );
+
+            if( !doTrackDrc( ctx, tracks[refIndex], nearTracks, nearPads ) )
+            {
+                wxASSERT( ctx.m_currentMarker );
+                taskMarkers.push_back( DRC_MARKER_ENTRY( ctx.m_currentMarker, refIndex ) );
+                ctx.m_currentMarker = NULL;
             }
         }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+#ifdef USE_OPENMP
+        #pragma omp critical
+#endif /* USE_OPENMP */
+        aMarkers.insert( aMarkers.end(), taskMarkers.begin(), taskMarkers.end() );
+    }  /* end of parallel section */
+}
+
+
+void DRC::TestTrackClearances( std::vector<MARKER_PCB*>& aMarkers, bool aUseIndex )
+{
+    if( aUseIndex )
+    {
+        DRC_COPPER_INDEX index;
+        index.Build( m_pcb );
+
+        std::vector<DRC_MARKER_ENTRY> markers;
+
+        testTrackRange( index, 0, (int) index.Tracks().size() - 1, markers );
+
+        std::stable_sort( markers.begin(), markers.end() );
+
+        for( unsigned ii = 0; ii < markers.size(); ++ii )
+            aMarkers.push_back( markers[ii].m_marker );
+    }
+    else
+    {
+        for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            if( !doTrackDrc( segm, segm->Next(), true ) )
+            {
+                aMarkers.push_back( m_currentMarker );
+                m_currentMarker = 0;
+            }
         }
     }
+}
 
-    if( progressDialog )
-        progressDialog->Destroy();
+
+void DRC::addMarkersToPcb( std::vector<DRC_MARKER_ENTRY>& aMarkers )
+{
+    // Keys are unique for a given test, but stable_sort keeps the order of several
+    // markers found for the same item anyway
+    std::stable_sort( aMarkers.begin(), aMarkers.end() );
+
+    for( unsigned ii = 0; ii < aMarkers.size(); ++ii )
+    {
+        m_pcb->Add( aMarkers[ii].m_marker );
+        m_mainWindow->GetGalCanvas()->GetView()->Add( aMarkers[ii].m_marker );
+    }
+
+    aMarkers.clear();
 }
 
 
@@ -609,6 +722,15 @@ void DRC::testZones()
 
 void DRC::testKeepoutAreas()
 {
+    std::vector<TRACK*>           tracks;
+    std::vector<DRC_MARKER_ENTRY> markers;
+
+    for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
+        tracks.push_back( segm );
+
+    int trackCount = tracks.size();
+    int jj;
+
     // Test keepout areas for vias, tracks and pads inside keepout areas
     for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
     {
@@ -617,55 +739,71 @@ void DRC::testKeepoutAreas()
         if( !area->GetIsKeepout() )
             continue;
 
-        for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
+#ifdef USE_OPENMP
+        #pragma omp parallel shared(markers, area, ii) private(jj)
+#endif /* USE_OPENMP */
         {
-            if( segm->Type() == PCB_TRACE_T )
-            {
-                if( ! area->GetDoNotAllowTracks()  )
-                    continue;
+            std::vector<DRC_MARKER_ENTRY> taskMarkers;
 
-                if( segm->GetLayer() != area->GetLayer() )
-                    continue;
+#ifdef USE_OPENMP
+            #pragma omp for schedule(dynamic, 256)
+#endif /* USE_OPENMP */
+            for( jj = 0; jj < trackCount; ++jj )
+            {
+                TRACK* segm = tracks[jj];
 
-                if( area->Outline()->Distance( segm->GetStart(), segm->GetEnd(),
-                                               segm->GetWidth() ) == 0 )
+                if( segm->Type() == PCB_TRACE_T )
                 {
-                    m_currentMarker = fillMarker( segm, NULL,
-                                                  DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                    m_currentMarker = 0;
-                }
-            }
-            else if( segm->Type() == PCB_VIA_T )
-            {
-                if( ! area->GetDoNotAllowVias()  )
-                    continue;
+                    if( ! area->GetDoNotAllowTracks()  )
+                        continue;
 
-                if( ! ((VIA*)segm)->IsOnLayer( area->GetLayer() ) )
-                    continue;
+                    if( segm->GetLayer() != area->GetLayer() )
+                        continue;
 
-                if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
+                    if( area->Outline()->Distance( segm->GetStart(), segm->GetEnd(),
+                                                   segm->GetWidth() ) == 0 )
+                    {
+                        MARKER_PCB* marker = fillMarker( segm, NULL,
+                                                         DRCE_TRACK_INSIDE_KEEPOUT, NULL );
+                        taskMarkers.push_back( DRC_MARKER_ENTRY( marker, ii, jj ) );
+                    }
+                }
+                else if( segm->Type() == PCB_VIA_T )
                 {
-                    m_currentMarker = fillMarker( segm, NULL,
-                                                  DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                    m_currentMarker = 0;
+                    if( ! area->GetDoNotAllowVias()  )
+                        continue;
+
+                    if( ! ((VIA*)segm)->IsOnLayer( area->GetLayer() ) )
+                        continue;
+
+                    if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
+                    {
+                        MARKER_PCB* marker = fillMarker( segm, NULL,
+                                                         DRCE_VIA_INSIDE_KEEPOUT, NULL );
+                        taskMarkers.push_back( DRC_MARKER_ENTRY( marker, ii, jj ) );
+                    }
                 }
             }
-        }
+
+#ifdef USE_OPENMP
+            #pragma omp critical
+#endif /* USE_OPENMP */
+            markers.insert( markers.end(), taskMarkers.begin(), taskMarkers.end() );
+        }  /* end of parallel section */
+
         // Test pads: TODO
     }
+
+    addMarkersToPcb( markers );
 }
 
 
 void DRC::testTexts()
 {
-    std::vector<wxPoint> textShape;      // a buffer to store the text shape (set of segments)
-    std::vector<D_PAD*> padList = m_pcb->GetPads();
+    std::vector<D_PAD*>           padList = m_pcb->GetPads();
+    std::vector<TEXTE_PCB*>       texts;
+    std::vector<DRC_MARKER_ENTRY> markers;
 
-    // Test text areas for vias, tracks and pads inside text areas
     for( BOARD_ITEM* item = m_pcb->m_Drawings; item; item = item->Next() )
     {
         // Drc test only items on copper layers
@@ -676,117 +814,143 @@ void DRC::testTexts()
         if( item->Type() !=  PCB_TEXT_T )
             continue;
 
-        textShape.clear();
+        texts.push_back( static_cast<TEXTE_PCB*>( item ) );
+    }
+
+    int textCount = texts.size();
+    int ii;
 
-        // So far the bounding box makes up the text-area
-        TEXTE_PCB* text = (TEXTE_PCB*) item;
-        text->TransformTextShapeToSegmentList( textShape );
+    // Text shapes (sets of segments) are computed beforehand, as TransformTextShapeToSegmentList()
+    // is not reentrant
+    std::vector< std::vector<wxPoint> > textShapes( textCount );
 
-        if( textShape.size() == 0 )     // Should not happen (empty text?)
-            continue;
+    for( ii = 0; ii < textCount; ++ii )
+        texts[ii]->TransformTextShapeToSegmentList( textShapes[ii] );
 
-        for( TRACK* track = m_pcb->m_Track; track != NULL; track = track->Next() )
+    // Test text areas for vias, tracks and pads inside text areas.
+    // Each text is tested by a single task, markers are keyed by text, then in test order.
+#ifdef USE_OPENMP
+    #pragma omp parallel shared(markers) private(ii)
+#endif /* USE_OPENMP */
+    {
+        DRC_TEST_CONTEXT              ctx;
+        std::vector<DRC_MARKER_ENTRY> taskMarkers;
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 1)
+#endif /* USE_OPENMP */
+        for( ii = 0; ii < textCount; ++ii )
         {
-            if( ! track->IsOnLayer( item->GetLayer() ) )
-                    continue;
+            TEXTE_PCB*                  text = texts[ii];
+            const std::vector<wxPoint>& textShape = textShapes[ii];
+            int                         found = 0;
 
-            // Test the distance between each segment and the current track/via
-            int min_dist = ( track->GetWidth() + text->GetThickness() ) /2 +
-                           track->GetClearance(NULL);
+            if( textShape.size() == 0 )     // Should not happen (empty text?)
+                continue;
 
-            if( track->Type() == PCB_TRACE_T )
+            for( TRACK* track = m_pcb->m_Track; track != NULL; track = track->Next() )
             {
-                SEG segref( track->GetStart(), track->GetEnd() );
+                if( ! track->IsOnLayer( text->GetLayer() ) )
+                        continue;
 
-                // Error condition: Distance between text segment and track segment is
-                // smaller than the clearance of the segment
-                for( unsigned jj = 0; jj < textShape.size(); jj += 2 )
+                // Test the distance between each segment and the current track/via
+                int min_dist = ( track->GetWidth() + text->GetThickness() ) /2 +
+                               track->GetClearance(NULL);
+
+                if( track->Type() == PCB_TRACE_T )
                 {
-                    SEG segtest( textShape[jj], textShape[jj+1] );
-                    int dist = segref.Distance( segtest );
+                    SEG segref( track->GetStart(), track->GetEnd() );
 
-                    if( dist < min_dist )
+                    // Error condition: Distance between text segment and track segment is
+                    // smaller than the clearance of the segment
+                    for( unsigned jj = 0; jj < textShape.size(); jj += 2 )
                     {
-                        m_currentMarker = fillMarker( track, text,
-                                                      DRCE_TRACK_INSIDE_TEXT,
-                                                      m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                        m_currentMarker = NULL;
-                        break;
+                        SEG segtest( textShape[jj], textShape[jj+1] );
+                        int dist = segref.Distance( segtest );
+
+                        if( dist < min_dist )
+                        {
+                            MARKER_PCB* marker = fillMarker( track, text,
+                                                             DRCE_TRACK_INSIDE_TEXT, NULL );
+                            taskMarkers.push_back( DRC_MARKER_ENTRY( marker, ii, found++ ) );
+                            break;
+                        }
                     }
                 }
-            }
-            else if( track->Type() == PCB_VIA_T )
-            {
-                // Error condition: Distance between text segment and via is
-                // smaller than the clearance of the via
-                for( unsigned jj = 0; jj < textShape.size(); jj += 2 )
+                else if( track->Type() == PCB_VIA_T )
                 {
-                    SEG segtest( textShape[jj], textShape[jj+1] );
-
-                    if( segtest.PointCloserThan( track->GetPosition(), min_dist ) )
+                    // Error condition: Distance between text segment and via is
+                    // smaller than the clearance of the via
+                    for( unsigned jj = 0; jj < textShape.size(); jj += 2 )
                     {
-                        m_currentMarker = fillMarker( track, text,
-                                                      DRCE_VIA_INSIDE_TEXT, m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                        m_currentMarker = NULL;
-                        break;
+                        SEG segtest( textShape[jj], textShape[jj+1] );
+
+                        if( segtest.PointCloserThan( track->GetPosition(), min_dist ) )
+                        {
+                            MARKER_PCB* marker = fillMarker( track, text,
+                                                             DRCE_VIA_INSIDE_TEXT, NULL );
+                            taskMarkers.push_back( DRC_MARKER_ENTRY( marker, ii, found++ ) );
+                            break;
+                        }
                     }
                 }
             }
-        }
 
-        // Test pads
-        for( unsigned ii = 0; ii < padList.size(); ii++ )
-        {
-            D_PAD* pad = padList[ii];
+            // Test pads
+            for( unsigned jj = 0; jj < padList.size(); jj++ )
+            {
+                D_PAD* pad = padList[jj];
 
-            if( ! pad->IsOnLayer( item->GetLayer() ) )
-                    continue;
+                if( ! pad->IsOnLayer( text->GetLayer() ) )
+                        continue;
 
-            wxPoint shape_pos = pad->ShapePos();
+                wxPoint shape_pos = pad->ShapePos();
 
-            for( unsigned jj = 0; jj < textShape.size(); jj += 2 )
-            {
-                /* In order to make some calculations more easier or faster,
-                 * pads and tracks coordinates will be made relative
-                 * to the segment origin
-                 */
-                wxPoint origin = textShape[jj];  // origin will be the origin of other coordinates
-                m_segmEnd = textShape[jj+1] - origin;
-                wxPoint delta = m_segmEnd;
-                m_segmAngle = 0;
-
-                // for a non horizontal or vertical segment Compute the segment angle
-                // in tenths of degrees and its length
-                if( delta.x || delta.y )    // delta.x == delta.y == 0 for vias
+                for( unsigned kk = 0; kk < textShape.size(); kk += 2 )
                 {
-                    // Compute the segment angle in 0,1 degrees
-                    m_segmAngle = ArcTangente( delta.y, delta.x );
+                    /* In order to make some calculations more easier or faster,
+                     * pads and tracks coordinates will be made relative
+                     * to the segment origin
+                     */
+                    // origin will be the origin of other coordinates
+                    wxPoint origin = textShape[kk];
+                    ctx.m_segmEnd = textShape[kk+1] - origin;
+                    wxPoint delta = ctx.m_segmEnd;
+                    ctx.m_segmAngle = 0;
+
+                    // for a non horizontal or vertical segment Compute the segment angle
+                    // in tenths of degrees and its length
+                    if( delta.x || delta.y )    // delta.x == delta.y == 0 for vias
+                    {
+                        // Compute the segment angle in 0,1 degrees
+                        ctx.m_segmAngle = ArcTangente( delta.y, delta.x );
 
-                    // Compute the segment length: we build an equivalent rotated segment,
-                    // this segment is horizontal, therefore dx = length
-                    RotatePoint( &delta, m_segmAngle );    // delta.x = length, delta.y = 0
-                }
+                        // Compute the segment length: we build an equivalent rotated segment,
+                        // this segment is horizontal, therefore dx = length
+                        RotatePoint( &delta, ctx.m_segmAngle );    // delta.x = length, delta.y = 0
+                    }
 
-                m_segmLength = delta.x;
-                m_padToTestPos = shape_pos - origin;
+                    ctx.m_segmLength = delta.x;
+                    ctx.m_padToTestPos = shape_pos - origin;
 
-                if( !checkClearanceSegmToPad( pad, text->GetThickness(),
-                                              pad->GetClearance(NULL) ) )
-                {
-                    m_currentMarker = fillMarker( pad, text,
-                                                  DRCE_PAD_INSIDE_TEXT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                    m_currentMarker = NULL;
-                    break;
+                    if( !ctx.checkClearanceSegmToPad( pad, text->GetThickness(),
+                                                      pad->GetClearance(NULL) ) )
+                    {
+                        MARKER_PCB* marker = fillMarker( pad, text, DRCE_PAD_INSIDE_TEXT, NULL );
+                        taskMarkers.push_back( DRC_MARKER_ENTRY( marker, ii, found++ ) );
+                        break;
+                    }
                 }
             }
         }
-    }
+
+#ifdef USE_OPENMP
+        #pragma omp critical
+#endif /* USE_OPENMP */
+        markers.insert( markers.end(), taskMarkers.begin(), taskMarkers.end() );
+    }  /* end of parallel section */
+
+    addMarkersToPcb( markers );
 }
 
 
@@ -837,7 +1001,8 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
 }
 
 
-bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit )
+bool DRC::doPadToPadsDrc( DRC_TEST_CONTEXT& aCtx, D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd,
+                          int x_limit )
 {
     const static LSET all_cu = LSET::AllCuMask();
 
@@ -906,11 +1071,11 @@ bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_li
                                                            PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
                 dummypad.SetOrientation( pad->GetOrientation() );
 
-                if( !checkClearancePadToPad( aRefPad, &dummypad ) )
+                if( !aCtx.checkClearancePadToPad( aRefPad, &dummypad ) )
                 {
                     // here we have a drc error on pad!
-                    m_currentMarker = fillMarker( pad, aRefPad,
-                                                  DRCE_HOLE_NEAR_PAD, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( pad, aRefPad,
+                                                       DRCE_HOLE_NEAR_PAD, aCtx.m_currentMarker );
                     return false;
                 }
             }
@@ -923,11 +1088,11 @@ bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_li
                                                                PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
                 dummypad.SetOrientation( aRefPad->GetOrientation() );
 
-                if( !checkClearancePadToPad( pad, &dummypad ) )
+                if( !aCtx.checkClearancePadToPad( pad, &dummypad ) )
                 {
                     // here we have a drc error on aRefPad!
-                    m_currentMarker = fillMarker( aRefPad, pad,
-                                                  DRCE_HOLE_NEAR_PAD, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefPad, pad,
+                                                       DRCE_HOLE_NEAR_PAD, aCtx.m_currentMarker );
                     return false;
                 }
             }
@@ -952,10 +1117,11 @@ bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_li
                 continue;
         }
 
-        if( !checkClearancePadToPad( aRefPad, pad ) )
+        if( !aCtx.checkClearancePadToPad( aRefPad, pad ) )
         {
             // here we have a drc error!
-            m_currentMarker = fillMarker( aRefPad, pad, DRCE_PAD_NEAR_PAD1, m_currentMarker );
+            aCtx.m_currentMarker = fillMarker( aRefPad, pad, DRCE_PAD_NEAR_PAD1,
+                                               aCtx.m_currentMarker );
             return false;
         }
     }
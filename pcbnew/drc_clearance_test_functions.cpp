@@ -146,7 +146,40 @@ bool trapezoid2pointDRC( wxPoint aTref[4], wxPoint aPcompare, int aDist )
 }
 
 
+DRC_TEST_CONTEXT::DRC_TEST_CONTEXT( MARKER_PCB* aMarker ) :
+    m_currentMarker( aMarker ),
+    m_segmAngle( 0 ),
+    m_segmLength( 0 ),
+    m_xcliplo( 0 ),
+    m_ycliplo( 0 ),
+    m_xcliphi( 0 ),
+    m_ycliphi( 0 )
+{
+}
+
+
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
+{
+    std::vector<TRACK*> tracks;
+    std::vector<D_PAD*> pads;
+
+    for( TRACK* track = aStart; track; track = track->Next() )
+        tracks.push_back( track );
+
+    if( testPads )
+        pads = m_pcb->GetPads();
+
+    DRC_TEST_CONTEXT ctx( m_currentMarker );
+    bool             ok = doTrackDrc( ctx, aRefSeg, tracks, pads );
+
+    m_currentMarker = ctx.m_currentMarker;
+
+    return ok;
+}
+
+
+bool DRC::doTrackDrc( DRC_TEST_CONTEXT& aCtx, TRACK* aRefSeg, const std::vector<TRACK*>& aTracks,
+                      const std::vector<D_PAD*>& aPads )
 {
     TRACK*    track;
     wxPoint   delta;           // lenght on X and Y axis of segments
@@ -162,8 +195,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
      */
     wxPoint origin = aRefSeg->GetStart();  // origin will be the origin of other coordinates
 
-    m_segmEnd   = delta = aRefSeg->GetEnd() - origin;
-    m_segmAngle = 0;
+    aCtx.m_segmEnd   = delta = aRefSeg->GetEnd() - origin;
+    aCtx.m_segmAngle = 0;
 
     layerMask    = aRefSeg->GetLayerSet();
     net_code_ref = aRefSeg->GetNetCode();
@@ -177,8 +210,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
         {
             if( refvia->GetWidth() < dsnSettings.m_MicroViasMinSize )
             {
-                m_currentMarker = fillMarker( refvia, NULL,
-                                              DRCE_TOO_SMALL_MICROVIA, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( refvia, NULL,
+                                                   DRCE_TOO_SMALL_MICROVIA, aCtx.m_currentMarker );
                 return false;
             }
         }
@@ -186,8 +219,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
         {
             if( refvia->GetWidth() < dsnSettings.m_ViasMinSize )
             {
-                m_currentMarker = fillMarker( refvia, NULL,
-                                              DRCE_TOO_SMALL_VIA, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( refvia, NULL,
+                                                   DRCE_TOO_SMALL_VIA, aCtx.m_currentMarker );
                 return false;
             }
         }
@@ -197,8 +230,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
         // and a default via hole can be bigger than some vias sizes
         if( refvia->GetDrillValue() > refvia->GetWidth() )
         {
-            m_currentMarker = fillMarker( refvia, NULL,
-                                          DRCE_VIA_HOLE_BIGGER, m_currentMarker );
+            aCtx.m_currentMarker = fillMarker( refvia, NULL,
+                                               DRCE_VIA_HOLE_BIGGER, aCtx.m_currentMarker );
             return false;
         }
 
@@ -222,8 +255,9 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 
             if( err )
             {
-                m_currentMarker = fillMarker( refvia, NULL,
-                                              DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( refvia, NULL,
+                                                   DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR,
+                                                   aCtx.m_currentMarker );
                 return false;
             }
         }
@@ -232,8 +266,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     {
         if( aRefSeg->GetWidth() < dsnSettings.m_TrackMinWidth )
         {
-            m_currentMarker = fillMarker( aRefSeg, NULL,
-                                          DRCE_TOO_SMALL_TRACK_WIDTH, m_currentMarker );
+            aCtx.m_currentMarker = fillMarker( aRefSeg, NULL,
+                                               DRCE_TOO_SMALL_TRACK_WIDTH, aCtx.m_currentMarker );
             return false;
         }
     }
@@ -243,14 +277,14 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     if( delta.x || delta.y )
     {
         // Compute the segment angle in 0,1 degrees
-        m_segmAngle = ArcTangente( delta.y, delta.x );
+        aCtx.m_segmAngle = ArcTangente( delta.y, delta.x );
 
         // Compute the segment length: we build an equivalent rotated segment,
         // this segment is horizontal, therefore dx = length
-        RotatePoint( &delta, m_segmAngle );    // delta.x = length, delta.y = 0
+        RotatePoint( &delta, aCtx.m_segmAngle );    // delta.x = length, delta.y = 0
     }
 
-    m_segmLength = delta.x;
+    aCtx.m_segmLength = delta.x;
 
     /******************************************/
     /* Phase 1 : test DRC track to pads :     */
@@ -270,62 +304,59 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
 
     // Compute the min distance to pads
-    if( testPads )
+    for( unsigned ii = 0;  ii < aPads.size();  ++ii )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
+        D_PAD* pad = aPads[ii];
 
-        for( unsigned ii = 0;  ii<pad_count;  ++ii )
+        /* No problem if pads are on an other layer,
+         * But if a drill hole exists	(a pad on a single layer can have a hole!)
+         * we must test the hole
+         */
+        if( !( pad->GetLayerSet() & layerMask ).any() )
         {
-            D_PAD* pad = m_pcb->GetPad( ii );
-
-            /* No problem if pads are on an other layer,
-             * But if a drill hole exists	(a pad on a single layer can have a hole!)
-             * we must test the hole
+            /* We must test the pad hole. In order to use the function
+             * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
+             * size like the hole
              */
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-            {
-                /* We must test the pad hole. In order to use the function
-                 * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
-                 * size like the hole
-                 */
-                if( pad->GetDrillSize().x == 0 )
-                    continue;
-
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetPosition( pad->GetPosition() );
-                dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetOrientation( pad->GetOrientation() );
-
-                m_padToTestPos = dummypad.GetPosition() - origin;
-
-                if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
-                                              netclass->GetClearance() ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, pad,
-                                                  DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
-                    return false;
-                }
-
+            if( pad->GetDrillSize().x == 0 )
                 continue;
-            }
 
-            // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
-            // but no problem if the pad netcode is the current netcode (same net)
-            if( pad->GetNetCode()                       // the pad must be connected
-               && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
-                continue;
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetPosition( pad->GetPosition() );
+            dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetOrientation( pad->GetOrientation() );
 
-            // DRC for the pad
-            shape_pos = pad->ShapePos();
-            m_padToTestPos = shape_pos - origin;
+            aCtx.m_padToTestPos = dummypad.GetPosition() - origin;
 
-            if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+            if( !aCtx.checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
+                                          netclass->GetClearance() ) )
             {
-                m_currentMarker = fillMarker( aRefSeg, pad,
-                                              DRCE_TRACK_NEAR_PAD, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( aRefSeg, pad,
+                                                   DRCE_TRACK_NEAR_THROUGH_HOLE,
+                                                   aCtx.m_currentMarker );
                 return false;
             }
+
+            continue;
+        }
+
+        // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
+        // but no problem if the pad netcode is the current netcode (same net)
+        if( pad->GetNetCode()                       // the pad must be connected
+           && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
+            continue;
+
+        // DRC for the pad
+        shape_pos = pad->ShapePos();
+        aCtx.m_padToTestPos = shape_pos - origin;
+
+        if( !aCtx.checkClearanceSegmToPad( pad, aRefSeg->GetWidth(),
+                                           aRefSeg->GetClearance( pad ) ) )
+        {
+            aCtx.m_currentMarker = fillMarker( aRefSeg, pad,
+                                               DRCE_TRACK_NEAR_PAD, aCtx.m_currentMarker );
+            return false;
         }
     }
 
@@ -338,8 +369,10 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Test the reference segment with other track segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+    for( unsigned ii = 0; ii < aTracks.size(); ++ii )
     {
+        track = aTracks[ii];
+
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
             continue;
@@ -364,8 +397,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
                 // Test distance between two vias, i.e. two circles, trivial case
                 if( EuclideanNorm( segStartPoint ) < w_dist )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_VIA_NEAR_VIA, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_VIA_NEAR_VIA, aCtx.m_currentMarker );
                     return false;
                 }
             }
@@ -378,10 +411,10 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
                 RotatePoint( &delta, angle );
                 RotatePoint( &segStartPoint, angle );
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
+                if( !aCtx.checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
                 {
-                    m_currentMarker = fillMarker( track, aRefSeg,
-                                                  DRCE_VIA_NEAR_TRACK, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( track, aRefSeg,
+                                                       DRCE_VIA_NEAR_TRACK, aCtx.m_currentMarker );
                     return false;
                 }
             }
@@ -395,15 +428,15 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
          */
         segStartPoint = track->GetStart() - origin;
         segEndPoint   = track->GetEnd() - origin;
-        RotatePoint( &segStartPoint, m_segmAngle );
-        RotatePoint( &segEndPoint, m_segmAngle );
+        RotatePoint( &segStartPoint, aCtx.m_segmAngle );
+        RotatePoint( &segEndPoint, aCtx.m_segmAngle );
         if( track->Type() == PCB_VIA_T )
         {
-            if( checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+            if( aCtx.checkMarginToCircle( segStartPoint, w_dist, aCtx.m_segmLength ) )
                 continue;
 
-            m_currentMarker = fillMarker( aRefSeg, track,
-                                          DRCE_TRACK_NEAR_VIA, m_currentMarker );
+            aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                               DRCE_TRACK_NEAR_VIA, aCtx.m_currentMarker );
             return false;
         }
 
@@ -420,45 +453,46 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
             if( segStartPoint.x > segEndPoint.x )
                 std::swap( segStartPoint.x, segEndPoint.x );
 
-            if( segStartPoint.x > (-w_dist) && segStartPoint.x < (m_segmLength + w_dist) )    /* possible error drc */
+            /* possible error drc */
+            if( segStartPoint.x > (-w_dist) && segStartPoint.x < (aCtx.m_segmLength + w_dist) )
             {
                 // the start point is inside the reference range
                 //      X........
                 //    O--REF--+
 
                 // Fine test : we consider the rounded shape of each end of the track segment:
-                if( segStartPoint.x >= 0 && segStartPoint.x <= m_segmLength )
+                if( segStartPoint.x >= 0 && segStartPoint.x <= aCtx.m_segmLength )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS1, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_TRACK_ENDS1, aCtx.m_currentMarker );
                     return false;
                 }
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+                if( !aCtx.checkMarginToCircle( segStartPoint, w_dist, aCtx.m_segmLength ) )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS2, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_TRACK_ENDS2, aCtx.m_currentMarker );
                     return false;
                 }
             }
 
-            if( segEndPoint.x > (-w_dist) && segEndPoint.x < (m_segmLength + w_dist) )
+            if( segEndPoint.x > (-w_dist) && segEndPoint.x < (aCtx.m_segmLength + w_dist) )
             {
                 // the end point is inside the reference range
                 //  .....X
                 //    O--REF--+
                 // Fine test : we consider the rounded shape of the ends
-                if( segEndPoint.x >= 0 && segEndPoint.x <= m_segmLength )
+                if( segEndPoint.x >= 0 && segEndPoint.x <= aCtx.m_segmLength )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS3, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_TRACK_ENDS3, aCtx.m_currentMarker );
                     return false;
                 }
 
-                if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
+                if( !aCtx.checkMarginToCircle( segEndPoint, w_dist, aCtx.m_segmLength ) )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS4, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_TRACK_ENDS4, aCtx.m_currentMarker );
                     return false;
                 }
             }
@@ -470,14 +504,16 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
             // handled)
             //  X.............X
             //    O--REF--+
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACK_SEGMENTS_TOO_CLOSE, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                   DRCE_TRACK_SEGMENTS_TOO_CLOSE,
+                                                   aCtx.m_currentMarker );
                 return false;
             }
         }
         else if( segStartPoint.x == segEndPoint.x ) // perpendicular segments
         {
-            if( ( segStartPoint.x <= (-w_dist) ) || ( segStartPoint.x >= (m_segmLength + w_dist) ) )
+            if( ( segStartPoint.x <= (-w_dist) )
+               || ( segStartPoint.x >= (aCtx.m_segmLength + w_dist) ) )
                 continue;
 
             // Test if segments are crossing
@@ -486,22 +522,22 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 
             if( (segStartPoint.y < 0) && (segEndPoint.y > 0) )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACKS_CROSSING, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                   DRCE_TRACKS_CROSSING, aCtx.m_currentMarker );
                 return false;
             }
 
             // At this point the drc error is due to an end near a reference segm end
-            if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+            if( !aCtx.checkMarginToCircle( segStartPoint, w_dist, aCtx.m_segmLength ) )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM1, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                   DRCE_ENDS_PROBLEM1, aCtx.m_currentMarker );
                 return false;
             }
-            if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
+            if( !aCtx.checkMarginToCircle( segEndPoint, w_dist, aCtx.m_segmLength ) )
             {
-                m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM2, m_currentMarker );
+                aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                   DRCE_ENDS_PROBLEM2, aCtx.m_currentMarker );
                 return false;
             }
         }
@@ -510,26 +546,26 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
             // calcul de la "surface de securite du segment de reference
             // First rought 'and fast) test : the track segment is like a rectangle
 
-            m_xcliplo = m_ycliplo = -w_dist;
-            m_xcliphi = m_segmLength + w_dist;
-            m_ycliphi = w_dist;
+            aCtx.m_xcliplo = aCtx.m_ycliplo = -w_dist;
+            aCtx.m_xcliphi = aCtx.m_segmLength + w_dist;
+            aCtx.m_ycliphi = w_dist;
 
             // A fine test is needed because a serment is not exactly a
             // rectangle, it has rounded ends
-            if( !checkLine( segStartPoint, segEndPoint ) )
+            if( !aCtx.checkLine( segStartPoint, segEndPoint ) )
             {
                 /* 2eme passe : the track has rounded ends.
                  * we must a fine test for each rounded end and the
                  * rectangular zone
                  */
 
-                m_xcliplo = 0;
-                m_xcliphi = m_segmLength;
+                aCtx.m_xcliplo = 0;
+                aCtx.m_xcliphi = aCtx.m_segmLength;
 
-                if( !checkLine( segStartPoint, segEndPoint ) )
+                if( !aCtx.checkLine( segStartPoint, segEndPoint ) )
                 {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_ENDS_PROBLEM3, m_currentMarker );
+                    aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                       DRCE_ENDS_PROBLEM3, aCtx.m_currentMarker );
                     return false;
                 }
                 else    // The drc error is due to the starting or the ending point of the reference segment
@@ -554,17 +590,19 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
                     RotatePoint( &relStartPos, angle );
                     RotatePoint( &relEndPos, angle );
 
-                    if( !checkMarginToCircle( relStartPos, w_dist, delta.x ) )
+                    if( !aCtx.checkMarginToCircle( relStartPos, w_dist, delta.x ) )
                     {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM4, m_currentMarker );
+                        aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                           DRCE_ENDS_PROBLEM4,
+                                                           aCtx.m_currentMarker );
                         return false;
                     }
 
-                    if( !checkMarginToCircle( relEndPos, w_dist, delta.x ) )
+                    if( !aCtx.checkMarginToCircle( relEndPos, w_dist, delta.x ) )
                     {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM5, m_currentMarker );
+                        aCtx.m_currentMarker = fillMarker( aRefSeg, track,
+                                                           DRCE_ENDS_PROBLEM5,
+                                                           aCtx.m_currentMarker );
                         return false;
                     }
                 }
@@ -580,7 +618,7 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
  * this function can be also used to test DRC between a pas and a hole,
  * because a hole is like a round pad.
  */
-bool DRC::checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad )
+bool DRC_TEST_CONTEXT::checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad )
 {
     int     dist;
 
@@ -730,7 +768,7 @@ bool DRC::checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad )
         {
             // Should not occur, because aPad and aRefPad are swapped
             // to have only aPad shape RECT or TRAP and aRefPad shape TRAP or RECT.
-            wxLogDebug( wxT( "DRC::checkClearancePadToPad: unexpected pad ref RECT @ %d, %d to pad shape %d @ %d, %d"),
+            wxLogDebug( wxT( "DRC_TEST_CONTEXT::checkClearancePadToPad: unexpected pad ref RECT @ %d, %d to pad shape %d @ %d, %d"),
                 aRefPad->GetPosition().x, aRefPad->GetPosition().y,
                 aPad->GetShape(), aPad->GetPosition().x, aPad->GetPosition().y );
         }
@@ -800,7 +838,7 @@ bool DRC::checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad )
         break;
 
     default:
-        wxLogDebug( wxT( "DRC::checkClearancePadToPad: unexpected pad shape" ) );
+        wxLogDebug( wxT( "DRC_TEST_CONTEXT::checkClearancePadToPad: unexpected pad shape" ) );
         break;
     }
 
@@ -813,7 +851,8 @@ bool DRC::checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad )
  * and its orientation is m_segmAngle (m_segmAngle must be already initialized)
  * and have aSegmentWidth.
  */
-bool DRC::checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth, int aMinDist )
+bool DRC_TEST_CONTEXT::checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth,
+                                                int aMinDist )
 {
     wxSize  padHalfsize;            // half dimension of the pad
     wxPoint startPoint, endPoint;
@@ -1018,7 +1057,7 @@ bool DRC::checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth, int aMi
  * and a segment. the segment is expected starting at 0,0, and on the X axis
  * return true if distance >= aRadius
  */
-bool DRC::checkMarginToCircle( wxPoint aCentre, int aRadius, int aLength )
+bool DRC_TEST_CONTEXT::checkMarginToCircle( wxPoint aCentre, int aRadius, int aLength )
 {
     if( abs( aCentre.y ) > aRadius )     // trivial case
         return true;
@@ -1056,7 +1095,7 @@ static inline int USCALE( unsigned arg, unsigned num, unsigned den )
  * The rectangle is defined by m_xcliplo, m_ycliplo and m_xcliphi, m_ycliphi
  * return true if the line from aSegStart to aSegEnd is outside the bounding box
  */
-bool DRC::checkLine( wxPoint aSegStart, wxPoint aSegEnd )
+bool DRC_TEST_CONTEXT::checkLine( wxPoint aSegStart, wxPoint aSegEnd )
 {
 #define WHEN_OUTSIDE return true
 #define WHEN_INSIDE
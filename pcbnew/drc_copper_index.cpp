@@ -0,0 +1,186 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_copper_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_copper_index.h>
+
+
+/// Visitor for RTree::Search(), gathers the indices of the items found.
+struct INDEX_COLLECTOR
+{
+    INDEX_COLLECTOR( std::vector<int>& aItems ) :
+        m_items( aItems )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_items.push_back( aIndex );
+        return true;
+    }
+
+    std::vector<int>& m_items;
+};
+
+
+/// Inserts aIndex in aTree, with the bounding box of aStart, aEnd inflated by aInflate.
+static void insertBox( RTree<int, int, 2>& aTree, int aIndex,
+                       const wxPoint& aStart, const wxPoint& aEnd, int aInflate )
+{
+    const int mmin[2] = { std::min( aStart.x, aEnd.x ) - aInflate,
+                          std::min( aStart.y, aEnd.y ) - aInflate };
+    const int mmax[2] = { std::max( aStart.x, aEnd.x ) + aInflate,
+                          std::max( aStart.y, aEnd.y ) + aInflate };
+
+    aTree.Insert( mmin, mmax, aIndex );
+}
+
+
+DRC_COPPER_INDEX::DRC_COPPER_INDEX() :
+    m_maxClearance( 0 )
+{
+}
+
+
+void DRC_COPPER_INDEX::Clear()
+{
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        m_trackTrees[layer].RemoveAll();
+
+    m_padTree.RemoveAll();
+    m_tracks.clear();
+    m_pads.clear();
+}
+
+
+void DRC_COPPER_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    m_maxClearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int index = m_tracks.size();
+        m_tracks.push_back( track );
+
+        // A via is inserted in all the copper layers it goes through
+        for( LSEQ cu = track->GetLayerSet().CuStack(); cu; ++cu )
+        {
+            insertBox( m_trackTrees[*cu], index, track->GetStart(), track->GetEnd(),
+                       track->GetWidth() / 2 );
+        }
+    }
+
+    m_pads = aBoard->GetPads();
+
+    for( unsigned ii = 0; ii < m_pads.size(); ++ii )
+    {
+        D_PAD* pad = m_pads[ii];
+
+        // A track may be tested against the pad shape, with the pad clearance (which can be
+        // a local one), or against the pad hole, with the track netclass clearance.
+        // The box must hold both of them.
+        int clearance  = std::max( pad->GetClearance(), m_maxClearance );
+        int shapeSize  = pad->GetBoundingRadius() + clearance;
+        int holeSize   = std::max( pad->GetDrillSize().x, pad->GetDrillSize().y ) / 2 +
+                         m_maxClearance;
+        wxPoint center = pad->ShapePos();
+        wxPoint hole   = pad->GetPosition();
+
+        const int mmin[2] = { std::min( center.x - shapeSize, hole.x - holeSize ),
+                              std::min( center.y - shapeSize, hole.y - holeSize ) };
+        const int mmax[2] = { std::max( center.x + shapeSize, hole.x + holeSize ),
+                              std::max( center.y + shapeSize, hole.y + holeSize ) };
+
+        m_padTree.Insert( mmin, mmax, (int) ii );
+    }
+}
+
+
+void DRC_COPPER_INDEX::QueryTracks( int aRefIndex, std::vector<TRACK*>& aResult )
+{
+    const TRACK* refSeg = m_tracks[aRefIndex];
+    int          inflate = refSeg->GetWidth() / 2 + m_maxClearance + SEARCH_MARGIN;
+    std::vector<int> found;
+
+    for( LSEQ cu = refSeg->GetLayerSet().CuStack(); cu; ++cu )
+        queryTree( m_trackTrees[*cu], refSeg, inflate, found );
+
+    // Vias are stored once per layer, so they can be found more than once
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+
+    aResult.clear();
+
+    // Only the segments after the reference one are tested (the previous
+    // ones have already been tested against the reference segment)
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+    {
+        if( found[ii] > aRefIndex )
+            aResult.push_back( m_tracks[found[ii]] );
+    }
+}
+
+
+void DRC_COPPER_INDEX::QueryPads( int aRefIndex, std::vector<D_PAD*>& aResult )
+{
+    const TRACK* refSeg = m_tracks[aRefIndex];
+    std::vector<int> found;
+
+    // Pad boxes are already inflated by the clearance
+    queryTree( m_padTree, refSeg, refSeg->GetWidth() / 2 + SEARCH_MARGIN, found );
+
+    std::sort( found.begin(), found.end() );
+
+    aResult.clear();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aResult.push_back( m_pads[found[ii]] );
+}
+
+
+void DRC_COPPER_INDEX::queryTree( ITEM_RTREE& aTree, const TRACK* aRefSeg, int aInflate,
+                                  std::vector<int>& aResult )
+{
+    const wxPoint& start = aRefSeg->GetStart();
+    const wxPoint& end   = aRefSeg->GetEnd();
+
+    const int mmin[2] = { std::min( start.x, end.x ) - aInflate,
+                          std::min( start.y, end.y ) - aInflate };
+    const int mmax[2] = { std::max( start.x, end.x ) + aInflate,
+                          std::max( start.y, end.y ) + aInflate };
+
+    INDEX_COLLECTOR collector( aResult );
+    aTree.Search( mmin, mmax, collector );
+}
@@ -0,0 +1,121 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_copper_index.h
+ * @brief Spatial index of the copper items tested by the DRC track clearance pass.
+ */
+
+#ifndef DRC_COPPER_INDEX_H
+#define DRC_COPPER_INDEX_H
+
+#include <vector>
+
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class TRACK;
+class D_PAD;
+
+/**
+ * Class DRC_COPPER_INDEX
+ * keeps the tracks, vias and pads of a BOARD in R-trees (one per copper layer for tracks
+ * and vias, one for all pads), so that the clearance of a track segment can be checked only
+ * against the items that are close enough to violate it.
+ *
+ * Items are stored by their index in the board lists and the queries return candidates
+ * in that order, so a test running over the candidates meets the items in the same order
+ * as a test walking the whole board lists, and reports the same first error.
+ * Non-owning: the index must be rebuilt when the board items change.
+ */
+class DRC_COPPER_INDEX
+{
+public:
+    DRC_COPPER_INDEX();
+
+    /**
+     * Function Build
+     * indexes all the tracks, vias and pads of aBoard, dropping the previous content.
+     * Pads are inflated by the largest clearance they can be tested with, tracks by half
+     * their width.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function Tracks
+     * @return the indexed tracks and vias, in the board track list order.
+     */
+    const std::vector<TRACK*>& Tracks() const
+    {
+        return m_tracks;
+    }
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias which follow Tracks()[aRefIndex] in the track list,
+     * share a copper layer with it and may be closer than the biggest clearance.
+     * @param aRefIndex index of the reference segment in Tracks().
+     * @param aResult is filled with the candidates, in track list order.
+     */
+    void QueryTracks( int aRefIndex, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function QueryPads
+     * collects the pads (on any layer, because pad holes are tested too) which may
+     * be closer to Tracks()[aRefIndex] than their clearance.
+     * @param aRefIndex index of the reference segment in Tracks().
+     * @param aResult is filled with the candidates, in board pad list order.
+     */
+    void QueryPads( int aRefIndex, std::vector<D_PAD*>& aResult );
+
+private:
+    typedef RTree<int, int, 2> ITEM_RTREE;
+
+    /// Margin added to the searched areas, to absorb the rounding of the DRC tests.
+    static const int SEARCH_MARGIN = 10;
+
+    /**
+     * Function queryTree
+     * appends to aResult the items of aTree whose box overlaps the box of aRefSeg
+     * inflated by aInflate.
+     */
+    void queryTree( ITEM_RTREE& aTree, const TRACK* aRefSeg, int aInflate,
+                    std::vector<int>& aResult );
+
+    std::vector<TRACK*> m_tracks;
+    std::vector<D_PAD*> m_pads;
+
+    ITEM_RTREE          m_trackTrees[MAX_CU_LAYERS];
+    ITEM_RTREE          m_padTree;
+
+    int                 m_maxClearance;
+};
+
+#endif  // DRC_COPPER_INDEX_H
@@ -91,6 +91,7 @@ class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
 class NETCLASS;
+class DRC_COPPER_INDEX;
 
 
 /**
@@ -140,6 +141,125 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Class DRC_TEST_CONTEXT
+ * holds the scratch state of the single item clearance tests, and the marker they fill
+ * when they find a problem.  Each task running such tests needs its own context, so that
+ * several tasks can run in parallel.
+ */
+class DRC_TEST_CONTEXT
+{
+    friend class DRC;
+
+public:
+    DRC_TEST_CONTEXT( MARKER_PCB* aMarker = NULL );
+
+    MARKER_PCB* m_currentMarker;    ///< marker filled in by the last failed test
+
+private:
+    /* In DRC functions, many calculations are using coordinates relative
+     * to the position of the segment under test (segm to segm DRC, segm to pad DRC
+     * Next variables store coordinates relative to the start point of this segment
+     */
+    wxPoint m_padToTestPos; // Position of the pad to compare in drc test segm to pad or pad to pad
+    wxPoint m_segmEnd;      // End point of the reference segment (start point = (0,0) )
+
+    /* Some functions are comparing the ref segm to pads or others segments using
+     * coordinates relative to the ref segment considered as the X axis
+     * so we store the ref segment length (the end point relative to these axis)
+     * and the segment orientation (used to rotate other coordinates)
+     */
+    double m_segmAngle;     // Ref segm orientation in 0,1 degre
+    int m_segmLength;       // length of the reference segment
+
+    /* variables used in checkLine to test DRC segm to segm:
+     * define the area relative to the ref segment that does not contains any other segment
+     */
+    int    m_xcliplo;
+    int    m_ycliplo;
+    int    m_xcliphi;
+    int    m_ycliphi;
+
+    /**
+     * Function checkClearancePadToPad
+     * @param aRefPad The reference pad to check
+     * @param aPad Another pad to check against
+     * @return bool - true if clearance between aRefPad and aPad is >= dist_min, else false
+     */
+    bool checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad );
+
+
+    /**
+     * Function checkClearanceSegmToPad
+     * check the distance from a pad to segment.  This function uses several
+     * instance variable not passed in:
+     *      m_segmLength = length of the segment being tested
+     *      m_segmAngle  = angle of the segment with the X axis;
+     *      m_segmEnd    = end coordinate of the segment
+     *      m_padToTestPos = position of pad relative to the origin of segment
+     * @param aPad Is the pad involved in the check
+     * @param aSegmentWidth width of the segment to test
+     * @param aMinDist Is the minimum clearance needed
+     *
+     * @return true distance >= dist_min,
+     *         false if distance < dist_min
+     */
+    bool checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth, int aMinDist );
+
+
+    /**
+     * Helper function checkMarginToCircle
+     * Check the distance from a point to
+     * a segment. the segment is expected starting at 0,0, and on the X axis
+     * (used to test DRC between a segment and a round pad, via or round end of a track
+     * @param aCentre The coordinate of the circle's center
+     * @param aRadius A "keep out" radius centered over the circle
+     * @param aLength The length of the segment (i.e. coordinate of end, becuase it is on
+     *                the X axis)
+     * @return bool - true if distance >= radius, else
+     *                false when distance < aRadius
+     */
+    static bool checkMarginToCircle( wxPoint aCentre, int aRadius, int aLength );
+
+
+    /**
+     * Function checkLine
+     * (helper function used in drc calculations to see if one track is in contact with
+     *  another track).
+     * Test if a line intersects a bounding box (a rectangle)
+     * The rectangle is defined by m_xcliplo, m_ycliplo and m_xcliphi, m_ycliphi
+     * return true if the line from aSegStart to aSegEnd is outside the bounding box
+     */
+    bool        checkLine( wxPoint aSegStart, wxPoint aSegEnd );
+};
+
+
+/**
+ * Struct DRC_MARKER_ENTRY
+ * is a marker found by a DRC task, with the place of the tested items in the sequential
+ * test order.  Used to merge the markers found by parallel tasks in a stable order.
+ */
+struct DRC_MARKER_ENTRY
+{
+    DRC_MARKER_ENTRY( MARKER_PCB* aMarker, int aMajor, int aMinor = 0 ) :
+        m_marker( aMarker ), m_major( aMajor ), m_minor( aMinor )
+    {
+    }
+
+    bool operator<( const DRC_MARKER_ENTRY& aOther ) const
+    {
+        if( m_major != aOther.m_major )
+            return m_major < aOther.m_major;
+
+        return m_minor < aOther.m_minor;
+    }
+
+    MARKER_PCB* m_marker;
+    int         m_major;    ///< index of the item in the outer test loop
+    int         m_minor;    ///< index of the item in the inner test loop, if any
+};
+
+
 /**
  * Class DRC
  * is the Design Rule Checker, and performs all the DRC tests.  The output of
@@ -170,29 +290,6 @@ private:
     bool        m_abortDRC;
     bool        m_drcInProgress;
 
-    /* In DRC functions, many calculations are using coordinates relative
-     * to the position of the segment under test (segm to segm DRC, segm to pad DRC
-     * Next variables store coordinates relative to the start point of this segment
-     */
-    wxPoint m_padToTestPos; // Position of the pad to compare in drc test segm to pad or pad to pad
-    wxPoint m_segmEnd;      // End point of the reference segment (start point = (0,0) )
-
-    /* Some functions are comparing the ref segm to pads or others segments using
-     * coordinates relative to the ref segment considered as the X axis
-     * so we store the ref segment length (the end point relative to these axis)
-     * and the segment orientation (used to rotate other coordinates)
-     */
-    double m_segmAngle;     // Ref segm orientation in 0,1 degre
-    int m_segmLength;       // length of the reference segment
-
-    /* variables used in checkLine to test DRC segm to segm:
-     * define the area relative to the ref segment that does not contains any other segment
-     */
-    int                 m_xcliplo;
-    int                 m_ycliplo;
-    int                 m_xcliphi;
-    int                 m_ycliphi;
-
     PCB_EDIT_FRAME*     m_mainWindow;
     BOARD*              m_pcb;
     DIALOG_DRC_CONTROL* m_ui;
@@ -207,6 +304,12 @@ private:
      */
     void updatePointers();
 
+    /**
+     * Function init
+     * sets the default test settings, common to all constructors.
+     */
+    void init();
+
 
     /**
      * Function fillMarker
@@ -277,6 +380,23 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Function testTrackRange
+     * runs the track clearance test for the reference segments aFrom to aTo - 1
+     * of aIndex, in parallel when possible.
+     * @param aMarkers receives the markers found, keyed by the reference segment index.
+     */
+    void testTrackRange( DRC_COPPER_INDEX& aIndex, int aFrom, int aTo,
+                         std::vector<DRC_MARKER_ENTRY>& aMarkers );
+
+    /**
+     * Function addMarkersToPcb
+     * sorts the markers found by the (possibly parallel) test tasks in the sequential
+     * test order, so that reports are the same from one run to another, and adds them
+     * to the board and the view.
+     */
+    void addMarkersToPcb( std::vector<DRC_MARKER_ENTRY>& aMarkers );
+
     void testPad2Pad();
 
     void testUnconnected();
@@ -295,12 +415,14 @@ private:
      * Function doPadToPadsDrc
      * tests the clearance between aRefPad and other pads.
      * The pad list must be sorted by x coordinate.
+     * @param aCtx The context of the test, its marker is filled in on error
      * @param aRefPad The pad to test
      * @param aStart The start of the pad list to test against
      * @param aEnd Marks the end of the list and is not included
      * @param x_limit is used to stop the test (when the any pad's X coord exceeds this)
      */
-    bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
+    bool doPadToPadsDrc( DRC_TEST_CONTEXT& aCtx, D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd,
+                         int x_limit );
 
     /**
      * Function DoTrackDrc
@@ -313,6 +435,24 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function doTrackDrc
+     * tests aRefSeg (its via sizes, then its clearance) against candidate lists
+     * collected beforehand, usually by DRC_COPPER_INDEX::QueryTracks() and
+     * DRC_COPPER_INDEX::QueryPads(). Only the given items are tested: the board
+     * lists are not walked, so the function may be called from several threads.
+     * @param aCtx The per thread test context; its marker is reused and filled in
+     *             on error, m_currentMarker is left untouched
+     * @param aRefSeg The track or via to test
+     * @param aTracks The tracks and vias to test against (same net items are skipped)
+     * @param aPads The pads to test against, including pads on other layers whose
+     *              holes are tested
+     * @return bool - true if no problem is found, false on the first problem, with
+     *          aCtx.m_currentMarker describing it.
+     */
+    bool doTrackDrc( DRC_TEST_CONTEXT& aCtx, TRACK* aRefSeg, const std::vector<TRACK*>& aTracks,
+                     const std::vector<D_PAD*>& aPads );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -334,64 +474,17 @@ private:
      */
     bool doEdgeZoneDrc( ZONE_CONTAINER* aArea, int aCornerIndex );
 
-    //-----<single tests>----------------------------------------------
-
-    /**
-     * Function checkClearancePadToPad
-     * @param aRefPad The reference pad to check
-     * @param aPad Another pad to check against
-     * @return bool - true if clearance between aRefPad and aPad is >= dist_min, else false
-     */
-    bool checkClearancePadToPad( D_PAD* aRefPad, D_PAD* aPad );
-
-
-    /**
-     * Function checkClearanceSegmToPad
-     * check the distance from a pad to segment.  This function uses several
-     * instance variable not passed in:
-     *      m_segmLength = length of the segment being tested
-     *      m_segmAngle  = angle of the segment with the X axis;
-     *      m_segmEnd    = end coordinate of the segment
-     *      m_padToTestPos = position of pad relative to the origin of segment
-     * @param aPad Is the pad involved in the check
-     * @param aSegmentWidth width of the segment to test
-     * @param aMinDist Is the minimum clearance needed
-     *
-     * @return true distance >= dist_min,
-     *         false if distance < dist_min
-     */
-    bool checkClearanceSegmToPad( const D_PAD* aPad, int aSegmentWidth, int aMinDist );
-
-
-    /**
-     * Helper function checkMarginToCircle
-     * Check the distance from a point to
-     * a segment. the segment is expected starting at 0,0, and on the X axis
-     * (used to test DRC between a segment and a round pad, via or round end of a track
-     * @param aCentre The coordinate of the circle's center
-     * @param aRadius A "keep out" radius centered over the circle
-     * @param aLength The length of the segment (i.e. coordinate of end, becuase it is on
-     *                the X axis)
-     * @return bool - true if distance >= radius, else
-     *                false when distance < aRadius
-     */
-    static bool checkMarginToCircle( wxPoint aCentre, int aRadius, int aLength );
 
+public:
+    DRC( PCB_EDIT_FRAME* aPcbWindow );
 
     /**
-     * Function checkLine
-     * (helper function used in drc calculations to see if one track is in contact with
-     *  another track).
-     * Test if a line intersects a bounding box (a rectangle)
-     * The rectangle is defined by m_xcliplo, m_ycliplo and m_xcliphi, m_ycliphi
-     * return true if the line from aSegStart to aSegEnd is outside the bounding box
+     * Constructor DRC
+     * creates a DRC which is not attached to an editor frame, and can only run the tests
+     * which do not need a frame, like TestTrackClearances().  Used by the scripting.
+     * @param aBoard The board to test.
      */
-    bool        checkLine( wxPoint aSegStart, wxPoint aSegEnd );
-
-    //-----</single tests>---------------------------------------------
-
-public:
-    DRC( PCB_EDIT_FRAME* aPcbWindow );
+    DRC( BOARD* aBoard );
 
     ~DRC();
 
@@ -484,6 +577,19 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Function TestTrackClearances
+     * runs the track and via clearance tests done by RunTests(), without any UI, and
+     * gives the markers to the caller instead of adding them to the board.
+     * @param aMarkers receives the new markers, in track list order. The caller owns them.
+     * @param aUseIndex = true to test each segment only against its neighbours found in a
+     *                    spatial index, false to use the legacy sweep which tests each
+     *                    segment against all the pads and all the following segments.
+     *                    Both give the same markers, the legacy sweep is kept for regression
+     *                    testing.
+     */
+    void TestTrackClearances( std::vector<MARKER_PCB*>& aMarkers, bool aUseIndex = true );
+
     /**
      * Function ListUnconnectedPad
      * gathers a list of all the unconnected pads and shows them in the
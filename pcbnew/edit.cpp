@@ -105,6 +105,7 @@ void PCB_EDIT_FRAME::Process_Special_Functions( wxCommandEvent& event )
     case ID_POPUP_PCB_STOP_CURRENT_EDGE_ZONE:
     case ID_POPUP_PCB_DELETE_ZONE_LAST_CREATED_CORNER:
     case ID_POPUP_PCB_FILL_ALL_ZONES:
+    case ID_POPUP_PCB_FILL_DIRTY_ZONES:
     case ID_POPUP_PCB_REMOVE_FILLED_AREAS_IN_ALL_ZONES:
     case ID_POPUP_PCB_REMOVE_FILLED_AREAS_IN_CURRENT_ZONE:
     case ID_POPUP_PCB_PLACE_ZONE_CORNER:
@@ -629,6 +630,13 @@ void PCB_EDIT_FRAME::Process_Special_Functions( wxCommandEvent& event )
         SetMsgPanel( GetBoard() );
         break;
 
+    case ID_POPUP_PCB_FILL_DIRTY_ZONES:
+        m_canvas->MoveCursorToCrossHair();
+        Fill_Dirty_Zones( this );
+        m_canvas->Refresh();
+        SetMsgPanel( GetBoard() );
+        break;
+
     case ID_POPUP_PCB_REMOVE_FILLED_AREAS_IN_CURRENT_ZONE:
         if( ( GetCurItem() )->Type() == PCB_ZONE_AREA_T )
         {
@@ -368,6 +368,8 @@ bool PCB_EDIT_FRAME::OnRightClick( const wxPoint& aMousePos, wxMenu* aPopMenu )
                                  g_Board_Editor_Hokeys_Descr, HK_ZONE_FILL_OR_REFILL );
             AddMenuItem( aPopMenu, ID_POPUP_PCB_FILL_ALL_ZONES,
                          msg, KiBitmap( fill_zone_xpm ) );
+            AddMenuItem( aPopMenu, ID_POPUP_PCB_FILL_DIRTY_ZONES,
+                         _( "Refill Modified Zones" ), KiBitmap( fill_zone_xpm ) );
             msg = AddHotkeyName( _( "Remove Filled Areas in All Zones" ),
                                  g_Board_Editor_Hokeys_Descr, HK_ZONE_REMOVE_FILLED );
             AddMenuItem( aPopMenu, ID_POPUP_PCB_REMOVE_FILLED_AREAS_IN_ALL_ZONES,
@@ -29,6 +29,7 @@
 
 namespace KIGFX
 {
+    class VIEW;
     class WORKSHEET_VIEWITEM;
     class RATSNEST_VIEWITEM;
 }
@@ -80,12 +81,29 @@ public:
     ///> @copydoc EDA_DRAW_PANEL_GAL::GetMsgPanelInfo()
     void GetMsgPanelInfo( std::vector<MSG_PANEL_ITEM>& aList );
 
-protected:
-    ///> Reassigns layer order to the initial settings.
-    void setDefaultLayerOrder();
+    /**
+     * Function AddBoardItems
+     * adds zones, drawings, tracks and modules of a BOARD to a VIEW.
+     * @param aView is the VIEW to be filled.
+     * @param aBoard is the PCB to be loaded.
+     */
+    static void AddBoardItems( KIGFX::VIEW* aView, const BOARD* aBoard );
+
+    /**
+     * Function SyncLayersVisibility
+     * Updates "visibility" property of each layer of a VIEW using a given BOARD.
+     * @param aView is the VIEW to be updated.
+     * @param aBoard contains layers visibility settings to be applied.
+     */
+    static void SyncLayersVisibility( KIGFX::VIEW* aView, const BOARD* aBoard );
 
-    ///> Sets rendering targets & dependencies for layers.
-    void setDefaultLayerDeps();
+    ///> Reassigns layer order of a VIEW to the initial settings.
+    static void SetDefaultLayerOrder( KIGFX::VIEW* aView );
+
+    ///> Sets rendering targets & dependencies for layers of a VIEW.
+    static void SetDefaultLayerDeps( KIGFX::VIEW* aView );
+
+protected:
 
     ///> Currently used worksheet
     KIGFX::WORKSHEET_VIEWITEM* m_worksheet;
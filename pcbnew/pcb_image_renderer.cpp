@@ -0,0 +1,125 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_image_renderer.cpp
+ * @brief Renders boards to images without a window.
+ */
+
+#include <pcb_image_renderer.h>
+#include <pcb_draw_panel_gal.h>
+#include <pcb_painter.h>
+#include <view/view.h>
+#include <gal/cairo/cairo_image_gal.h>
+
+#include <class_board.h>
+#include <macros.h>
+
+PCB_IMAGE_RENDERER::PCB_IMAGE_RENDERER( int aWidth, int aHeight ) :
+    m_board( NULL )
+{
+    m_gal     = new KIGFX::CAIRO_IMAGE_GAL( aWidth, aHeight );
+    m_painter = new KIGFX::PCB_PAINTER( m_gal );
+
+    // A static view does not take over the items, so boards opened in the editor may be rendered
+    m_view = new KIGFX::VIEW( false );
+    m_view->SetPainter( m_painter );
+    m_view->SetGAL( m_gal );
+
+    PCB_DRAW_PANEL_GAL::SetDefaultLayerOrder( m_view );
+    PCB_DRAW_PANEL_GAL::SetDefaultLayerDeps( m_view );
+
+    // Every frame is drawn from scratch, so there is no point in caching items
+    for( int layer = 0; layer < KIGFX::VIEW::VIEW_MAX_LAYERS; ++layer )
+    {
+        if( m_view->IsCached( layer ) )
+            m_view->SetLayerTarget( layer, KIGFX::TARGET_NONCACHED );
+    }
+
+    // Images may be much smaller than the editor window
+    m_view->SetScaleLimits( 15000.0, 0.01 );
+}
+
+
+PCB_IMAGE_RENDERER::~PCB_IMAGE_RENDERER()
+{
+    delete m_view;
+    delete m_painter;
+    delete m_gal;
+}
+
+
+void PCB_IMAGE_RENDERER::DisplayBoard( BOARD* aBoard )
+{
+    m_view->Clear();
+    m_board = aBoard;
+
+    PCB_DRAW_PANEL_GAL::AddBoardItems( m_view, aBoard );
+    PCB_DRAW_PANEL_GAL::SyncLayersVisibility( m_view, aBoard );
+
+    KIGFX::PCB_RENDER_SETTINGS* rs;
+    rs = static_cast<KIGFX::PCB_RENDER_SETTINGS*>( m_painter->GetSettings() );
+    rs->ImportLegacyColors( aBoard->GetColorsSettings() );
+
+    ZoomFitBoard();
+}
+
+
+void PCB_IMAGE_RENDERER::SetViewport( const EDA_RECT& aArea )
+{
+    EDA_RECT area( aArea );
+    area.Normalize();
+
+    if( area.GetWidth() == 0 || area.GetHeight() == 0 )
+        return;
+
+    m_view->SetViewport( BOX2D( VECTOR2D( area.GetOrigin() ), VECTOR2D( area.GetSize() ) ) );
+}
+
+
+void PCB_IMAGE_RENDERER::ZoomFitBoard()
+{
+    if( m_board )
+        SetViewport( m_board->ComputeBoundingBox() );
+}
+
+
+void PCB_IMAGE_RENDERER::Render()
+{
+    m_gal->BeginDrawing();
+    m_gal->ClearScreen( m_painter->GetSettings()->GetBackgroundColor() );
+
+    // Draw the whole image, there is no previous frame to be updated
+    m_view->MarkDirty();
+    m_view->ClearTargets();
+    m_view->Redraw();
+
+    m_gal->EndDrawing();
+}
+
+
+bool PCB_IMAGE_RENDERER::SaveImage( const wxString& aFileName ) const
+{
+    return m_gal->SaveImage( TO_UTF8( aFileName ) );
+}
@@ -0,0 +1,114 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_image_renderer.h
+ * @brief Renders boards to images without a window.
+ */
+
+#ifndef PCB_IMAGE_RENDERER_H_
+#define PCB_IMAGE_RENDERER_H_
+
+#include <wx/string.h>
+
+namespace KIGFX
+{
+    class CAIRO_IMAGE_GAL;
+    class PCB_PAINTER;
+    class VIEW;
+}
+class BOARD;
+class EDA_RECT;
+
+
+/**
+ * Class PCB_IMAGE_RENDERER
+ * draws a board the same way as the GAL canvas does, but to an image stored in the memory,
+ * so no window is needed. Especially useful in Python scripts.
+ *
+ * Renderers do not share any state, so several boards may be rendered by different threads
+ * at the same time. A board must not be rendered by more than one renderer at a time though.
+ */
+class PCB_IMAGE_RENDERER
+{
+public:
+    /**
+     * Constructor PCB_IMAGE_RENDERER
+     * @param aWidth is the image width (in pixels).
+     * @param aHeight is the image height (in pixels).
+     */
+    PCB_IMAGE_RENDERER( int aWidth, int aHeight );
+
+    ~PCB_IMAGE_RENDERER();
+
+    /**
+     * Function DisplayBoard
+     * loads items, colors and layers visibility of a board and fits the view to the board.
+     * @param aBoard is the PCB to be rendered. It has to exist as long as it is displayed.
+     */
+    void DisplayBoard( BOARD* aBoard );
+
+    /**
+     * Function SetViewport
+     * sets the area of the board to be rendered. The aspect ratio of the image is preserved,
+     * so the rendered area may be larger than the requested one.
+     * @param aArea is the area to be rendered (in internal units).
+     */
+    void SetViewport( const EDA_RECT& aArea );
+
+    /**
+     * Function ZoomFitBoard
+     * sets the viewport so the whole displayed board is rendered.
+     */
+    void ZoomFitBoard();
+
+    /**
+     * Function Render
+     * draws the displayed board to the image.
+     */
+    void Render();
+
+    /**
+     * Function SaveImage
+     * writes the image rendered by the last Render() call to a PNG file.
+     * @param aFileName is the name of the file to be written.
+     * @return true on success.
+     */
+    bool SaveImage( const wxString& aFileName ) const;
+
+private:
+    /// Image the board is rendered to
+    KIGFX::CAIRO_IMAGE_GAL* m_gal;
+
+    /// Painter drawing board items using m_gal
+    KIGFX::PCB_PAINTER*     m_painter;
+
+    /// Static view holding the board items, it does not take them over from the board editor
+    KIGFX::VIEW*            m_view;
+
+    /// Currently displayed board
+    BOARD*                  m_board;
+};
+
+#endif /* PCB_IMAGE_RENDERER_H_ */
@@ -211,6 +211,16 @@ PCB_PAINTER::PCB_PAINTER( GAL* aGal ) :
 }
 
 
+PAINTER* PCB_PAINTER::Clone( GAL* aGal ) const
+{
+    // Drawing does not modify the items nor the painter, so copies may run concurrently
+    PCB_PAINTER* painter = new PCB_PAINTER( *this );
+    painter->SetGAL( aGal );
+
+    return painter;
+}
+
+
 bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 {
     const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
@@ -197,6 +197,9 @@ public:
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer );
 
+    /// @copydoc PAINTER::Clone()
+    virtual PAINTER* Clone( GAL* aGal ) const;
+
 protected:
     PCB_RENDER_SETTINGS m_pcbSettings;
 
@@ -483,6 +483,9 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
+    // Zone fillings are read from the file with the board, so they are up to date
+    aBoard->ClearZonesDirty();
+
     if( IsGalCanvasActive() )
     {
         aBoard->GetRatsnest()->Recalculate();
@@ -111,6 +111,7 @@ enum pcbnew_ids
     ID_POPUP_PCB_DELETE_ZONE,
     ID_POPUP_PCB_STOP_CURRENT_EDGE_ZONE,
     ID_POPUP_PCB_FILL_ALL_ZONES,
+    ID_POPUP_PCB_FILL_DIRTY_ZONES,
     ID_POPUP_PCB_FILL_ZONE,
     ID_POPUP_PCB_DELETE_ZONE_CONTAINER,
     ID_POPUP_PCB_ZONE_DUPLICATE,
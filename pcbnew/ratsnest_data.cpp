@@ -32,6 +32,7 @@
 #endif /* USE_OPENMP */
 
 #include <ratsnest_data.h>
+#include <connectivity.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -114,8 +115,35 @@ static bool isEdgeConnectingNode( const RN_EDGE_PTR& aEdge, const RN_NODE_PTR& a
 }
 
 
-static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
-                                                 std::vector<RN_NODE_PTR>& aNodes )
+///> Finds the subtree containing node aNode (union-find with path halving)
+static int findSubtree( std::vector<int>& aParents, int aNode )
+{
+    while( aParents[aNode] != aNode )
+    {
+        aParents[aNode] = aParents[aParents[aNode]];
+        aNode = aParents[aNode];
+    }
+
+    return aNode;
+}
+
+
+///> Returns the index of aNode in the node vector passed to kruskalMST(), or -1 if the node
+///> does not belong to it
+static int nodeIndex( const RN_NODE_PTR& aNode, const std::vector<RN_NODE_PTR>& aNodes )
+{
+    int tag = aNode->GetTag();
+
+    if( tag < 0 || tag >= (int) aNodes.size() || aNodes[tag].get() != aNode.get() )
+        return -1;
+
+    return tag;
+}
+
+
+static std::vector<RN_EDGE_MST_PTR>* kruskalMST( std::vector<RN_EDGE_PTR>& aEdges,
+                                                 std::vector<RN_NODE_PTR>& aNodes,
+                                                 RN_LINKS& aLinks )
 {
     unsigned int nodeNumber = aNodes.size();
     unsigned int mstExpectedSize = nodeNumber - 1;
@@ -126,67 +154,63 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
     std::vector<RN_EDGE_MST_PTR>* mst = new std::vector<RN_EDGE_MST_PTR>;
     mst->reserve( mstExpectedSize );
 
-    // Set tags for marking cycles
-    boost::unordered_map<RN_NODE_PTR, int> tags;
-    unsigned int tag = 0;
-    BOOST_FOREACH( RN_NODE_PTR& node, aNodes )
-    {
-        node->SetTag( tag );
-        tags[node] = tag++;
-    }
+    // Nodes are identified by their index, stored as the tag
+    std::vector<int> subtrees( nodeNumber );
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
     for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    {
+        aNodes[i]->SetTag( i );
+        subtrees[i] = i;
+    }
 
     // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+    std::stable_sort( aEdges.begin(), aEdges.end(), sortWeight );
+
+    // Find the node indices of the edges before the tags are changed
+    std::vector<std::pair<int, int> > edgeNodes( aEdges.size() );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
+    for( unsigned int i = 0; i < aEdges.size(); ++i )
     {
-        RN_EDGE_PTR& dt = aEdges.front();
+        edgeNodes[i].first = nodeIndex( aEdges[i]->GetSourceNode(), aNodes );
+        edgeNodes[i].second = nodeIndex( aEdges[i]->GetTargetNode(), aNodes );
+    }
 
-        int srcTag = tags[dt->GetSourceNode()];
-        int trgTag = tags[dt->GetTargetNode()];
+    for( unsigned int i = 0; i < aEdges.size() && mstSize < mstExpectedSize; ++i )
+    {
+        const RN_EDGE_PTR& dt = aEdges[i];
 
-        // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest.
+        if( !ratsnestLines && dt->GetWeight() != 0 )
         {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt->GetWeight() != 0 )
-                ratsnestLines = true;
+            ratsnestLines = true;
 
-            // Update tags
-            std::list<int>::iterator it, itEnd;
+            // Tags tell which nodes are connected with copper, so they are set before
+            // the subtrees get joined by ratsnest lines
+            for( unsigned int j = 0; j < nodeNumber; ++j )
+                aNodes[j]->SetTag( findSubtree( subtrees, j ) );
+        }
 
-            if( ratsnestLines )
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                    tags[aNodes[*it]] = srcTag;
-            }
-            else
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it ) {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
-            }
+        // Skip edges with nodes that are not handled anymore
+        if( edgeNodes[i].first < 0 || edgeNodes[i].second < 0 )
+            continue;
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+        int srcTree = findSubtree( subtrees, edgeNodes[i].first );
+        int trgTree = findSubtree( subtrees, edgeNodes[i].second );
+
+        // Check if by adding this edge we are going to join two different forests
+        if( srcTree != trgTree )
+        {
+            subtrees[trgTree] = srcTree;
 
             if( ratsnestLines )
             {
                 // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
                 // RN_EDGE_MST saves both source and target node and does not require any other
                 // edges to exist for getting source/target nodes
-                RN_EDGE_MST_PTR newEdge = boost::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
-                                                                           dt->GetTargetNode(),
-                                                                           dt->GetWeight() );
-                mst->push_back( newEdge );
+                mst->push_back( aLinks.CreateEdge( dt->GetSourceNode(), dt->GetTargetNode(),
+                                                   dt->GetWeight() ) );
                 ++mstSize;
             }
             else
@@ -195,13 +219,13 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
                 --mstExpectedSize;
             }
         }
-
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
     }
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst->resize( mstSize );
+    if( !ratsnestLines )
+    {
+        for( unsigned int j = 0; j < nodeNumber; ++j )
+            aNodes[j]->SetTag( findSubtree( subtrees, j ) );
+    }
 
     return mst;
 }
@@ -247,7 +271,7 @@ void RN_NET::validateEdge( RN_EDGE_MST_PTR& aEdge )
 
     // Replace an invalid edge with new, valid one
     if( !valid )
-        aEdge.reset( new RN_EDGE_MST( source, target ) );
+        aEdge = m_links.CreateEdge( source, target );
 }
 
 
@@ -290,12 +314,15 @@ void RN_NET::removeEdge( RN_EDGE_MST_PTR& aEdge, const BOARD_CONNECTED_ITEM* aPa
 
 const RN_NODE_PTR& RN_LINKS::AddNode( int aX, int aY )
 {
-    RN_NODE_SET::iterator node;
-    bool wasNewElement;
+    // Look for an existing node first, so no node is created just to be compared
+    RN_NODE_SET::const_iterator node = m_nodes.find( VECTOR2I( aX, aY ), RN_NODE_HASH(),
+                                                     RN_NODE_POSITION_COMPARE() );
 
-    boost::tie( node, wasNewElement ) = m_nodes.emplace( boost::make_shared<RN_NODE>( aX, aY ) );
+    if( node != m_nodes.end() )
+        return *node;
 
-    return *node;
+    return *m_nodes.insert( boost::allocate_shared<RN_NODE>(
+                hed::POOL_ALLOCATOR<RN_NODE>( GetPool() ), aX, aY ) ).first;
 }
 
 
@@ -316,22 +343,39 @@ RN_EDGE_MST_PTR RN_LINKS::AddConnection( const RN_NODE_PTR& aNode1, const RN_NOD
                                          unsigned int aDistance )
 {
     assert( aNode1 != aNode2 );
-    RN_EDGE_MST_PTR edge = boost::make_shared<RN_EDGE_MST>( aNode1, aNode2, aDistance );
-    m_edges.push_back( edge );
+    RN_EDGE_MST_PTR edge = CreateEdge( aNode1, aNode2, aDistance );
+    m_edges.insert( edge );
 
     return edge;
 }
 
 
-void RN_NET::compute()
+RN_EDGE_MST_PTR RN_LINKS::CreateEdge( const RN_NODE_PTR& aSource, const RN_NODE_PTR& aTarget,
+                                      unsigned int aDistance )
+{
+    return boost::allocate_shared<RN_EDGE_MST>( hed::POOL_ALLOCATOR<RN_EDGE_MST>( GetPool() ),
+                                                aSource, aTarget, aDistance );
+}
+
+
+const hed::POOL_PTR& RN_LINKS::GetPool()
+{
+    if( !m_pool )
+        m_pool.reset( new hed::POOL );
+
+    return m_pool;
+}
+
+
+std::vector<RN_EDGE_MST_PTR>* RN_NET::compute()
 {
     const RN_LINKS::RN_NODE_SET& boardNodes = m_links.GetNodes();
-    const RN_LINKS::RN_EDGE_LIST& boardEdges = m_links.GetConnections();
+    const RN_LINKS::RN_EDGE_SET& boardEdges = m_links.GetConnections();
 
     // Special cases do not need complicated algorithms
     if( boardNodes.size() <= 2 )
     {
-        m_rnEdges.reset( new std::vector<RN_EDGE_MST_PTR>( 0 ) );
+        std::vector<RN_EDGE_MST_PTR>* unconnected = new std::vector<RN_EDGE_MST_PTR>( 0 );
 
         // Check if the only possible connection exists
         if( boardEdges.size() == 0 && boardNodes.size() == 2 )
@@ -339,34 +383,33 @@ void RN_NET::compute()
             RN_LINKS::RN_NODE_SET::iterator last = ++boardNodes.begin();
 
             // There can be only one possible connection, but it is missing
-            m_rnEdges->push_back( boost::make_shared<RN_EDGE_MST>( *boardNodes.begin(), *last ) );
+            unconnected->push_back( m_links.CreateEdge( *boardNodes.begin(), *last ) );
         }
 
         // Set tags to nodes as connected
         BOOST_FOREACH( RN_NODE_PTR node, boardNodes )
             node->SetTag( 0 );
 
-        return;
+        return unconnected;
     }
 
     // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
     std::vector<RN_NODE_PTR> nodes( boardNodes.size() );
     std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), nodes.begin(), nodes.end() );
 
-    TRIANGULATOR triangulator;
+    TRIANGULATOR triangulator( m_links.GetPool() );
     triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
-    boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( triangulator.GetEdges() );
 
-    // Compute weight/distance for edges resulting from triangulation
-    RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
-    for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
-        (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+    // The currently existing connections go first, then the results of triangulation
+    std::vector<RN_EDGE_PTR> edges( boardEdges.begin(), boardEdges.end() );
+    triangulator.GetEdges( edges );
 
-    // Add the currently existing connections list to the results of triangulation
-    std::copy( boardEdges.begin(), boardEdges.end(), std::front_inserter( *triangEdges ) );
+    // Compute weight/distance for edges resulting from triangulation
+    for( unsigned int i = boardEdges.size(); i < edges.size(); ++i )
+        edges[i]->SetWeight( getDistance( edges[i]->GetSourceNode(), edges[i]->GetTargetNode() ) );
 
     // Get the minimal spanning tree
-    m_rnEdges.reset( kruskalMST( *triangEdges, nodes ) );
+    return kruskalMST( edges, nodes, m_links );
 }
 
 
@@ -416,11 +459,14 @@ void RN_NET::Update()
     processZones();
     processPads();
 
-    compute();
+    // The new ratsnest is completed before it replaces the current one, so the current
+    // ratsnest stays valid until the new one is ready to be displayed
+    boost::shared_ptr<std::vector<RN_EDGE_MST_PTR> > unconnected( compute() );
 
-    BOOST_FOREACH( RN_EDGE_MST_PTR& edge, *m_rnEdges )
+    BOOST_FOREACH( RN_EDGE_MST_PTR& edge, *unconnected )
         validateEdge( edge );
 
+    m_rnEdges.swap( unconnected );
     m_dirty = false;
 }
 
@@ -877,14 +923,10 @@ void RN_DATA::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
                                  std::list<BOARD_CONNECTED_ITEM*>& aOutput,
                                  RN_ITEM_TYPE aTypes ) const
 {
-    int net = aItem->GetNetCode();
-
-    if( net < 1 )
+    if( aItem->GetNetCode() < 1 )
         return;
 
-    assert( net < (int) m_nets.size() );
-
-    m_nets[net].GetConnectedItems( aItem, aOutput, aTypes );
+    m_board->GetConnectivity()->GetConnectedItems( aItem, aOutput, aTypes );
 }
 
 
@@ -908,15 +950,8 @@ bool RN_DATA::AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNE
     if( net1 < 1 || net2 < 1 || net1 != net2 )
         return false;
 
-    assert( net1 < (int) m_nets.size() && net2 < (int) m_nets.size() );
-
-    // net1 == net2
-    std::list<RN_NODE_PTR> items1 = m_nets[net1].GetNodes( aItem );
-    std::list<RN_NODE_PTR> items2 = m_nets[net1].GetNodes( aOther );
-
-    assert( !items1.empty() && !items2.empty() );
-
-    return ( items1.front()->GetTag() == items2.front()->GetTag() );
+    // The clusters do not depend on the ratsnest, so the nets do not need to be recalculated
+    return m_board->GetConnectivity()->AreConnected( aItem, aOther );
 }
 
 
@@ -938,6 +973,9 @@ int RN_DATA::GetUnconnectedCount() const
 
 void RN_NET::processZones()
 {
+    // Nodes that are not connected to a zone polygon yet (reused for all zones)
+    std::vector<RN_NODE_PTR> candidates;
+
     for( ZONE_DATA_MAP::iterator it = m_zones.begin(); it != m_zones.end(); ++it )
     {
         const ZONE_CONTAINER* zone = it->first;
@@ -951,8 +989,8 @@ void RN_NET::processZones()
         LSET layers = zone->GetLayerSet();
 
         // Compute new connections
-        RN_LINKS::RN_NODE_SET candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
+        const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
+        candidates.assign( nodes.begin(), nodes.end() );
 
         // Sorting by area should speed up the processing, as smaller polygons are computed
         // faster and may reduce the number of points for further checks
@@ -962,29 +1000,29 @@ void RN_NET::processZones()
                 polyEnd = zoneData.m_Polygons.end(); poly != polyEnd; ++poly )
         {
             const RN_NODE_PTR& node = poly->GetNode();
+            unsigned int kept = 0;
 
-            point = candidates.begin();
-            pointEnd = candidates.end();
-
-            while( point != pointEnd )
+            for( unsigned int i = 0; i < candidates.size(); ++i )
             {
-                if( *point != node && ( (*point)->GetLayers() & layers ).any()
-                        && poly->HitTest( *point ) )
+                const RN_NODE_PTR& point = candidates[i];
+
+                if( point != node && ( point->GetLayers() & layers ).any()
+                        && poly->HitTest( point ) )
                 {
-                    //(*point)->AddParent( zone );  // do not assign parent for helper links
+                    //point->AddParent( zone );  // do not assign parent for helper links
 
-                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
+                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, point );
                     zoneData.m_Edges.push_back( connection );
 
                     // This point already belongs to a polygon, we do not need to check it anymore
-                    point = candidates.erase( point );
-                    pointEnd = candidates.end();
                 }
                 else
                 {
-                    ++point;
+                    candidates[kept++] = point;
                 }
             }
+
+            candidates.resize( kept );
         }
     }
 }
@@ -1002,14 +1040,15 @@ void RN_NET::processPads()
         BOOST_FOREACH( RN_EDGE_MST_PTR edge, edges )
             m_links.RemoveConnection( edge );
 
+        edges.clear();
+
         LSET layers = pad->GetLayerSet();
-        RN_LINKS::RN_NODE_SET candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
 
-        point = candidates.begin();
-        pointEnd = candidates.end();
+        // New connections do not change the set of nodes, so it can be scanned directly
+        const RN_LINKS::RN_NODE_SET& candidates = m_links.GetNodes();
 
-        while( point != pointEnd )
+        for( RN_LINKS::RN_NODE_SET::const_iterator point = candidates.begin();
+                point != candidates.end(); ++point )
         {
             if( *point != node && ( (*point)->GetLayers() & layers ).any() &&
                     pad->HitTest( wxPoint( (*point)->GetX(), (*point)->GetY() ) ) )
@@ -1019,8 +1058,6 @@ void RN_NET::processPads()
                 RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
                 edges.push_back( connection );
             }
-
-            ++point;
         }
     }
 }
@@ -1030,6 +1067,8 @@ void RN_DATA::Add( const BOARD_ITEM* aItem )
 {
     int net;
 
+    m_board->GetConnectivity()->Add( aItem );
+
     if( aItem->IsConnected() )
     {
         net = static_cast<const BOARD_CONNECTED_ITEM*>( aItem )->GetNetCode();
@@ -1088,6 +1127,8 @@ void RN_DATA::Remove( const BOARD_ITEM* aItem )
 {
     int net;
 
+    m_board->GetConnectivity()->Remove( aItem );
+
     if( aItem->IsConnected() )
     {
         net = static_cast<const BOARD_CONNECTED_ITEM*>( aItem )->GetNetCode();
@@ -1167,6 +1208,11 @@ void RN_DATA::Update( const BOARD_ITEM* aItem )
 void RN_DATA::ProcessBoard()
 {
     int netCount = m_board->GetNetCount();
+
+    // Items may have been modified without notice, the connectivity is rebuilt when queried
+    m_board->GetConnectivity()->MarkDirty();
+    m_board->NotifyBoardChanged();
+
     m_nets.clear();
     m_nets.resize( netCount );
     int netCode;
@@ -1225,37 +1271,83 @@ void RN_DATA::Recalculate( int aNet )
 
     if( aNet < 0 && netCount > 1 )              // Recompute everything
     {
+        std::vector<int> dirtyNets;
+
+        // Start with net number 1, as 0 stands for not connected
+        for( unsigned int i = 1; i < netCount; ++i )
+        {
+            if( m_nets[i].IsDirty() )
+                dirtyNets.push_back( i );
+        }
+
+        updateNets( dirtyNets );
+    }
+    else if( aNet > 0 )         // Recompute only specific net
+    {
+        updateNet( aNet );
+    }
+}
+
+
+void RN_DATA::Recalculate( const std::vector<int>& aNets )
+{
+    unsigned int netCount = m_board->GetNetCount();
+
+    if( netCount > m_nets.size() )
+        m_nets.resize( netCount );
+
+    std::vector<int> nets;
+
+    for( unsigned int i = 0; i < aNets.size(); ++i )
+    {
+        if( aNets[i] > 0 && aNets[i] < (int) m_nets.size() )
+            nets.push_back( aNets[i] );
+    }
+
+    // A net may be listed more than once
+    std::sort( nets.begin(), nets.end() );
+    nets.erase( std::unique( nets.begin(), nets.end() ), nets.end() );
+
+    updateNets( nets );
+}
+
+
+void RN_DATA::updateNets( std::vector<int>& aNets )
+{
+    if( aNets.empty() )
+        return;
+
 #ifdef PROFILE
     prof_counter totalRealTime;
     prof_start( &totalRealTime );
 #endif
 
-        unsigned int i;
+    // The computation time grows with the number of nodes and a few big nets (e.g. GND)
+    // usually take most of it. Starting with the biggest nets keeps the threads busy until
+    // the end, instead of having one thread finish a big net while the others are idle.
+    std::sort( aNets.begin(), aNets.end(), boost::bind( &RN_DATA::hasMoreNodes, this, _1, _2 ) );
+
+    int count = aNets.size();
+    int i;
 
+    // Every thread updates different nets, and the nets do not share any data
 #ifdef USE_OPENMP
-        #pragma omp parallel shared(netCount) private(i)
-        {
-            #pragma omp for schedule(guided, 1)
-#else /* USE_OPENMP */
-        {
-#endif
-            // Start with net number 1, as 0 stands for not connected
-            for( i = 1; i < netCount; ++i )
-            {
-                if( m_nets[i].IsDirty() )
-                    updateNet( i );
-            }
-        }  /* end of parallel section */
+    #pragma omp parallel for schedule(dynamic, 1) if( count > 1 )
+#endif /* USE_OPENMP */
+    for( i = 0; i < count; ++i )
+        updateNet( aNets[i] );
+
 #ifdef PROFILE
     prof_end( &totalRealTime );
 
-    wxLogDebug( wxT( "Recalculate all nets: %.1f ms" ), totalRealTime.msecs() );
+    wxLogDebug( wxT( "Recalculate %d nets: %.1f ms" ), count, totalRealTime.msecs() );
 #endif /* PROFILE */
-    }
-    else if( aNet > 0 )         // Recompute only specific net
-    {
-        updateNet( aNet );
-    }
+}
+
+
+bool RN_DATA::hasMoreNodes( int aFirst, int aSecond ) const
+{
+    return m_nets[aFirst].GetNodeCount() > m_nets[aSecond].GetNodeCount();
 }
 
 
@@ -164,21 +164,47 @@ struct RN_NODE_COMPARE : std::binary_function<RN_NODE_PTR, RN_NODE_PTR, bool>
 struct RN_NODE_HASH : std::unary_function<RN_NODE_PTR, std::size_t>
 {
     std::size_t operator()( const RN_NODE_PTR& aNode ) const
+    {
+        return hash( aNode->GetX(), aNode->GetY() );
+    }
+
+    ///> Hash of a position, matching the hash of a node located there.
+    std::size_t operator()( const VECTOR2I& aPosition ) const
+    {
+        return hash( aPosition.x, aPosition.y );
+    }
+
+private:
+    static std::size_t hash( int aX, int aY )
     {
         std::size_t hash = 2166136261u;
 
-        hash ^= aNode->GetX();
+        hash ^= aX;
         hash *= 16777619;
-        hash ^= aNode->GetY();
+        hash ^= aY;
 
         return hash;
     }
 };
 
+///> Functor checking if a node is located at a given position. It is used to look up nodes
+///> without creating a node to compare with.
+struct RN_NODE_POSITION_COMPARE
+{
+    bool operator()( const VECTOR2I& aPosition, const RN_NODE_PTR& aNode ) const
+    {
+        return aNode->GetX() == aPosition.x && aNode->GetY() == aPosition.y;
+    }
+};
+
 
 /**
  * Class RN_LINKS
  * Manages data describing nodes and connections for a given net.
+ *
+ * Nodes and edges are allocated from a memory pool owned by the net, rather than one by one
+ * on the heap. Every allocated object keeps a reference to the pool, so it can safely
+ * outlive the RN_LINKS object.
  */
 class RN_LINKS
 {
@@ -186,6 +212,7 @@ public:
     // Helper typedefs
     typedef boost::unordered_set<RN_NODE_PTR, RN_NODE_HASH, RN_NODE_COMPARE> RN_NODE_SET;
     typedef std::list<RN_EDGE_PTR> RN_EDGE_LIST;
+    typedef boost::unordered_set<RN_EDGE_PTR> RN_EDGE_SET;
 
     /**
      * Function AddNode()
@@ -235,25 +262,45 @@ public:
      */
     void RemoveConnection( const RN_EDGE_PTR& aEdge )
     {
-        m_edges.remove( aEdge );
+        m_edges.erase( aEdge );
     }
 
     /**
      * Function GetConnections()
-     * Returns the list of edges that currently connect nodes.
-     * @return the list of edges that currently connect nodes.
+     * Returns the set of edges that currently connect nodes.
+     * @return the set of edges that currently connect nodes.
      */
-    const RN_EDGE_LIST& GetConnections() const
+    const RN_EDGE_SET& GetConnections() const
     {
         return m_edges;
     }
 
+    /**
+     * Function CreateEdge()
+     * Creates an edge from the pool, without adding it to the connections.
+     * @param aSource is the origin node of the edge.
+     * @param aTarget is the end node of the edge.
+     * @param aDistance is the weight of the edge.
+     */
+    RN_EDGE_MST_PTR CreateEdge( const RN_NODE_PTR& aSource, const RN_NODE_PTR& aTarget,
+                                unsigned int aDistance = 0 );
+
+    /**
+     * Function GetPool()
+     * Returns the memory pool used for the nodes and edges of the net.
+     */
+    const hed::POOL_PTR& GetPool();
+
 protected:
     ///> Set of nodes that are expected to be connected together (vias, tracks, pads).
     RN_NODE_SET m_nodes;
 
-    ///> List of edges that currently connect nodes.
-    RN_EDGE_LIST m_edges;
+    ///> Set of edges that currently connect nodes.
+    RN_EDGE_SET m_edges;
+
+    ///> Memory pool for nodes and edges, created on the first use (so the default RN_NET
+    ///> copied by std::vector::resize() does not share its pool with the new nets)
+    hed::POOL_PTR m_pool;
 };
 
 
@@ -373,6 +420,15 @@ public:
         return m_rnEdges.get();
     }
 
+    /**
+     * Function GetNodeCount()
+     * Returns the number of nodes in the net, which is a measure of the cost of its update.
+     */
+    unsigned int GetNodeCount() const
+    {
+        return m_links.GetNodes().size();
+    }
+
     /**
      * Function Update()
      * Recomputes ratsnest for a net.
@@ -567,8 +623,9 @@ protected:
     ///> Adds additional edges to account for connections made by items located in pads areas.
     void processPads();
 
-    ///> Recomputes ratsnset from scratch.
-    void compute();
+    ///> Computes ratsnest from scratch. The current ratsnest is left untouched, the caller
+    ///> takes the ownership of the returned edges.
+    std::vector<RN_EDGE_MST_PTR>* compute();
 
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
@@ -644,14 +701,14 @@ public:
 
     /**
      * Function Add()
-     * Adds an item to the ratsnest data.
+     * Adds an item to the ratsnest data and to the board connectivity.
      * @param aItem is an item to be added.
      */
     void Add( const BOARD_ITEM* aItem );
 
     /**
      * Function Remove()
-     * Removes an item from the ratsnest data.
+     * Removes an item from the ratsnest data and from the board connectivity.
      * @param aItem is an item to be updated.
      */
     void Remove( const BOARD_ITEM* aItem );
@@ -703,6 +760,15 @@ public:
      */
     void Recalculate( int aNet = -1 );
 
+    /**
+     * Function Recalculate()
+     * Recomputes ratsnest for a list of nets. The nets are updated in parallel (if OpenMP is
+     * enabled) and the function returns once all of them have been updated, so the new
+     * ratsnest is displayed at once.
+     * @param aNets is the list of net numbers to be recomputed.
+     */
+    void Recalculate( const std::vector<int>& aNets );
+
     /**
      * Function GetNetCount()
      * Returns the number of nets handled by the ratsnest.
@@ -749,7 +815,8 @@ public:
 
     /**
      * Function AreConnected()
-     * Checks if two items are connected with copper.
+     * Checks if two items are connected with copper. It uses the clusters of the board
+     * connectivity (CONNECTIVITY_DATA), so the ratsnest does not need to be up to date.
      * @param aThis is the first item.
      * @param aOther is the second item.
      * @return True if they are connected, false otherwise.
@@ -771,6 +838,17 @@ protected:
      */
     void updateNet( int aNetCode );
 
+    /**
+     * Function updateNets()
+     * Recomputes ratsnest for a list of nets, in parallel if OpenMP is enabled.
+     * @param aNets is the list of (valid and unique) net numbers to be recomputed. It is
+     * reordered, so the nets taking the most time are processed first.
+     */
+    void updateNets( std::vector<int>& aNets );
+
+    ///> Returns true if the first net has more nodes than the second one.
+    bool hasMoreNodes( int aFirst, int aSecond ) const;
+
     ///> Board to be processed.
     const BOARD* m_board;
 
@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <set>
+
 #include <boost/foreach.hpp>
 #include <boost/optional.hpp>
 
@@ -39,6 +41,8 @@
 #include "pns_router.h"
 #include "pns_meander_placer.h" // fixme: move settings to separate header
 #include "pns_tune_status_popup.h"
+#include "pns_topology.h"
+#include "pns_batch_tuner.h"
 
 #include "length_tuner_tool.h"
 
@@ -68,6 +72,9 @@ static TOOL_ACTION ACT_AmplIncrease( "pcbnew.LengthTuner.AmplIncrease", AS_CONTE
 static TOOL_ACTION ACT_AmplDecrease( "pcbnew.LengthTuner.AmplDecrease", AS_CONTEXT, '4',
     _( "Decrease amplitude" ), _( "Decrease meander amplitude by one step." ) );
 
+static TOOL_ACTION ACT_TuneNetClass( "pcbnew.LengthTuner.TuneNetClass", AS_CONTEXT, 0,
+    _( "Tune Net Class" ), _( "Tunes all the tracks of the net class of the item under the cursor." ) );
+
 
 LENGTH_TUNER_TOOL::LENGTH_TUNER_TOOL() :
     PNS_TOOL_BASE( "pcbnew.LengthTuner" )
@@ -92,6 +99,10 @@ public:
         Add( ACT_AmplIncrease );
         Add( ACT_AmplDecrease );
         Add( ACT_Settings );
+
+        AppendSeparator();
+
+        Add( ACT_TuneNetClass );
     }
 };
 
@@ -240,6 +251,83 @@ void LENGTH_TUNER_TOOL::performTuning()
 }
 
 
+void LENGTH_TUNER_TOOL::tuneNetClass( PNS_ROUTER_MODE aMode )
+{
+    if( !m_startItem || m_startItem->Net() <= 0 )
+        return;
+
+    NETINFO_ITEM* startNet = m_board->FindNet( m_startItem->Net() );
+
+    if( !startNet )
+        return;
+
+    const wxString& className = startNet->GetClassName();
+    PNS_TOPOLOGY topo( m_router->GetWorld() );
+    PNS_BATCH_TUNER tuner( m_router );
+    std::set<int> coupledNets;
+
+    for( unsigned i = 1; i < m_board->GetNetCount(); i++ )
+    {
+        NETINFO_ITEM* net = m_board->FindNet( i );
+
+        if( !net || net->GetClassName() != className || coupledNets.count( i ) )
+            continue;
+
+        switch( aMode )
+        {
+        case PNS_MODE_TUNE_SINGLE:
+            tuner.AddNet( i, m_savedMeanderSettings.m_targetLength );
+            break;
+
+        case PNS_MODE_TUNE_DIFF_PAIR:
+        case PNS_MODE_TUNE_DIFF_PAIR_SKEW:
+        {
+            int coupled = topo.DpCoupledNet( i );
+
+            // pairs are tuned once, from either of their nets
+            if( coupled < 0 )
+                continue;
+
+            coupledNets.insert( coupled );
+
+            if( aMode == PNS_MODE_TUNE_DIFF_PAIR )
+                tuner.AddDiffPair( i, m_savedMeanderSettings.m_targetLength );
+            else
+                tuner.AddDiffPairSkew( i, m_savedMeanderSettings.m_targetSkew );
+
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    int tuned = tuner.Run( m_savedMeanderSettings );
+
+    // All the nets are restored by a single undo
+    if( m_router->GetUndoBuffer().GetCount() > 0 )
+    {
+        m_frame->SaveCopyInUndoList( m_router->GetUndoBuffer(), UR_UNSPECIFIED );
+        m_router->ClearUndoBuffer();
+        m_frame->OnModify();
+    }
+
+    wxString msg = wxString::Format( _( "%d of %d tracks of net class '%s' tuned." ),
+                                     tuned, (int) tuner.Jobs().size(), GetChars( className ) );
+
+    BOOST_FOREACH( const PNS_BATCH_TUNER::JOB& job, tuner.Jobs() )
+    {
+        if( job.m_status != PNS_MEANDER_PLACER_BASE::TUNED )
+            msg += wxString::Format( wxT( "\n%s: %s" ),
+                                     GetChars( m_board->FindNet( job.m_net )->GetNetname() ),
+                                     GetChars( job.m_info ) );
+    }
+
+    wxMessageBox( msg, _( "Tune Net Class" ) );
+}
+
+
 int LENGTH_TUNER_TOOL::TuneSingleTrace( const TOOL_EVENT& aEvent )
 {
     m_frame->SetToolID( ID_TRACK_BUTT, wxCURSOR_PENCIL, _( "Tune Trace Length" ) );
@@ -296,6 +384,11 @@ int LENGTH_TUNER_TOOL::mainLoop( PNS_ROUTER_MODE aMode )
             updateStartItem( *evt );
             performTuning();
         }
+        else if( evt->IsAction( &ACT_TuneNetClass ) )
+        {
+            updateStartItem( *evt );
+            tuneNetClass( aMode );
+        }
 
         handleCommonEvents( *evt );
     }
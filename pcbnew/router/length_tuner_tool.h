@@ -45,6 +45,7 @@ private:
     int mainLoop( PNS_ROUTER_MODE aMode );
     void handleCommonEvents( const TOOL_EVENT& aEvent );
     void updateStatusPopup ( PNS_TUNE_STATUS_POPUP& aPopup );
+    void tuneNetClass( PNS_ROUTER_MODE aMode );
 
 
 
@@ -0,0 +1,320 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+
+#include <boost/foreach.hpp>
+
+#include <wx/intl.h>
+
+#include "pns_node.h"
+#include "pns_line.h"
+#include "pns_segment.h"
+#include "pns_topology.h"
+#include "pns_batch_tuner.h"
+
+PNS_BATCH_TUNER::PNS_BATCH_TUNER( PNS_ROUTER* aRouter ) :
+    PNS_ALGO_BASE( aRouter )
+{
+}
+
+
+void PNS_BATCH_TUNER::AddNet( int aNet, int aTargetLength )
+{
+    addJob( aNet, PNS_MODE_TUNE_SINGLE, aTargetLength );
+}
+
+
+void PNS_BATCH_TUNER::AddDiffPair( int aNet, int aTargetLength )
+{
+    addJob( aNet, PNS_MODE_TUNE_DIFF_PAIR, aTargetLength );
+}
+
+
+void PNS_BATCH_TUNER::AddDiffPairSkew( int aNet, int aTargetSkew )
+{
+    addJob( aNet, PNS_MODE_TUNE_DIFF_PAIR_SKEW, aTargetSkew );
+}
+
+
+void PNS_BATCH_TUNER::addJob( int aNet, PNS_ROUTER_MODE aMode, int aTarget )
+{
+    JOB job;
+
+    job.m_net = aNet;
+    job.m_mode = aMode;
+    job.m_target = aTarget;
+    job.m_done = false;
+    job.m_status = PNS_MEANDER_PLACER_BASE::TOO_SHORT;
+
+    m_jobs.push_back( job );
+}
+
+
+int PNS_BATCH_TUNER::Run( const PNS_MEANDER_SETTINGS& aSettings )
+{
+    if( Router()->RoutingInProgress() )
+        return 0;
+
+    std::vector<std::vector<int> > sets;
+    int tuned = 0;
+
+    partitionJobs( aSettings, sets );
+
+    // The meanders of a set are committed before the next set starts, so the nets of a bus
+    // make room for each other
+    for( unsigned i = 0; i < sets.size(); i++ )
+        tuned += runSet( sets[i], aSettings );
+
+    return tuned;
+}
+
+
+void PNS_BATCH_TUNER::partitionJobs( const PNS_MEANDER_SETTINGS& aSettings,
+                                     std::vector<std::vector<int> >& aSets )
+{
+    std::vector<std::vector<BOX2I> > setAreas;
+
+    // Greedy partition: each job goes to the first set which has no job in its area,
+    // so the jobs of a set keep their order
+    for( unsigned i = 0; i < m_jobs.size(); i++ )
+    {
+        BOX2I area;
+
+        if( !jobArea( m_jobs[i], aSettings, area ) )
+        {
+            m_jobs[i].m_info = _( "No track to tune." );
+            continue;
+        }
+
+        unsigned set;
+
+        for( set = 0; set < aSets.size(); set++ )
+        {
+            bool interacts = false;
+
+            BOOST_FOREACH( const BOX2I& other, setAreas[set] )
+            {
+                if( other.Intersects( area ) )
+                {
+                    interacts = true;
+                    break;
+                }
+            }
+
+            if( !interacts )
+                break;
+        }
+
+        if( set == aSets.size() )
+        {
+            aSets.push_back( std::vector<int>() );
+            setAreas.push_back( std::vector<BOX2I>() );
+        }
+
+        aSets[set].push_back( i );
+        setAreas[set].push_back( area );
+    }
+}
+
+
+bool PNS_BATCH_TUNER::jobArea( const JOB& aJob, const PNS_MEANDER_SETTINGS& aSettings,
+                               BOX2I& aArea )
+{
+    PNS_NODE* world = Router()->GetWorld();
+    std::set<PNS_ITEM*> items;
+
+    world->AllItemsInNet( aJob.m_net, items );
+
+    if( aJob.m_mode != PNS_MODE_TUNE_SINGLE )
+    {
+        PNS_TOPOLOGY topo( world );
+        int coupled = topo.DpCoupledNet( aJob.m_net );
+
+        if( coupled >= 0 )
+            world->AllItemsInNet( coupled, items );
+    }
+
+    // the meanders may reach the clearance zone of items placed by another job
+    int margin = aSettings.m_maxAmplitude + world->GetMaxClearance();
+    bool found = false;
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
+    {
+        if( !item->Shape() )
+            continue;
+
+        BOX2I bbox = item->Shape()->BBox( margin );
+
+        if( found )
+            aArea.Merge( bbox );
+        else
+            aArea = bbox;
+
+        found = true;
+    }
+
+    return found;
+}
+
+
+int PNS_BATCH_TUNER::runSet( const std::vector<int>& aSet, const PNS_MEANDER_SETTINGS& aSettings )
+{
+    std::vector<PNS_MEANDER_PLACER_BASE*> placers( aSet.size(), (PNS_MEANDER_PLACER_BASE*) NULL );
+    std::vector<VECTOR2I> ends( aSet.size() );
+    int tuned = 0;
+
+    // Placers branch the world when they start, which cannot be done concurrently
+    for( unsigned i = 0; i < aSet.size(); i++ )
+        placers[i] = startJob( m_jobs[aSet[i]], aSettings, ends[i] );
+
+    // The jobs of a set do not interact and each placer works in its own branch of the world,
+    // which is only read, so the meanders are computed in parallel
+    Router()->EnableDebugGraphics( false );
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif /* USE_OPENMP */
+    for( int i = 0; i < (int) aSet.size(); i++ )
+    {
+        // the meanders are placed along the whole line, from its start to its end
+        if( placers[i] )
+            placers[i]->Move( ends[i], NULL );
+    }
+
+    Router()->EnableDebugGraphics( true );
+
+    // Committing a branch releases the other branches of the world, so the changes of all
+    // the placers are gathered in a single branch and committed together
+    PNS_NODE* changes = Router()->GetWorld()->Branch();
+    bool modified = false;
+
+    for( unsigned i = 0; i < aSet.size(); i++ )
+    {
+        JOB& job = m_jobs[aSet[i]];
+        PNS_MEANDER_PLACER_BASE* placer = placers[i];
+
+        if( !placer )
+            continue;
+
+        job.m_status = placer->TuningStatus();
+        job.m_info = placer->TuningInfo();
+        job.m_done = placer->AddTunedLines();
+
+        if( job.m_done )
+        {
+            PNS_NODE::ITEM_VECTOR removed, added;
+
+            placer->CurrentNode()->GetUpdatedItems( removed, added );
+
+            BOOST_FOREACH( PNS_ITEM* item, removed )
+                changes->Remove( item );
+
+            BOOST_FOREACH( PNS_ITEM* item, added )
+                changes->Add( item->Clone() );
+
+            modified = true;
+
+            if( job.m_status == PNS_MEANDER_PLACER_BASE::TUNED )
+                tuned++;
+        }
+    }
+
+    if( modified )
+        Router()->CommitRouting( changes );
+    else
+        Router()->GetWorld()->KillChildren();
+
+    // the branches of the placers have been released with the other children of the world
+    for( unsigned i = 0; i < aSet.size(); i++ )
+        delete placers[i];
+
+    return tuned;
+}
+
+
+PNS_SEGMENT* PNS_BATCH_TUNER::longestLine( int aNet, PNS_LINE& aLine )
+{
+    PNS_NODE* world = Router()->GetWorld();
+    std::set<PNS_ITEM*> items, visited;
+    PNS_SEGMENT* longest = NULL;
+    int maxLength = -1;
+
+    world->AllItemsInNet( aNet, items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
+    {
+        if( !item->OfKind( PNS_ITEM::SEGMENT ) || visited.count( item ) )
+            continue;
+
+        PNS_LINE line = world->AssembleLine( static_cast<PNS_SEGMENT*>( item ) );
+
+        BOOST_FOREACH( PNS_SEGMENT* seg, *line.LinkedSegments() )
+            visited.insert( seg );
+
+        int length = line.CLine().Length();
+
+        if( length > maxLength )
+        {
+            maxLength = length;
+            aLine = line;
+            longest = line.GetLink( 0 );
+        }
+    }
+
+    return longest;
+}
+
+
+PNS_MEANDER_PLACER_BASE* PNS_BATCH_TUNER::startJob( JOB& aJob,
+                                                    const PNS_MEANDER_SETTINGS& aSettings,
+                                                    VECTOR2I& aEnd )
+{
+    PNS_LINE line;
+    PNS_SEGMENT* seg = longestLine( aJob.m_net, line );
+
+    if( !seg )
+    {
+        aJob.m_info = _( "No track to tune." );
+        return NULL;
+    }
+
+    PNS_MEANDER_SETTINGS settings( aSettings );
+
+    if( aJob.m_mode == PNS_MODE_TUNE_DIFF_PAIR_SKEW )
+        settings.m_targetSkew = aJob.m_target;
+    else
+        settings.m_targetLength = aJob.m_target;
+
+    PNS_MEANDER_PLACER_BASE* placer = static_cast<PNS_MEANDER_PLACER_BASE*>(
+            Router()->CreatePlacer( aJob.m_mode, seg->Layers().Start() ) );
+
+    if( !placer->Start( line.CPoint( 0 ), seg ) )
+    {
+        aJob.m_info = Router()->FailureReason();
+        delete placer;
+        return NULL;
+    }
+
+    placer->UpdateSettings( settings );
+    aEnd = line.CPoint( -1 );
+
+    return placer;
+}
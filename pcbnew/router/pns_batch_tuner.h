@@ -0,0 +1,118 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_BATCH_TUNER_H
+#define __PNS_BATCH_TUNER_H
+
+#include <vector>
+
+#include <wx/string.h>
+
+#include "pns_algo_base.h"
+#include "pns_router.h"
+#include "pns_meander.h"
+#include "pns_meander_placer_base.h"
+
+class PNS_LINE;
+class PNS_SEGMENT;
+
+/**
+ * Class PNS_BATCH_TUNER
+ *
+ * Tunes the length of a set of nets or differential pairs without user interaction
+ * (e.g. to length-match a memory bus). Each net is tuned by the meander placers, as in
+ * the length tuner tool, along its longest line. The changes of all the nets are left in
+ * the router undo buffer, so that they can be saved as a single undo step.
+ *
+ * Jobs whose meanders cannot reach each other are run in parallel: the jobs are split into
+ * sets of non-interacting jobs, the meanders of a set are computed concurrently (each placer
+ * works in its own branch of the world) and committed together. The sets are run one after
+ * another, so the meanders of a set are obstacles for the next ones.
+ */
+class PNS_BATCH_TUNER : public PNS_ALGO_BASE
+{
+public:
+    struct JOB
+    {
+        ///> net to be tuned (any of the two nets of a differential pair)
+        int m_net;
+
+        ///> PNS_MODE_TUNE_SINGLE, PNS_MODE_TUNE_DIFF_PAIR or PNS_MODE_TUNE_DIFF_PAIR_SKEW
+        PNS_ROUTER_MODE m_mode;
+
+        ///> length to be reached (or skew, for PNS_MODE_TUNE_DIFF_PAIR_SKEW)
+        int m_target;
+
+        ///> true if the meanders have been committed
+        bool m_done;
+
+        ///> result of the tuning, valid if m_done is set
+        PNS_MEANDER_PLACER_BASE::TUNING_STATUS m_status;
+
+        ///> tuning status or failure reason, to be shown to the user
+        wxString m_info;
+    };
+
+    PNS_BATCH_TUNER( PNS_ROUTER* aRouter );
+
+    void AddNet( int aNet, int aTargetLength );
+    void AddDiffPair( int aNet, int aTargetLength );
+    void AddDiffPairSkew( int aNet, int aTargetSkew );
+
+    /**
+     * Function Run()
+     * tunes the nets. The router must be idle.
+     * @param aSettings are the meandering settings, except for the target length and skew,
+     * which are taken from the jobs.
+     * @return the number of nets (or pairs) tuned to their target.
+     */
+    int Run( const PNS_MEANDER_SETTINGS& aSettings );
+
+    const std::vector<JOB>& Jobs() const
+    {
+        return m_jobs;
+    }
+
+private:
+    void addJob( int aNet, PNS_ROUTER_MODE aMode, int aTarget );
+
+    ///> Splits the jobs into sets of jobs whose meanders cannot interact (lists of job indices).
+    void partitionJobs( const PNS_MEANDER_SETTINGS& aSettings,
+                        std::vector<std::vector<int> >& aSets );
+
+    ///> Returns the area which can be modified by a job (its nets, enlarged by the meanders
+    ///> amplitude and the clearance). Returns false if the job has no item.
+    bool jobArea( const JOB& aJob, const PNS_MEANDER_SETTINGS& aSettings, BOX2I& aArea );
+
+    ///> Runs a set of non-interacting jobs, returns the number of nets tuned to their target.
+    int runSet( const std::vector<int>& aSet, const PNS_MEANDER_SETTINGS& aSettings );
+
+    ///> Creates and starts the placer of a job, returns NULL on failure. aEnd is set to
+    ///> the end of the tuned line.
+    PNS_MEANDER_PLACER_BASE* startJob( JOB& aJob, const PNS_MEANDER_SETTINGS& aSettings,
+                                       VECTOR2I& aEnd );
+
+    ///> Finds the longest line of a net in the world, returns its first segment (or NULL).
+    PNS_SEGMENT* longestLine( int aNet, PNS_LINE& aLine );
+
+    std::vector<JOB> m_jobs;
+};
+
+#endif    // __PNS_BATCH_TUNER_H
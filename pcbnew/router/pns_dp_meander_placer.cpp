@@ -306,14 +306,26 @@ bool PNS_DP_MEANDER_PLACER::Move( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 
 bool PNS_DP_MEANDER_PLACER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
+    if( !AddTunedLines() )
+        return false;
+
+    Router()->CommitRouting( m_currentNode );
+
+    return true;
+}
+
+
+bool PNS_DP_MEANDER_PLACER::AddTunedLines()
+{
+    if( !m_currentNode )
+        return false;
+
     PNS_LINE lP( m_originPair.PLine(), m_finalShapeP );
     PNS_LINE lN( m_originPair.NLine(), m_finalShapeN );
 
     m_currentNode->Add( &lP );
     m_currentNode->Add( &lN );
 
-    Router()->CommitRouting( m_currentNode );
-
     return true;
 }
 
@@ -79,6 +79,9 @@ public:
      */
     bool FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem );
 
+    /// @copydoc PNS_MEANDER_PLACER_BASE::AddTunedLines()
+    bool AddTunedLines();
+
     const PNS_LINE Trace() const;
 
     /**
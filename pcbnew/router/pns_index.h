@@ -23,14 +23,24 @@
 
 #include <layers_id_colors_and_visibility.h>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <climits>
 
 #include <boost/foreach.hpp>
 #include <boost/range/adaptor/map.hpp>
+#include <boost/unordered_map.hpp>
 
-#include <list>
-#include <geometry/shape_index.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <geometry/rtree.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_segment.h>
 
 #include "pns_item.h"
+#include "pns_line.h"
 
 /**
  * Class PNS_INDEX
@@ -38,12 +48,18 @@
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * The R-Trees only give the candidates whose bounding box is close to the bounding box of the
+ * searched shape. For line chains (the lines being shoved or walked around), that box is often
+ * much larger than the chain itself, so the candidates are also checked against the boxes of
+ * the chain segments before being handed to the visitor (which runs the exact collision test).
+ * For a single segment (the shove and walkaround algorithms search one segment of a line at a
+ * time), the candidates are checked against the segment itself.
  **/
 class PNS_INDEX
 {
 public:
-    typedef std::list<PNS_ITEM*>            NET_ITEMS_LIST;
-    typedef SHAPE_INDEX<PNS_ITEM*>          ITEM_SHAPE_INDEX;
+    typedef std::vector<PNS_ITEM*>          NET_ITEMS_LIST;
     typedef boost::unordered_set<PNS_ITEM*> ITEM_SET;
 
     PNS_INDEX();
@@ -145,22 +161,323 @@ private:
     static const int    SI_PadsTop      = 0;
     static const int    SI_PadsBottom   = 1;
 
+    ///> Bounding box of an indexed item
+    struct ITEM_BOX
+    {
+        int m_minX, m_minY, m_maxX, m_maxY;
+    };
+
+    /**
+     * Struct QUERY_BOXES
+     *
+     * Bounding boxes of the parts of a searched shape, inflated by the search distance. The
+     * boxes are packed by coordinate (and padded to a multiple of 4 with empty boxes), so that
+     * a candidate is checked against 4 of them at a time.
+     */
+    struct QUERY_BOXES
+    {
+        static const int MaxBoxes = 16;
+
+        QUERY_BOXES( const SHAPE* aShape, int aMinDistance );
+
+        ///> Returns true if aBox overlaps any of the query boxes.
+        bool Overlaps( const ITEM_BOX& aBox ) const;
+
+        ///> Returns true if aBox may be closer to m_seg than m_segDistance.
+        bool NearSegment( const ITEM_BOX& aBox ) const;
+
+        ///> Bounding box of all the query boxes, searched in the R-Trees
+        ITEM_BOX m_bbox;
+
+        ///> number of query boxes, not counting the padding ones
+        int m_count;
+
+        ///> true if the searched shape is a single segment (m_count is 1 then)
+        bool m_isSegment;
+
+        ///> the searched segment and the distance of the candidates to its centerline
+        SEG m_seg;
+        int m_segDistance;
+
+        int m_minX[MaxBoxes];
+        int m_minY[MaxBoxes];
+        int m_maxX[MaxBoxes];
+        int m_maxY[MaxBoxes];
+    };
+
+    /**
+     * Class SUBINDEX
+     *
+     * A single R-Tree of the index. The tree stores slot numbers, the items and their
+     * bounding boxes are kept in arrays indexed by slot (the slots of the removed items
+     * are reused by the next added ones). The slot numbers are pointer sized, because
+     * RTree keeps its data in a union with the child node pointers.
+     */
+    class SUBINDEX
+    {
+    public:
+        void Add( PNS_ITEM* aItem );
+        void Remove( PNS_ITEM* aItem );
+
+        template <class Visitor>
+        int Query( const QUERY_BOXES& aBoxes, Visitor& aVisitor );
+
+    private:
+        template <class Visitor>
+        struct SLOT_VISITOR
+        {
+            SLOT_VISITOR( const SUBINDEX& aIndex, const QUERY_BOXES& aBoxes, Visitor& aVisitor ) :
+                m_index( aIndex ), m_boxes( aBoxes ), m_visitor( aVisitor )
+            {}
+
+            bool operator()( size_t aSlot )
+            {
+                // with a single box, the R-Tree has already compared the bounding boxes
+                if( m_boxes.m_count > 1 )
+                {
+                    if( !m_boxes.Overlaps( m_index.m_boxes[aSlot] ) )
+                        return true;
+                }
+                else if( m_boxes.m_isSegment && !m_boxes.NearSegment( m_index.m_boxes[aSlot] ) )
+                {
+                    return true;
+                }
+
+                return m_visitor( m_index.m_items[aSlot] );
+            }
+
+            const SUBINDEX& m_index;
+            const QUERY_BOXES& m_boxes;
+            Visitor& m_visitor;
+        };
+
+        RTree<size_t, int, 2, float> m_tree;
+        std::vector<PNS_ITEM*> m_items;
+        std::vector<ITEM_BOX> m_boxes;
+        std::vector<size_t> m_freeSlots;
+        boost::unordered_map<PNS_ITEM*, size_t> m_slots;
+    };
+
     template <class Visitor>
-    int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
+    int querySingle( int index, const QUERY_BOXES& aBoxes, Visitor& aVisitor );
 
-    ITEM_SHAPE_INDEX* getSubindex( const PNS_ITEM* aItem );
+    SUBINDEX* getSubindex( const PNS_ITEM* aItem );
 
-    ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
+    SUBINDEX* m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
 };
 
+PNS_INDEX::QUERY_BOXES::QUERY_BOXES( const SHAPE* aShape, int aMinDistance )
+{
+    const SHAPE_LINE_CHAIN* chain = NULL;
+    int n = 0;
+
+    m_isSegment = false;
+    m_segDistance = aMinDistance;
+
+    if( aShape->Type() == SH_LINE_CHAIN )
+    {
+        chain = static_cast<const SHAPE_LINE_CHAIN*>( aShape );
+        n = chain->SegmentCount();
+
+        if( n == 1 )
+        {
+            m_isSegment = true;
+            m_seg = chain->CSegment( 0 );
+        }
+    }
+    else if( aShape->Type() == SH_SEGMENT )
+    {
+        const SHAPE_SEGMENT* segment = static_cast<const SHAPE_SEGMENT*>( aShape );
+
+        m_isSegment = true;
+        m_seg = segment->GetSeg();
+        m_segDistance += segment->GetWidth() / 2;
+    }
+
+    if( n > 1 )
+    {
+        // long chains are split in groups of consecutive segments
+        m_count = std::min( n, (int) MaxBoxes );
+
+        for( int i = 0; i < m_count; i++ )
+        {
+            int first = i * n / m_count;
+            int last = ( i + 1 ) * n / m_count;
+            const SEG s0 = chain->CSegment( first );
+
+            m_minX[i] = std::min( s0.A.x, s0.B.x );
+            m_minY[i] = std::min( s0.A.y, s0.B.y );
+            m_maxX[i] = std::max( s0.A.x, s0.B.x );
+            m_maxY[i] = std::max( s0.A.y, s0.B.y );
+
+            for( int j = first + 1; j < last; j++ )
+            {
+                const VECTOR2I& p = chain->CSegment( j ).B;
+
+                m_minX[i] = std::min( m_minX[i], p.x );
+                m_minY[i] = std::min( m_minY[i], p.y );
+                m_maxX[i] = std::max( m_maxX[i], p.x );
+                m_maxY[i] = std::max( m_maxY[i], p.y );
+            }
+        }
+    }
+    else
+    {
+        const BOX2I box = aShape->BBox();
+
+        m_count = 1;
+        m_minX[0] = box.GetX();
+        m_minY[0] = box.GetY();
+        m_maxX[0] = box.GetRight();
+        m_maxY[0] = box.GetBottom();
+    }
+
+    m_bbox.m_minX = m_bbox.m_minY = INT_MAX;
+    m_bbox.m_maxX = m_bbox.m_maxY = INT_MIN;
+
+    for( int i = 0; i < m_count; i++ )
+    {
+        m_minX[i] -= aMinDistance;
+        m_minY[i] -= aMinDistance;
+        m_maxX[i] += aMinDistance;
+        m_maxY[i] += aMinDistance;
+
+        m_bbox.m_minX = std::min( m_bbox.m_minX, m_minX[i] );
+        m_bbox.m_minY = std::min( m_bbox.m_minY, m_minY[i] );
+        m_bbox.m_maxX = std::max( m_bbox.m_maxX, m_maxX[i] );
+        m_bbox.m_maxY = std::max( m_bbox.m_maxY, m_maxY[i] );
+    }
+
+    // the padding boxes never overlap anything
+    for( int i = m_count; i < MaxBoxes; i++ )
+    {
+        m_minX[i] = m_minY[i] = INT_MAX;
+        m_maxX[i] = m_maxY[i] = INT_MIN;
+    }
+}
+
+bool PNS_INDEX::QUERY_BOXES::Overlaps( const ITEM_BOX& aBox ) const
+{
+#ifdef __SSE2__
+    const __m128i minX = _mm_set1_epi32( aBox.m_minX );
+    const __m128i minY = _mm_set1_epi32( aBox.m_minY );
+    const __m128i maxX = _mm_set1_epi32( aBox.m_maxX );
+    const __m128i maxY = _mm_set1_epi32( aBox.m_maxY );
+
+    for( int i = 0; i < m_count; i += 4 )
+    {
+        __m128i apartX = _mm_or_si128(
+                _mm_cmpgt_epi32( minX, _mm_loadu_si128( (const __m128i*) &m_maxX[i] ) ),
+                _mm_cmpgt_epi32( _mm_loadu_si128( (const __m128i*) &m_minX[i] ), maxX ) );
+        __m128i apartY = _mm_or_si128(
+                _mm_cmpgt_epi32( minY, _mm_loadu_si128( (const __m128i*) &m_maxY[i] ) ),
+                _mm_cmpgt_epi32( _mm_loadu_si128( (const __m128i*) &m_minY[i] ), maxY ) );
+
+        if( _mm_movemask_epi8( _mm_or_si128( apartX, apartY ) ) != 0xffff )
+            return true;
+    }
+#else
+    for( int i = 0; i < m_count; i++ )
+    {
+        if( aBox.m_minX <= m_maxX[i] && aBox.m_maxX >= m_minX[i] &&
+            aBox.m_minY <= m_maxY[i] && aBox.m_maxY >= m_minY[i] )
+            return true;
+    }
+#endif
+
+    return false;
+}
+
+bool PNS_INDEX::QUERY_BOXES::NearSegment( const ITEM_BOX& aBox ) const
+{
+    typedef VECTOR2I::extended_type ecoord;
+
+    // The R-Tree has already checked aBox against the bounding box of the segment, the only
+    // axis left to separate them is the normal of the segment. The box is inflated by the
+    // search distance on both axes, which keeps every item that may be closer than that.
+    const ecoord nx = -( m_seg.B.y - m_seg.A.y );
+    const ecoord ny = m_seg.B.x - m_seg.A.x;
+    const ecoord x0 = (ecoord) aBox.m_minX - m_seg.A.x;
+    const ecoord x1 = (ecoord) aBox.m_maxX - m_seg.A.x;
+    const ecoord y0 = (ecoord) aBox.m_minY - m_seg.A.y;
+    const ecoord y1 = (ecoord) aBox.m_maxY - m_seg.A.y;
+
+    const ecoord lo = nx * ( nx > 0 ? x0 : x1 ) + ny * ( ny > 0 ? y0 : y1 );
+    const ecoord hi = nx * ( nx > 0 ? x1 : x0 ) + ny * ( ny > 0 ? y1 : y0 );
+    const ecoord margin = m_segDistance * ( ( nx < 0 ? -nx : nx ) + ( ny < 0 ? -ny : ny ) );
+
+    return lo <= margin && hi >= -margin;
+}
+
+void PNS_INDEX::SUBINDEX::Add( PNS_ITEM* aItem )
+{
+    const BOX2I bbox = aItem->Shape()->BBox();
+    ITEM_BOX box;
+    size_t slot;
+
+    box.m_minX = bbox.GetX();
+    box.m_minY = bbox.GetY();
+    box.m_maxX = bbox.GetRight();
+    box.m_maxY = bbox.GetBottom();
+
+    if( m_freeSlots.empty() )
+    {
+        slot = m_items.size();
+        m_items.push_back( aItem );
+        m_boxes.push_back( box );
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_items[slot] = aItem;
+        m_boxes[slot] = box;
+    }
+
+    m_slots[aItem] = slot;
+
+    int min[2] = { box.m_minX, box.m_minY };
+    int max[2] = { box.m_maxX, box.m_maxY };
+
+    m_tree.Insert( min, max, slot );
+}
+
+void PNS_INDEX::SUBINDEX::Remove( PNS_ITEM* aItem )
+{
+    boost::unordered_map<PNS_ITEM*, size_t>::iterator i = m_slots.find( aItem );
+
+    if( i == m_slots.end() )
+        return;
+
+    size_t slot = i->second;
+    const ITEM_BOX& box = m_boxes[slot];
+    int min[2] = { box.m_minX, box.m_minY };
+    int max[2] = { box.m_maxX, box.m_maxY };
+
+    m_tree.Remove( min, max, slot );
+    m_slots.erase( i );
+    m_items[slot] = NULL;
+    m_freeSlots.push_back( slot );
+}
+
+template <class Visitor>
+int PNS_INDEX::SUBINDEX::Query( const QUERY_BOXES& aBoxes, Visitor& aVisitor )
+{
+    int min[2] = { aBoxes.m_bbox.m_minX, aBoxes.m_bbox.m_minY };
+    int max[2] = { aBoxes.m_bbox.m_maxX, aBoxes.m_bbox.m_maxY };
+    SLOT_VISITOR<Visitor> visitor( *this, aBoxes, aVisitor );
+
+    return m_tree.Search( min, max, visitor );
+}
+
 PNS_INDEX::PNS_INDEX()
 {
     memset( m_subIndices, 0, sizeof( m_subIndices ) );
 }
 
-PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
+PNS_INDEX::SUBINDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
 {
     int idx_n = -1;
 
@@ -195,14 +512,14 @@ PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
     assert( idx_n >= 0 && idx_n < MaxSubIndices );
 
     if( !m_subIndices[idx_n] )
-        m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
+        m_subIndices[idx_n] = new SUBINDEX;
 
     return m_subIndices[idx_n];
 }
 
 void PNS_INDEX::Add( PNS_ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    SUBINDEX* idx = getSubindex( aItem );
 
     idx->Add( aItem );
     m_allItems.insert( aItem );
@@ -216,7 +533,7 @@ void PNS_INDEX::Add( PNS_ITEM* aItem )
 
 void PNS_INDEX::Remove( PNS_ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    SUBINDEX* idx = getSubindex( aItem );
 
     idx->Remove( aItem );
     m_allItems.erase( aItem );
@@ -224,7 +541,17 @@ void PNS_INDEX::Remove( PNS_ITEM* aItem )
     int net = aItem->Net();
 
     if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    {
+        // the order of the items of a net doesn't matter
+        NET_ITEMS_LIST& items = m_netMap[net];
+        NET_ITEMS_LIST::iterator i = std::find( items.begin(), items.end(), aItem );
+
+        if( i != items.end() )
+        {
+            *i = items.back();
+            items.pop_back();
+        }
+    }
 }
 
 void PNS_INDEX::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
@@ -234,42 +561,48 @@ void PNS_INDEX::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
 }
 
 template<class Visitor>
-int PNS_INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+int PNS_INDEX::querySingle( int index, const QUERY_BOXES& aBoxes, Visitor& aVisitor )
 {
     if( !m_subIndices[index] )
         return 0;
 
-    return m_subIndices[index]->Query( aShape, aMinDistance, aVisitor, false );
+    return m_subIndices[index]->Query( aBoxes, aVisitor );
 }
 
 template<class Visitor>
 int PNS_INDEX::Query( const PNS_ITEM* aItem, int aMinDistance, Visitor& aVisitor )
 {
-    const SHAPE* shape = aItem->Shape();
+    int distance = aMinDistance;
+
+    // the shape of a line is its centerline
+    if( aItem->Kind() == PNS_ITEM::LINE )
+        distance += static_cast<const PNS_LINE*>( aItem )->Width() / 2;
+
+    const QUERY_BOXES boxes( aItem->Shape(), distance );
     int total = 0;
 
-    total += querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
+    total += querySingle( SI_Multilayer, boxes, aVisitor );
 
     const PNS_LAYERSET layers = aItem->Layers();
 
     if( layers.IsMultilayer() )
     {
-        total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+        total += querySingle( SI_PadsTop, boxes, aVisitor );
+        total += querySingle( SI_PadsBottom, boxes, aVisitor );
 
         for( int i = layers.Start(); i <= layers.End(); ++i )
-            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, boxes, aVisitor );
     }
     else
     {
         int l = layers.Start();
 
         if( l == B_Cu )
-            total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_PadsTop, boxes, aVisitor );
         else if( l == F_Cu )
-            total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_PadsBottom, boxes, aVisitor );
 
-        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, shape, aMinDistance, aVisitor );
+        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, boxes, aVisitor );
     }
 
     return total;
@@ -278,10 +611,11 @@ int PNS_INDEX::Query( const PNS_ITEM* aItem, int aMinDistance, Visitor& aVisitor
 template<class Visitor>
 int PNS_INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 {
+    const QUERY_BOXES boxes( aShape, aMinDistance );
     int total = 0;
 
     for( int i = 0; i < MaxSubIndices; i++ )
-        total += querySingle( i, aShape, aMinDistance, aVisitor );
+        total += querySingle( i, boxes, aVisitor );
 
     return total;
 }
@@ -290,7 +624,7 @@ void PNS_INDEX::Clear()
 {
     for( int i = 0; i < MaxSubIndices; ++i )
     {
-        ITEM_SHAPE_INDEX* idx = m_subIndices[i];
+        SUBINDEX* idx = m_subIndices[i];
 
         if( idx )
             delete idx;
@@ -19,6 +19,7 @@
  */
 
 #include "pns_item.h"
+#include "pns_item_pool.h"
 #include "pns_line.h"
 
 bool PNS_ITEM::collideSimple( const PNS_ITEM* aOther, int aClearance, bool aNeedMTV,
@@ -85,3 +86,15 @@ const std::string PNS_ITEM::KindStr() const
 PNS_ITEM::~PNS_ITEM()
 {
 }
+
+
+void* PNS_ITEM::operator new( std::size_t aSize )
+{
+    return PNS_ITEM_POOL::Instance().Allocate( aSize );
+}
+
+
+void PNS_ITEM::operator delete( void* aBlock, std::size_t aSize )
+{
+    PNS_ITEM_POOL::Instance().Free( aBlock, aSize );
+}
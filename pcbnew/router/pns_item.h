@@ -89,6 +89,15 @@ public:
 
     virtual ~PNS_ITEM();
 
+    /**
+     * Operators new/delete
+     *
+     * Items are cloned and dropped all the time while routing, so they are allocated
+     * from a pool of recycled memory blocks instead of the heap (see PNS_ITEM_POOL).
+     */
+    static void* operator new( std::size_t aSize );
+    static void operator delete( void* aBlock, std::size_t aSize );
+
     /**
      * Function Clone()
      *
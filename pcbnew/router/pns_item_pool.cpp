@@ -0,0 +1,109 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <cstdlib>
+
+#include "pns_item_pool.h"
+
+long long PNS_ITEM_POOL::HEAP_ALLOCATOR::m_count = 0;
+
+
+char* PNS_ITEM_POOL::HEAP_ALLOCATOR::malloc( const size_type aBytes )
+{
+    m_count++;
+    return static_cast<char*>( std::malloc( aBytes ) );
+}
+
+
+void PNS_ITEM_POOL::HEAP_ALLOCATOR::free( char* const aBlock )
+{
+    std::free( aBlock );
+}
+
+
+PNS_ITEM_POOL& PNS_ITEM_POOL::Instance()
+{
+    // never destroyed: items may be freed by static objects (e.g. the tools) at exit
+    static PNS_ITEM_POOL* pool = new PNS_ITEM_POOL;
+
+    return *pool;
+}
+
+
+PNS_ITEM_POOL::PNS_ITEM_POOL()
+{
+    m_stats.m_allocations = 0;
+    m_stats.m_liveBlocks = 0;
+    m_stats.m_heapAllocations = 0;
+}
+
+
+void* PNS_ITEM_POOL::Allocate( std::size_t aSize )
+{
+    MUTLOCK lock( m_lock );
+
+    void* block = getPool( aSize ).malloc();
+
+    if( !block )
+        throw std::bad_alloc();
+
+    m_stats.m_allocations++;
+    m_stats.m_liveBlocks++;
+
+    return block;
+}
+
+
+void PNS_ITEM_POOL::Free( void* aBlock, std::size_t aSize )
+{
+    if( !aBlock )
+        return;
+
+    MUTLOCK lock( m_lock );
+
+    getPool( aSize ).free( aBlock );
+    m_stats.m_liveBlocks--;
+}
+
+
+const PNS_ITEM_POOL::STATS PNS_ITEM_POOL::Stats()
+{
+    MUTLOCK lock( m_lock );
+
+    m_stats.m_heapAllocations = HEAP_ALLOCATOR::m_count;
+
+    return m_stats;
+}
+
+
+PNS_ITEM_POOL::BLOCK_POOL& PNS_ITEM_POOL::getPool( std::size_t aSize )
+{
+    // There are only a few item classes, a linear search is fine
+    for( unsigned i = 0; i < m_pools.size(); ++i )
+    {
+        if( m_pools[i].first == aSize )
+            return *m_pools[i].second;
+    }
+
+    m_pools.push_back( std::make_pair( aSize, new BLOCK_POOL( aSize, CHUNK_BLOCKS ) ) );
+
+    return *m_pools.back().second;
+}
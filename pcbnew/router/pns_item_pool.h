@@ -0,0 +1,94 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_ITEM_POOL_H
+#define __PNS_ITEM_POOL_H
+
+#include <vector>
+#include <utility>
+
+#include <boost/pool/pool.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <ki_mutex.h>
+
+/**
+ * Class PNS_ITEM_POOL
+ *
+ * Memory blocks for the router items (segments, vias, lines...). Every mouse move makes the
+ * placer, the shove and the walkaround clone dozens of items, that are dropped a moment later
+ * with the branch they live in. The blocks are taken from large chunks and recycled through
+ * free lists, so a routing step does not go through the heap at all once the pool is warm.
+ *
+ * The pool is shared by all the items (see PNS_ITEM::operator new) and is thread safe.
+ */
+class PNS_ITEM_POOL : public boost::noncopyable
+{
+public:
+    ///> Allocation counters, for profiling the routing steps.
+    struct STATS
+    {
+        ///> number of blocks handed out since the pool creation
+        long long m_allocations;
+
+        ///> number of blocks in use
+        long long m_liveBlocks;
+
+        ///> number of chunks taken from the heap since the pool creation
+        long long m_heapAllocations;
+    };
+
+    static PNS_ITEM_POOL& Instance();
+
+    void* Allocate( std::size_t aSize );
+    void Free( void* aBlock, std::size_t aSize );
+
+    const STATS Stats();
+
+private:
+    PNS_ITEM_POOL();
+
+    ///> Counts the chunks taken from the heap by the pools.
+    struct HEAP_ALLOCATOR
+    {
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        static char* malloc( const size_type aBytes );
+        static void free( char* const aBlock );
+
+        static long long m_count;
+    };
+
+    typedef boost::pool<HEAP_ALLOCATOR> BLOCK_POOL;
+
+    ///> Number of blocks allocated at once, when a pool runs out of free blocks
+    static const std::size_t CHUNK_BLOCKS = 256;
+
+    BLOCK_POOL& getPool( std::size_t aSize );
+
+    ///> Pools of blocks, by block size (one per item class)
+    std::vector<std::pair<std::size_t, BLOCK_POOL*> > m_pools;
+
+    MUTEX m_lock;
+    STATS m_stats;
+};
+
+#endif
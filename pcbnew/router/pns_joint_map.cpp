@@ -0,0 +1,228 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "pns_joint_map.h"
+
+PNS_JOINT_MAP::PNS_JOINT_MAP() :
+    m_count( 0 )
+{
+}
+
+
+unsigned int PNS_JOINT_MAP::hash( const HASH_TAG& aTag )
+{
+    // the joints lie on a grid, so the coordinates have to be mixed well
+    unsigned int h = (unsigned int) aTag.pos.x * 0x9e3779b1u;
+
+    h ^= (unsigned int) aTag.pos.y * 0x85ebca77u;
+    h ^= (unsigned int) aTag.net * 0xc2b2ae3du;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 13;
+
+    return h;
+}
+
+
+PNS_JOINT* PNS_JOINT_MAP::Next( const HASH_TAG& aTag, int& aCursor ) const
+{
+    if( m_buckets.empty() )
+        return NULL;
+
+    const int mask = m_buckets.size() - 1;
+    int i = ( aCursor < 0 ) ? hash( aTag ) & mask : ( aCursor + 1 ) & mask;
+
+    // the joints of a tag are all in the run of buckets starting at its hash
+    for( ; m_buckets[i].m_joint >= 0; i = ( i + 1 ) & mask )
+    {
+        if( sameTag( m_buckets[i].m_tag, aTag ) )
+        {
+            aCursor = i;
+            return const_cast<PNS_JOINT*>( &m_joints[m_buckets[i].m_joint] );
+        }
+    }
+
+    return NULL;
+}
+
+
+PNS_JOINT* PNS_JOINT_MAP::Find( const HASH_TAG& aTag, const PNS_LAYERSET& aLayers ) const
+{
+    int cursor = -1;
+
+    while( PNS_JOINT* joint = Next( aTag, cursor ) )
+    {
+        if( joint->Layers().Overlaps( aLayers ) )
+            return joint;
+    }
+
+    return NULL;
+}
+
+
+PNS_JOINT& PNS_JOINT_MAP::Insert( const PNS_JOINT& aJoint )
+{
+    if( 2 * ( m_count + 1 ) > (int) m_buckets.size() )
+        grow();
+
+    int idx;
+
+    if( m_freeJoints.empty() )
+    {
+        idx = m_joints.size();
+        m_joints.push_back( aJoint );
+    }
+    else
+    {
+        idx = m_freeJoints.back();
+        m_freeJoints.pop_back();
+        m_joints[idx] = aJoint;
+    }
+
+    const int mask = m_buckets.size() - 1;
+    int i = hash( aJoint.Tag() ) & mask;
+
+    while( m_buckets[i].m_joint >= 0 )
+        i = ( i + 1 ) & mask;
+
+    m_buckets[i].m_tag = aJoint.Tag();
+    m_buckets[i].m_joint = idx;
+    m_count++;
+
+    return m_joints[idx];
+}
+
+
+int PNS_JOINT_MAP::findBucket( const PNS_JOINT* aJoint ) const
+{
+    int cursor = -1;
+
+    while( PNS_JOINT* joint = Next( aJoint->Tag(), cursor ) )
+    {
+        if( joint == aJoint )
+            return cursor;
+    }
+
+    return -1;
+}
+
+
+void PNS_JOINT_MAP::eraseBucket( int aBucket )
+{
+    const int mask = m_buckets.size() - 1;
+    int idx = m_buckets[aBucket].m_joint;
+
+    // drop the links, the slot is kept for the next inserted joint
+    m_joints[idx] = PNS_JOINT();
+    m_freeJoints.push_back( idx );
+    m_count--;
+
+    // Linear probing deletion: the following buckets of the run that can't be reached
+    // from their hash anymore are moved back into the hole.
+    int hole = aBucket;
+
+    for( int i = ( hole + 1 ) & mask; m_buckets[i].m_joint >= 0; i = ( i + 1 ) & mask )
+    {
+        int home = hash( m_buckets[i].m_tag ) & mask;
+
+        // is the home of bucket i cyclically outside of ( hole, i ] ?
+        bool movable = ( hole <= i ) ? ( home <= hole || home > i )
+                                     : ( home <= hole && home > i );
+
+        if( movable )
+        {
+            m_buckets[hole] = m_buckets[i];
+            hole = i;
+        }
+    }
+
+    m_buckets[hole].m_joint = -1;
+}
+
+
+void PNS_JOINT_MAP::Erase( const PNS_JOINT* aJoint )
+{
+    int bucket = findBucket( aJoint );
+
+    assert( bucket >= 0 );
+
+    if( bucket >= 0 )
+        eraseBucket( bucket );
+}
+
+
+void PNS_JOINT_MAP::Erase( const HASH_TAG& aTag )
+{
+    int cursor = -1;
+
+    while( Next( aTag, cursor ) )
+    {
+        eraseBucket( cursor );
+
+        // a following joint may have been moved to the erased bucket
+        cursor = -1;
+    }
+}
+
+
+void PNS_JOINT_MAP::CopyTag( const HASH_TAG& aTag, const PNS_JOINT_MAP& aOther )
+{
+    int cursor = -1;
+
+    while( PNS_JOINT* joint = aOther.Next( aTag, cursor ) )
+        Insert( *joint );
+}
+
+
+void PNS_JOINT_MAP::Clear()
+{
+    m_buckets.clear();
+    m_joints.clear();
+    m_freeJoints.clear();
+    m_count = 0;
+}
+
+
+void PNS_JOINT_MAP::grow()
+{
+    std::vector<BUCKET> old;
+    BUCKET empty;
+
+    empty.m_joint = -1;
+    old.swap( m_buckets );
+    m_buckets.resize( old.empty() ? (int) MinBuckets : 2 * old.size(), empty );
+
+    const int mask = m_buckets.size() - 1;
+
+    for( unsigned j = 0; j < old.size(); j++ )
+    {
+        if( old[j].m_joint < 0 )
+            continue;
+
+        int i = hash( old[j].m_tag ) & mask;
+
+        while( m_buckets[i].m_joint >= 0 )
+            i = ( i + 1 ) & mask;
+
+        m_buckets[i] = old[j];
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_JOINT_MAP_H
+#define __PNS_JOINT_MAP_H
+
+#include <vector>
+#include <deque>
+
+#include "pns_joint.h"
+#include "pns_layerset.h"
+
+/**
+ * Class PNS_JOINT_MAP
+ *
+ * Hash table of joints, keyed by their tag (position and net). There may be several joints
+ * with the same tag, on different layers.
+ *
+ * The table is open-addressed (linear probing) and its buckets hold the tags, so a lookup
+ * touches a single run of contiguous buckets instead of following the nodes of a chained
+ * hash map. The joints themselves are stored separately and never move, so the pointers
+ * returned by the map stay valid until the joint is erased (or the map cleared).
+ */
+class PNS_JOINT_MAP
+{
+public:
+    typedef PNS_JOINT::HASH_TAG HASH_TAG;
+
+    PNS_JOINT_MAP();
+
+    /**
+     * Function Next()
+     * iterates over the joints of a tag.
+     * @param aCursor iteration state, to be set to -1 before the first call.
+     * @return the next joint of the tag, or NULL if there are no more.
+     */
+    PNS_JOINT* Next( const HASH_TAG& aTag, int& aCursor ) const;
+
+    ///> Returns the first joint of the tag on layers overlapping aLayers, or NULL.
+    PNS_JOINT* Find( const HASH_TAG& aTag, const PNS_LAYERSET& aLayers ) const;
+
+    ///> Adds a copy of aJoint (keyed by its tag) and returns it.
+    PNS_JOINT& Insert( const PNS_JOINT& aJoint );
+
+    ///> Removes a joint of the map (aJoint must point to one of its joints).
+    void Erase( const PNS_JOINT* aJoint );
+
+    ///> Removes all the joints of a tag.
+    void Erase( const HASH_TAG& aTag );
+
+    ///> Copies all the joints of aTag from aOther.
+    void CopyTag( const HASH_TAG& aTag, const PNS_JOINT_MAP& aOther );
+
+    void Clear();
+
+    int Size() const
+    {
+        return m_count;
+    }
+
+private:
+    ///> A slot of the table, holding a tag and the index of its joint (-1 if the slot is free)
+    struct BUCKET
+    {
+        HASH_TAG m_tag;
+        int m_joint;
+    };
+
+    static const int MinBuckets = 64;
+
+    static unsigned int hash( const HASH_TAG& aTag );
+
+    static bool sameTag( const HASH_TAG& aA, const HASH_TAG& aB )
+    {
+        return aA.pos.x == aB.pos.x && aA.pos.y == aB.pos.y && aA.net == aB.net;
+    }
+
+    ///> Returns the index of the bucket holding aJoint, or -1.
+    int findBucket( const PNS_JOINT* aJoint ) const;
+
+    ///> Empties a bucket, moving back the following buckets of its run if needed.
+    void eraseBucket( int aBucket );
+
+    void grow();
+
+    ///> the hash table (its size is a power of 2)
+    std::vector<BUCKET> m_buckets;
+
+    ///> the joints, pointed to by the buckets
+    std::deque<PNS_JOINT> m_joints;
+
+    ///> indices of the erased joints, to be reused
+    std::vector<int> m_freeJoints;
+
+    ///> number of joints in the map
+    int m_count;
+};
+
+#endif    // __PNS_JOINT_MAP_H
@@ -38,7 +38,8 @@
 using boost::optional;
 
 PNS_LINE_PLACER::PNS_LINE_PLACER( PNS_ROUTER* aRouter ) :
-    PNS_PLACEMENT_ALGO( aRouter )
+    PNS_PLACEMENT_ALGO( aRouter ),
+    m_headOptimizer( NULL )
 {
     m_initial_direction = DIRECTION_45::N;
     m_world = NULL;
@@ -56,6 +57,7 @@ PNS_LINE_PLACER::PNS_LINE_PLACER( PNS_ROUTER* aRouter ) :
     m_chainedPlacement = false;
     m_splitSeg = false;
     m_orthoMode = false;
+    m_refineHead = false;
 }
 
 
@@ -399,7 +401,14 @@ bool PNS_LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
         walkFull.AppendVia( makeVia( walkFull.CPoint( -1 ) ) );
     }
 
-    PNS_OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    // the optimization is bounded in time, so that the head follows the cursor.
+    // If interrupted, it is continued by Refine().
+    m_headOptimizer.SetWorld( m_currentNode );
+    m_headOptimizer.ClearCache();
+    m_headOptimizer.SetEffortLevel( effort );
+    m_headOptimizer.SetCollisionMask( -1 );
+    m_headOptimizer.SetTimeLimit( Settings().OptimizerTimeLimit() );
+    m_headOptimizer.Optimize( &walkFull );
 
     if( m_currentNode->CheckColliding( &walkFull ) )
     {
@@ -407,6 +416,7 @@ bool PNS_LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
         return false;
     }
 
+    m_refineHead = m_headOptimizer.Interrupted();
     m_head = walkFull;
     aNewHead = walkFull;
 
@@ -438,8 +448,11 @@ bool PNS_LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
     walkaround.SetIterationLimit( 10 );
     PNS_WALKAROUND::WALKAROUND_STATUS stat_solids = walkaround.Route( initTrack, walkSolids );
 
+    // this line is only shoved, so there is nothing to refine later if the time runs out:
+    // a partially merged line is valid as well
     optimizer.SetEffortLevel( PNS_OPTIMIZER::MERGE_SEGMENTS );
     optimizer.SetCollisionMask ( PNS_ITEM::SOLID );
+    optimizer.SetTimeLimit( Settings().OptimizerTimeLimit() );
     optimizer.Optimize( &walkSolids );
 
     if( stat_solids == PNS_WALKAROUND::DONE )
@@ -487,11 +500,15 @@ bool PNS_LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
             l2 = m_shove->NewHead();
         }
 
-        optimizer.SetWorld( m_currentNode );
-        optimizer.SetEffortLevel( PNS_OPTIMIZER::MERGE_OBTUSE | PNS_OPTIMIZER::SMART_PADS );
-        optimizer.SetCollisionMask( PNS_ITEM::ANY );
-        optimizer.Optimize( &l2 );
+        // bounded in time as in rhWalkOnly(), continued by Refine()
+        m_headOptimizer.SetWorld( m_currentNode );
+        m_headOptimizer.ClearCache();
+        m_headOptimizer.SetEffortLevel( PNS_OPTIMIZER::MERGE_OBTUSE | PNS_OPTIMIZER::SMART_PADS );
+        m_headOptimizer.SetCollisionMask( PNS_ITEM::ANY );
+        m_headOptimizer.SetTimeLimit( Settings().OptimizerTimeLimit() );
+        m_headOptimizer.Optimize( &l2 );
 
+        m_refineHead = m_headOptimizer.Interrupted();
         aNewHead = l2;
 
         return true;
@@ -533,8 +550,15 @@ bool PNS_LINE_PLACER::routeHead( const VECTOR2I& aP, PNS_LINE& aNewHead )
 bool PNS_LINE_PLACER::optimizeTailHeadTransition()
 {
     PNS_LINE tmp = Trace();
+    PNS_OPTIMIZER optimizer( m_currentNode );
+
+    // both optimizations below work on a few segments only, but are bounded in time as well.
+    // An interrupted pass leaves a valid line, which is only accepted if it is better.
+    optimizer.SetCollisionMask( -1 );
+    optimizer.SetTimeLimit( Settings().OptimizerTimeLimit() );
+    optimizer.SetEffortLevel( PNS_OPTIMIZER::FANOUT_CLEANUP );
 
-    if( PNS_OPTIMIZER::Optimize( &tmp, PNS_OPTIMIZER::FANOUT_CLEANUP, m_currentNode ) )
+    if( optimizer.Optimize( &tmp ) )
     {
         if( tmp.SegmentCount() < 1 )
             return false;
@@ -573,7 +597,9 @@ bool PNS_LINE_PLACER::optimizeTailHeadTransition()
     // If so, replace the (threshold) last tail points and the head with
     // the optimized line
 
-    if( PNS_OPTIMIZER::Optimize( &new_head, PNS_OPTIMIZER::MERGE_OBTUSE, m_currentNode ) )
+    optimizer.SetEffortLevel( PNS_OPTIMIZER::MERGE_OBTUSE );
+
+    if( optimizer.Optimize( &new_head ) )
     {
         PNS_LINE tmp( m_tail, opt_line );
 
@@ -602,6 +628,8 @@ void PNS_LINE_PLACER::routeStep( const VECTOR2I& aP )
 
     PNS_LINE new_head;
 
+    m_refineHead = false;
+
     TRACE( 2, "INIT-DIR: %s head: %d, tail: %d segs\n",
             m_initial_direction.Format().c_str() % m_head.SegmentCount() %
             m_tail.SegmentCount() );
@@ -639,14 +667,43 @@ void PNS_LINE_PLACER::routeStep( const VECTOR2I& aP )
 
     if( !fail )
     {
-       if( optimizeTailHeadTransition() )
-          return;
+        // the head has been replaced, there is nothing left to refine
+        if( optimizeTailHeadTransition() )
+        {
+            m_refineHead = false;
+            return;
+        }
 
         mergeHead();
     }
 }
 
 
+bool PNS_LINE_PLACER::Refine()
+{
+    if( !m_refineHead || m_idle )
+        return false;
+
+    PNS_LINE head( m_head );
+
+    m_headOptimizer.SetWorld( m_currentNode );
+
+    bool changed = m_headOptimizer.Refine( &head );
+
+    m_refineHead = m_headOptimizer.Interrupted();
+
+    if( changed && !m_currentNode->CheckColliding( &head ) )
+        m_head = head;
+    else
+        changed = false;
+
+    // the router has erased the preview, including the ratline
+    updateLeadingRatLine();
+
+    return changed;
+}
+
+
 bool PNS_LINE_PLACER::route( const VECTOR2I& aP )
 {
     routeStep( aP );
@@ -770,6 +827,7 @@ bool PNS_LINE_PLACER::Start( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 void PNS_LINE_PLACER::initPlacement( bool aSplitSeg )
 {
     m_idle = false;
+    m_refineHead = false;
 
     m_head.Line().Clear();
     m_tail.Line().Clear();
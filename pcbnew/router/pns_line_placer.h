@@ -30,6 +30,7 @@
 #include "pns_node.h"
 #include "pns_via.h"
 #include "pns_line.h"
+#include "pns_optimizer.h"
 #include "pns_placement_algo.h"
 
 class PNS_ROUTER;
@@ -81,6 +82,21 @@ public:
      */
     bool FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem );
 
+    /**
+     * Function NeedsRefinement()
+     *
+     * Returns true if the optimization of the head has been interrupted by the time limit.
+     */
+    bool NeedsRefinement() const { return m_refineHead; }
+
+    /**
+     * Function Refine()
+     *
+     * Continues the interrupted optimization of the head.
+     * @return true, if the head has been changed.
+     */
+    bool Refine();
+
     /**
      * Function ToggleVia()
      *
@@ -388,6 +404,12 @@ private:
     PNS_MODE m_currentMode;
     PNS_ITEM* m_startItem;
 
+    ///> Optimizer of the head (walkaround mode), kept to resume an interrupted optimization
+    PNS_OPTIMIZER m_headOptimizer;
+
+    ///> Is the head optimization incomplete?
+    bool m_refineHead;
+
     bool m_idle;
     bool m_chainedPlacement;
     bool m_splitSeg;
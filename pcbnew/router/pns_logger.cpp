@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+
 #include "pns_logger.h"
 #include "pns_item.h"
 #include "pns_via.h"
@@ -136,6 +138,55 @@ void PNS_LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void PNS_LOGGER::LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const PNS_ITEM* aItem,
+                           int aArg0, int aArg1, int aArg2, int aArg3 )
+{
+    m_theLog << "event " << aType << " " << aP.x << " " << aP.y << " ";
+    m_theLog << aArg0 << " " << aArg1 << " " << aArg2 << " " << aArg3 << " ";
+
+    if( aItem )
+        m_theLog << aItem->Kind() << " " << aItem->Net() << " " << aItem->Layers().Start();
+    else
+        m_theLog << "0 0 0";
+
+    m_theLog << std::endl;
+}
+
+
+bool PNS_LOGGER::LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream f( aFilename.c_str() );
+
+    if( !f )
+        return false;
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream l( line );
+        std::string tag;
+        int type;
+        EVENT_ENTRY evt;
+
+        if( !( l >> tag ) || tag != "event" )
+            continue;
+
+        l >> type >> evt.p.x >> evt.p.y;
+        l >> evt.args[0] >> evt.args[1] >> evt.args[2] >> evt.args[3];
+        l >> evt.itemKind >> evt.itemNet >> evt.itemLayer;
+
+        if( !l )
+            continue;
+
+        evt.type = (EVENT_TYPE) type;
+        aEvents.push_back( evt );
+    }
+
+    return true;
+}
+
+
 void PNS_LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
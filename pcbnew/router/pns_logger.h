@@ -35,6 +35,35 @@ class SHAPE;
 class PNS_LOGGER
 {
 public:
+    ///> Router commands, recorded to replay a routing session (see LogEvent())
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX,
+        EVT_STOP,
+        EVT_SWITCH_LAYER,
+        EVT_TOGGLE_VIA,
+        EVT_FLIP_POSTURE,
+        EVT_SIZES
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE type;
+        VECTOR2I p;
+
+        ///> event parameters (layer, routing mode, sizes...), see PNS_ROUTER
+        int args[4];
+
+        ///> item the event refers to, identified by its kind (0 if there is no item),
+        ///> net and first layer
+        int itemKind;
+        int itemNet;
+        int itemLayer;
+    };
+
     PNS_LOGGER();
     ~PNS_LOGGER();
 
@@ -49,6 +78,16 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string aName = std::string() );
 
+    void LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const PNS_ITEM* aItem = NULL,
+                   int aArg0 = 0, int aArg1 = 0, int aArg2 = 0, int aArg3 = 0 );
+
+    /**
+     * Function LoadEvents()
+     * reads the events from a log saved with Save(), other entries are skipped.
+     * @return false if the file could not be read.
+     */
+    static bool LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
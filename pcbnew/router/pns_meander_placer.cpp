@@ -191,6 +191,16 @@ bool PNS_MEANDER_PLACER::doMove( const VECTOR2I& aP, PNS_ITEM* aEndItem, int aTa
 
 
 bool PNS_MEANDER_PLACER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
+{
+    if( !AddTunedLines() )
+        return false;
+
+    Router()->CommitRouting( m_currentNode );
+    return true;
+}
+
+
+bool PNS_MEANDER_PLACER::AddTunedLines()
 {
     if( !m_currentNode )
         return false;
@@ -198,7 +208,6 @@ bool PNS_MEANDER_PLACER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
     m_currentTrace = PNS_LINE( m_originLine, m_finalShape );
     m_currentNode->Add( &m_currentTrace );
 
-    Router()->CommitRouting( m_currentNode );
     return true;
 }
 
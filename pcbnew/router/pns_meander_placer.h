@@ -59,6 +59,9 @@ public:
     /// @copydoc PNS_PLACEMENT_ALGO::FixRoute()
     virtual bool FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem );
 
+    /// @copydoc PNS_MEANDER_PLACER_BASE::AddTunedLines()
+    virtual bool AddTunedLines();
+
     /// @copydoc PNS_PLACEMENT_ALGO::CurrentNode()
     PNS_NODE* CurrentNode( bool aLoopsRemoved = false ) const;
 
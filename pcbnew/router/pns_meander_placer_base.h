@@ -104,6 +104,15 @@ public:
      */
     virtual void UpdateSettings( const PNS_MEANDER_SETTINGS& aSettings);
 
+    /**
+     * Function AddTunedLines()
+     *
+     * Adds the tuned trace(s) to the current node, without committing it
+     * (FixRoute() does both).
+     * @return false if nothing has been tuned yet.
+     */
+    virtual bool AddTunedLines() = 0;
+
     /**
      * Function CheckFit()
      *
@@ -43,8 +43,77 @@ using boost::unordered_map;
 
 #ifdef DEBUG
 static boost::unordered_set<PNS_NODE*> allocNodes;
+
+// Nodes may be created and queried by placers running in parallel (see PNS_BATCH_TUNER)
+static void setNodeAllocated( PNS_NODE* aNode, bool aAllocated )
+{
+#ifdef USE_OPENMP
+    #pragma omp critical(pnsAllocNodes)
+#endif /* USE_OPENMP */
+    {
+        if( aAllocated )
+            allocNodes.insert( aNode );
+        else
+            allocNodes.erase( aNode );
+    }
+}
+
+
+static bool isNodeAllocated( PNS_NODE* aNode )
+{
+    bool allocated;
+
+#ifdef USE_OPENMP
+    #pragma omp critical(pnsAllocNodes)
+#endif /* USE_OPENMP */
+    allocated = allocNodes.find( aNode ) != allocNodes.end();
+
+    return allocated;
+}
 #endif
 
+
+/**
+ * Struct PNS_NODE::DELTA
+ *
+ * A layer of changes of a branch with respect to the root. Each layer lies on top of
+ * the layer it was created on (m_base), up to the root (NULL base). A layer is only
+ * modified by the node owning it as its top layer, it is frozen once the node has been
+ * branched from, and then shared by the node and its branches.
+ */
+struct PNS_NODE::DELTA
+{
+    DELTA( const DELTA_PTR& aBase ) :
+        m_base( aBase ),
+        m_depth( aBase ? aBase->m_depth + 1 : 1 )
+    {
+    }
+
+    bool Empty() const
+    {
+        return m_items.Size() == 0 && m_removed.empty() && m_touchedTags.empty();
+    }
+
+    ///> items added by this layer
+    PNS_INDEX m_items;
+
+    ///> items of the lower layers or of the root removed by this layer
+    boost::unordered_set<PNS_ITEM*> m_removed;
+
+    ///> joints modified by this layer. All the joints of a modified tag are stored,
+    ///> so they hide the joints of the same tag of the lower layers.
+    JOINT_MAP m_joints;
+
+    ///> tags of the joints stored in m_joints (a tag may have no joints left)
+    boost::unordered_set<PNS_JOINT::HASH_TAG> m_touchedTags;
+
+    ///> layer this one lies on, NULL for the root
+    DELTA_PTR m_base;
+
+    ///> number of layers from this one down to the root
+    int m_depth;
+};
+
 PNS_NODE::PNS_NODE()
 {
     TRACE( 0, "PNS_NODE::create %p", this );
@@ -57,7 +126,24 @@ PNS_NODE::PNS_NODE()
     m_collisionFilter = NULL;
 
 #ifdef DEBUG
-    allocNodes.insert( this );
+    setNodeAllocated( this, true );
+#endif
+}
+
+
+PNS_NODE::PNS_NODE( PNS_NODE* aParent )
+{
+    TRACE( 0, "PNS_NODE::create %p", this );
+    m_depth = aParent->m_depth + 1;
+    m_root = aParent->isRoot() ? aParent : aParent->m_root;
+    m_parent = aParent;
+    m_maxClearance = 800000;    // fixme: depends on how thick traces are.
+    m_clearanceFunctor = aParent->m_clearanceFunctor;
+    m_index = NULL;
+    m_collisionFilter = aParent->m_collisionFilter;
+
+#ifdef DEBUG
+    setNodeAllocated( this, true );
 #endif
 }
 
@@ -73,21 +159,42 @@ PNS_NODE::~PNS_NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
+    if( !isNodeAllocated( this ) )
     {
         TRACEn( 0, "attempting to free an already-free'd node.\n" );
         assert( false );
     }
 
-    allocNodes.erase( this );
+    setNodeAllocated( this, false );
 #endif
 
-    m_joints.clear();
+    m_joints.Clear();
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    if( isRoot() )
+    {
+        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+        {
+            if( (*i)->BelongsTo( this ) )
+                delete *i;
+        }
+    }
+    else
     {
-        if( (*i)->BelongsTo( this ) )
-            delete *i;
+        // the items added by this node may have been moved to any of its layers
+        // (by branching and merging), but they are not referenced by other nodes anymore
+        boost::unordered_set<PNS_ITEM*> owned;
+
+        for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
+        {
+            for( PNS_INDEX::ITEM_SET::iterator i = d->m_items.begin(); i != d->m_items.end(); ++i )
+            {
+                if( (*i)->BelongsTo( this ) )
+                    owned.insert( *i );
+            }
+        }
+
+        BOOST_FOREACH( PNS_ITEM* item, owned )
+            delete item;
     }
 
     releaseGarbage();
@@ -107,39 +214,95 @@ int PNS_NODE::GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const
 
 PNS_NODE* PNS_NODE::Branch()
 {
-    PNS_NODE* child = new PNS_NODE;
+    PNS_NODE* child = new PNS_NODE( this );
 
     TRACE( 0, "PNS_NODE::branch %p (parent %p)", child % this );
 
     m_children.insert( child );
 
-    child->m_depth = m_depth + 1;
-    child->m_parent = this;
-    child->m_clearanceFunctor = m_clearanceFunctor;
-    child->m_root = isRoot() ? this : m_root;
-    child->m_collisionFilter = m_collisionFilter;
-
-    // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
-    if( !isRoot() )
+    if( isRoot() )
     {
-        JOINT_MAP::iterator j;
+        child->m_delta.reset( new DELTA( DELTA_PTR() ) );
+    }
+    else if( m_delta->Empty() )
+    {
+        // nothing to freeze, the child lies on the same layers as this node
+        child->m_delta.reset( new DELTA( m_delta->m_base ) );
+    }
+    else
+    {
+        // freeze the current layer, both nodes continue with a new layer on top of it.
+        // Merging the layers from time to time keeps the queries fast in deep branches.
+        DELTA_PTR frozen = m_delta;
 
-        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
+        if( frozen->m_depth >= MaxDeltaDepth )
+            frozen = mergeLayers( frozen );
 
-        child->m_joints = m_joints;
-        child->m_override = m_override;
+        m_delta.reset( new DELTA( frozen ) );
+        child->m_delta.reset( new DELTA( frozen ) );
     }
 
-    TRACE( 2, "%d items, %d joints, %d overrides",
-            child->m_index->Size() % child->m_joints.size() % child->m_override.size() );
+    TRACE( 2, "%d layers", child->m_delta->m_depth );
 
     return child;
 }
 
 
+PNS_NODE::DELTA_PTR PNS_NODE::mergeLayers( const DELTA_PTR& aTop ) const
+{
+    std::vector<DELTA*> layers;
+
+    for( DELTA* d = aTop.get(); d; d = d->m_base.get() )
+        layers.push_back( d );
+
+    DELTA_PTR merged( new DELTA( DELTA_PTR() ) );
+    boost::unordered_set<PNS_ITEM*> items;
+
+    // apply the layers from the bottom to the top one
+    for( int i = layers.size() - 1; i >= 0; i-- )
+    {
+        DELTA* d = layers[i];
+
+        BOOST_FOREACH( PNS_ITEM* item, d->m_removed )
+        {
+            items.erase( item );
+
+            // removed items of the lower layers are simply not copied, but the root
+            // items have to be hidden by the merged layer
+            if( m_root->m_index->Contains( item ) )
+                merged->m_removed.insert( item );
+        }
+
+        for( PNS_INDEX::ITEM_SET::iterator j = d->m_items.begin(); j != d->m_items.end(); ++j )
+            items.insert( *j );
+
+        BOOST_FOREACH( const PNS_JOINT::HASH_TAG& tag, d->m_touchedTags )
+        {
+            merged->m_joints.Erase( tag );
+            merged->m_touchedTags.insert( tag );
+            merged->m_joints.CopyTag( tag, d->m_joints );
+        }
+    }
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
+        merged->m_items.Add( item );
+
+    return merged;
+}
+
+
+bool PNS_NODE::removedAbove( const DELTA* aLayer, PNS_ITEM* aItem ) const
+{
+    for( const DELTA* d = m_delta.get(); d && d != aLayer; d = d->m_base.get() )
+    {
+        if( !d->m_removed.empty() && d->m_removed.find( aItem ) != d->m_removed.end() )
+            return true;
+    }
+
+    return false;
+}
+
+
 void PNS_NODE::unlinkParent()
 {
     if( isRoot() )
@@ -156,9 +319,12 @@ struct PNS_NODE::OBSTACLE_VISITOR
     ///> node we are searching in (either root or a branch)
     PNS_NODE* m_node;
 
-    ///> node that overrides root entries
+    ///> branch being searched, whose layers may hide the found items
     PNS_NODE* m_override;
 
+    ///> layer of m_override being searched (NULL when searching the root)
+    const DELTA* m_layer;
+
     ///> list of encountered obstacles
     OBSTACLES& m_tab;
 
@@ -184,6 +350,7 @@ struct PNS_NODE::OBSTACLE_VISITOR
     OBSTACLE_VISITOR( PNS_NODE::OBSTACLES& aTab, const PNS_ITEM* aItem, int aKindMask, bool aDifferentNetsOnly ) :
         m_node( NULL ),
         m_override( NULL ),
+        m_layer( NULL ),
         m_tab( aTab ),
         m_item( aItem ),
         m_kindMask( aKindMask ),
@@ -202,10 +369,11 @@ struct PNS_NODE::OBSTACLE_VISITOR
         m_limitCount = aLimit;
     }
 
-    void SetWorld( PNS_NODE* aNode, PNS_NODE* aOverride = NULL )
+    void SetWorld( PNS_NODE* aNode, PNS_NODE* aOverride = NULL, const DELTA* aLayer = NULL )
     {
         m_node = aNode;
         m_override = aOverride;
+        m_layer = aLayer;
     }
 
     bool operator()( PNS_ITEM* aItem )
@@ -213,9 +381,9 @@ struct PNS_NODE::OBSTACLE_VISITOR
         if( !aItem->OfKind( m_kindMask ) )
             return true;
 
-        // check if there is a more recent branch with a newer
+        // check if there is a more recent layer with a newer
         // (possibily modified) version of this item.
-        if( m_override && m_override->overrides( aItem ) )
+        if( m_override && m_override->removedAbove( m_layer, aItem ) )
             return true;
 
         int clearance = m_extraClearance + m_node->GetClearance( aItem, m_item );
@@ -254,19 +422,34 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    assert( isNodeAllocated( this ) );
 #endif
 
     visitor.SetCountLimit( aLimitCount );
-    visitor.SetWorld( this, NULL );
     visitor.m_forceClearance = aForceClearance;
-    // first, look for colliding items in the local index
-    m_index->Query( aItem, m_maxClearance, visitor );
+
+    if( isRoot() )
+    {
+        visitor.SetWorld( this, NULL );
+        m_index->Query( aItem, m_maxClearance, visitor );
+
+        return aObstacles.size();
+    }
+
+    // first, look for colliding items in the layers of the branch, from the most recent one
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
+    {
+        if( visitor.m_matchCount >= aLimitCount && aLimitCount >= 0 )
+            return aObstacles.size();
+
+        visitor.SetWorld( this, this, d );
+        d->m_items.Query( aItem, m_maxClearance, visitor );
+    }
 
     // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
+    if( visitor.m_matchCount < aLimitCount || aLimitCount < 0 )
     {
-        visitor.SetWorld( m_root, this );
+        visitor.SetWorld( m_root, this, NULL );
         m_root->m_index->Query( aItem, m_maxClearance, visitor );
     }
 
@@ -483,38 +666,63 @@ const PNS_ITEMSET PNS_NODE::HitTest( const VECTOR2I& aPoint ) const
 
     // fixme: we treat a point as an infinitely small circle - this is inefficient.
     SHAPE_CIRCLE s( aPoint, 0 );
-    HIT_VISITOR visitor( items, aPoint, this );
 
-    m_index->Query( &s, m_maxClearance, visitor );
+    if( isRoot() )
+    {
+        HIT_VISITOR visitor( items, aPoint, this );
+        m_index->Query( &s, m_maxClearance, visitor );
+
+        return items;
+    }
 
-    if( !isRoot() )    // fixme: could be made cleaner
+    // fixme: could be made cleaner
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
     {
-        PNS_ITEMSET items_root;
-        HIT_VISITOR  visitor_root( items_root, aPoint, m_root );
-        m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+        PNS_ITEMSET items_layer;
+        HIT_VISITOR visitor_layer( items_layer, aPoint, this );
+        d->m_items.Query( &s, m_maxClearance, visitor_layer );
 
-        BOOST_FOREACH( PNS_ITEM* item, items_root.Items() )
+        BOOST_FOREACH( PNS_ITEM* item, items_layer.Items() )
         {
-            if( !overrides( item ) )
+            if( !removedAbove( d, item ) )
                 items.Add( item );
         }
     }
 
+    PNS_ITEMSET items_root;
+    HIT_VISITOR  visitor_root( items_root, aPoint, m_root );
+    m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+
+    BOOST_FOREACH( PNS_ITEM* item, items_root.Items() )
+    {
+        if( !removedAbove( NULL, item ) )
+            items.Add( item );
+    }
+
     return items;
 }
 
 
+void PNS_NODE::addToIndex( PNS_ITEM* aItem )
+{
+    if( isRoot() )
+        m_index->Add( aItem );
+    else
+        m_delta->m_items.Add( aItem );
+}
+
+
 void PNS_NODE::addSolid( PNS_SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
-    m_index->Add( aSolid );
+    addToIndex( aSolid );
 }
 
 
 void PNS_NODE::addVia( PNS_VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
-    m_index->Add( aVia );
+    addToIndex( aVia );
 }
 
 
@@ -549,7 +757,7 @@ void PNS_NODE::addLine( PNS_LINE* aLine, bool aAllowRedundant )
 
                 aLine->LinkSegment( pseg );
 
-                m_index->Add( pseg );
+                addToIndex( pseg );
             }
         }
     }
@@ -572,7 +780,7 @@ void PNS_NODE::addSegment( PNS_SEGMENT* aSeg, bool aAllowRedundant )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    addToIndex( aSeg );
 }
 
 
@@ -606,16 +814,19 @@ void PNS_NODE::Add( PNS_ITEM* aItem, bool aAllowRedundant )
 
 void PNS_NODE::doRemove( PNS_ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
-    // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
-
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
+    // case 1: we are the root: remove from the index
+    if( isRoot() )
         m_index->Remove( aItem );
 
+    // case 2: the item has been added to the top layer of this branch: remove it from the layer
+    else if( m_delta->m_items.Contains( aItem ) )
+        m_delta->m_items.Remove( aItem );
+
+    // case 3: the item is stored in the root node or in a lower (shared) layer:
+    // mark it as overridden, but do not remove
+    else
+        m_delta->m_removed.insert( aItem );
+
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
@@ -634,6 +845,14 @@ void PNS_NODE::removeSegment( PNS_SEGMENT* aSeg )
 }
 
 
+void PNS_NODE::removeSolid( PNS_SOLID* aSolid )
+{
+    unlinkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
+
+    doRemove( aSolid );
+}
+
+
 void PNS_NODE::removeLine( PNS_LINE* aLine )
 {
     std::vector<PNS_SEGMENT*>* segRefs = aLine->LinkedSegments();
@@ -663,27 +882,11 @@ void PNS_NODE::removeVia( PNS_VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
-    bool split;
-    do
-    {
-        split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+    JOINT_MAP& joints = touchJoints( tag );
 
-        if( range.first == m_joints.end() )
-            break;
-
-        // find and remove all joints containing the via to be removed
-
-        for( JOINT_MAP::iterator f = range.first; f != range.second; ++f )
-        {
-            if( aVia->LayersOverlap ( &f->second ) )
-            {
-                m_joints.erase( f );
-                split = true;
-                break;
-            }
-        }
-    } while( split );
+    // find and remove all joints containing the via to be removed
+    while( PNS_JOINT* f = joints.Find( tag, vLayers ) )
+        joints.Erase( f );
 
     // and re-link them, using the former via's link list
     BOOST_FOREACH(PNS_ITEM* item, links)
@@ -708,8 +911,7 @@ void PNS_NODE::Remove( PNS_ITEM* aItem )
     switch( aItem->Kind() )
     {
     case PNS_ITEM::SOLID:
-        // fixme: this fucks up the joints, but it's only used for marking colliding obstacles for the moment, so we don't care.
-        doRemove( aItem );
+        removeSolid( static_cast<PNS_SOLID*>( aItem ) );
         break;
 
     case PNS_ITEM::SEGMENT:
@@ -736,6 +938,15 @@ void PNS_NODE::Remove( PNS_LINE& aLine )
 }
 
 
+bool PNS_NODE::Contains( PNS_ITEM* aItem ) const
+{
+    if( isRoot() )
+        return m_index->Contains( aItem );
+
+    return m_delta->m_items.Contains( aItem );
+}
+
+
 void PNS_NODE::followLine( PNS_SEGMENT* aCurrent, bool aScanDirection, int& aPos,
         int aLimit, VECTOR2I* aCorners, PNS_SEGMENT** aSegments, bool& aGuardHit,
 		bool aStopAtLockedJoints )
@@ -914,33 +1125,45 @@ PNS_JOINT* PNS_NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    return findJoints( tag ).Find( tag, PNS_LAYERSET( aLayer ) );
+}
 
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
 
-    if( f == end )
-        return NULL;
+void PNS_NODE::LockJoint( const VECTOR2I& aPos, const PNS_ITEM* aItem, bool aLock )
+{
+    PNS_JOINT& jt = touchJoint( aPos, aItem->Layers(), aItem->Net() );
+    jt.Lock( aLock );
+}
 
-    while( f != end )
-    {
-        if( f->second.Layers().Overlaps( aLayer ) )
-            return &f->second;
 
-        ++f;
+PNS_NODE::JOINT_MAP& PNS_NODE::findJoints( const PNS_JOINT::HASH_TAG& aTag )
+{
+    // the most recent layer which has modified the joints of this tag has them all
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
+    {
+        if( d->m_touchedTags.find( aTag ) != d->m_touchedTags.end() )
+            return d->m_joints;
     }
 
-    return NULL;
+    return m_root->m_joints;
 }
 
 
-void PNS_NODE::LockJoint( const VECTOR2I& aPos, const PNS_ITEM* aItem, bool aLock )
+PNS_NODE::JOINT_MAP& PNS_NODE::touchJoints( const PNS_JOINT::HASH_TAG& aTag )
 {
-    PNS_JOINT& jt = touchJoint( aPos, aItem->Layers(), aItem->Net() );
-    jt.Lock( aLock );
+    if( isRoot() )
+        return m_joints;
+
+    JOINT_MAP& joints = m_delta->m_joints;
+
+    // not modified by this node yet? copy the joints of the tag here.
+    if( m_delta->m_touchedTags.find( aTag ) == m_delta->m_touchedTags.end() )
+    {
+        joints.CopyTag( aTag, findJoints( aTag ) );
+        m_delta->m_touchedTags.insert( aTag );
+    }
+
+    return joints;
 }
 
 
@@ -951,47 +1174,19 @@ PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLaye
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
-
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
-    {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
-    }
+    // find the joints in this node, copying them from the parent layers or the root if needed
+    JOINT_MAP& joints = touchJoints( tag );
 
     // now insert and combine overlapping joints
     PNS_JOINT jt( aPos, aLayers, aNet );
 
-    bool merged;
-
-    do
+    while( PNS_JOINT* f = joints.Find( tag, aLayers ) )
     {
-        merged  = false;
-        range   = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        for( f = range.first; f != range.second; ++f )
-        {
-            if( aLayers.Overlaps( f->second.Layers() ) )
-            {
-                jt.Merge( f->second );
-                m_joints.erase( f );
-                merged = true;
-                break;
-            }
-        }
+        jt.Merge( *f );
+        joints.Erase( f );
     }
-    while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.Insert( jt );
 }
 
 
@@ -1037,7 +1232,7 @@ void PNS_NODE::Dump( bool aLong )
     {
         for( i = m_root->m_items.begin(); i != m_root->m_items.end(); i++ )
         {
-            if( (*i)->GetKind() == PNS_ITEM::SEGMENT && !overrides( *i ) )
+            if( (*i)->GetKind() == PNS_ITEM::SEGMENT && !removedAbove( NULL, *i ) )
                 all_segs.insert( static_cast<PNS_SEGMENT*>(*i) );
         }
     }
@@ -1102,19 +1297,43 @@ void PNS_NODE::Dump( bool aLong )
 }
 
 
-void PNS_NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
+void PNS_NODE::branchItems( ITEM_VECTOR& aItems ) const
+{
+    boost::unordered_set<PNS_ITEM*> found;
+
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
+    {
+        for( PNS_INDEX::ITEM_SET::iterator i = d->m_items.begin(); i != d->m_items.end(); ++i )
+        {
+            if( !removedAbove( d, *i ) && found.insert( *i ).second )
+                aItems.push_back( *i );
+        }
+    }
+}
+
+
+void PNS_NODE::removedRootItems( ITEM_VECTOR& aItems ) const
 {
-    aRemoved.reserve( m_override.size() );
-    aAdded.reserve( m_index->Size() );
+    boost::unordered_set<PNS_ITEM*> found;
+
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
+    {
+        BOOST_FOREACH( PNS_ITEM* item, d->m_removed )
+        {
+            if( m_root->m_index->Contains( item ) && found.insert( item ).second )
+                aItems.push_back( item );
+        }
+    }
+}
 
+
+void PNS_NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
+{
     if( isRoot() )
         return;
 
-    BOOST_FOREACH( PNS_ITEM* item, m_override )
-        aRemoved.push_back( item );
-
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    removedRootItems( aRemoved );
+    branchItems( aAdded );
 }
 
 void PNS_NODE::releaseChildren()
@@ -1150,15 +1369,18 @@ void PNS_NODE::Commit( PNS_NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    BOOST_FOREACH( PNS_ITEM* item, aNode->m_override )
-    Remove( item );
+    ITEM_VECTOR removed, added;
+
+    aNode->GetUpdatedItems( removed, added );
 
-    for( PNS_INDEX::ITEM_SET::iterator i = aNode->m_index->begin();
-         i != aNode->m_index->end(); ++i )
+    BOOST_FOREACH( PNS_ITEM* item, removed )
+        Remove( item );
+
+    BOOST_FOREACH( PNS_ITEM* item, added )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Unmark();
-        Add( *i );
+        item->SetRank( -1 );
+        item->Unmark();
+        Add( item );
     }
 
     releaseChildren();
@@ -1170,47 +1392,77 @@ void PNS_NODE::KillChildren()
 {
     assert( isRoot() );
     releaseChildren();
+    releaseGarbage();
 }
 
 
 void PNS_NODE::AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems )
 {
-    PNS_INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
-
-    if( l_cur )
+    if( isRoot() )
     {
-        BOOST_FOREACH( PNS_ITEM*item, *l_cur )
-            aItems.insert( item );
+        PNS_INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
+
+        if( l_cur )
+        {
+            BOOST_FOREACH( PNS_ITEM*item, *l_cur )
+                aItems.insert( item );
+        }
+
+        return;
     }
 
-    if( !isRoot() )
+    for( DELTA* d = m_delta.get(); d; d = d->m_base.get() )
     {
-        PNS_INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        PNS_INDEX::NET_ITEMS_LIST* l_cur = d->m_items.GetItemsForNet( aNet );
 
-        if( l_root )
-            for( PNS_INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
-                if( !overrides( *i ) )
+        if( l_cur )
+            for( PNS_INDEX::NET_ITEMS_LIST::iterator i = l_cur->begin(); i != l_cur->end(); ++i )
+                if( !removedAbove( d, *i ) )
                     aItems.insert( *i );
     }
+
+    PNS_INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+
+    if( l_root )
+        for( PNS_INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
+            if( !removedAbove( NULL, *i ) )
+                aItems.insert( *i );
+}
+
+
+void PNS_NODE::localItems( ITEM_VECTOR& aItems ) const
+{
+    if( isRoot() )
+        aItems.insert( aItems.end(), m_index->begin(), m_index->end() );
+    else
+        branchItems( aItems );
 }
 
 
 void PNS_NODE::ClearRanks( int aMarkerMask )
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    ITEM_VECTOR items;
+
+    localItems( items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
+        item->SetRank( -1 );
+        item->Mark( item->Marker() & (~aMarkerMask) );
     }
 }
 
 
 int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    ITEM_VECTOR items;
+
+    localItems( items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        if( (*i)->Marker() & aMarker )
-            aItems.Add( *i );
+        if( item->Marker() & aMarker )
+            aItems.Add( item );
     }
 
     return 0;
@@ -1220,12 +1472,15 @@ int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 int PNS_NODE::RemoveByMarker( int aMarker )
 {
     std::list<PNS_ITEM*> garbage;
+    ITEM_VECTOR items;
+
+    localItems( items );
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        if ( (*i)->Marker() & aMarker )
+        if ( item->Marker() & aMarker )
         {
-            garbage.push_back( *i );
+            garbage.push_back( item );
         }
     }
 
@@ -1275,8 +1530,24 @@ void PNS_NODE::SetCollisionFilter( PNS_COLLISION_FILTER* aFilter )
 
 PNS_ITEM *PNS_NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
+    if( !isRoot() )
+    {
+        ITEM_VECTOR items;
+
+        branchItems( items );
+
+        BOOST_FOREACH( PNS_ITEM*item, items )
+            if( item->Parent() == aParent )
+                return item;
+
+        return NULL;
+    }
+
     PNS_INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
 
+    if( !l_cur )
+        return NULL;
+
     BOOST_FOREACH( PNS_ITEM*item, *l_cur )
         if( item->Parent() == aParent )
             return item;
@@ -27,6 +27,7 @@
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -34,6 +35,7 @@
 
 #include "pns_item.h"
 #include "pns_joint.h"
+#include "pns_joint_map.h"
 #include "pns_itemset.h"
 
 class PNS_SEGMENT;
@@ -68,16 +70,39 @@ public:
 
     void UseDpGap( bool aUseDpGap ) { m_useDpGap = aUseDpGap; }
 
+    ///> Returns true if the per-net clearances are the same as in aOther.
+    bool SameClearances( const PNS_PCBNEW_CLEARANCE_FUNC& aOther ) const;
+
 private:
     struct CLEARANCE_ENT {
         int coupledNet;
-        int clearance;
+        int netClass;       ///> index of the net class in the clearance matrix
     };
 
     PNS_ROUTER *m_router;
 
     int localPadClearance( const PNS_ITEM* aItem ) const;
+
+    ///> Returns the index of the net class of a net in the clearance matrix.
+    int netClass( int aNet ) const
+    {
+        return ( aNet >= 0 && aNet < (int) m_clearanceCache.size() ) ?
+                    m_clearanceCache[aNet].netClass : 0;
+    }
+
+    ///> Returns the clearance between two net classes.
+    int classClearance( int aClassA, int aClassB ) const
+    {
+        return m_classMatrix[aClassA * m_classCount + aClassB];
+    }
+
     std::vector<CLEARANCE_ENT> m_clearanceCache;
+
+    ///> Clearances between each pair of net classes. The class 0 is used for the items
+    ///> without a net, the other ones are the net classes of the board.
+    std::vector<int> m_classMatrix;
+    int m_classCount;
+
     int m_defaultClearance;
     bool m_overrideEnabled;
     int m_overrideNetA, m_overrideNetB;
@@ -130,6 +155,13 @@ struct PNS_COLLISION_FILTER {
  * - assembly of lines connecting joints, finding loops and unique paths
  * - lightweight cloning/branching (for recursive optimization and shove
  * springback)
+ *
+ * The root node stores the items in its own index. A branch stores its changes with respect
+ * to the root in a stack of layers (see DELTA): its own layer, on top of the layers of the
+ * node it was branched from. Layers are shared by the nodes and never modified once a node
+ * has been branched from, so branching is O(1) and a branch never copies the changes made by
+ * its parents. The stack depth is bounded by merging the layers into a single one from time
+ * to time, so the cost of the queries does not grow with the branch depth.
  **/
 class PNS_NODE
 {
@@ -165,7 +197,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints.Size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -280,6 +312,14 @@ public:
      */
     void Remove( PNS_LINE& aLine );
 
+    /**
+     * Function Contains()
+     *
+     * Checks if an item is stored in this branch (and not in one of its parents).
+     * @param aItem item to look for
+     */
+    bool Contains( PNS_ITEM* aItem ) const;
+
 
     /**
      * Function Replace()
@@ -296,6 +336,7 @@ public:
      * Creates a lightweight copy (called branch) of self that tracks
      * the changes (added/removed items) wrs to the root. Note that if there are
      * any branches in use, their parents must NOT be deleted.
+     * Branching takes constant time, the changes of this node are shared with the branch.
      * @return the new branch
      */
     PNS_NODE* Branch();
@@ -371,7 +412,8 @@ public:
     ///> finds the joints corresponding to the ends of line aLine
     void FindLineEnds( const PNS_LINE& aLine, PNS_JOINT& aA, PNS_JOINT& aB );
 
-    ///> Destroys all child nodes. Applicable only to the root node.
+    ///> Destroys all child nodes and the items removed from the root node.
+    ///> Applicable only to the root node.
     void KillChildren();
 
     void AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems );
@@ -391,13 +433,27 @@ public:
 
 private:
     struct OBSTACLE_VISITOR;
-    typedef boost::unordered_multimap<PNS_JOINT::HASH_TAG, PNS_JOINT> JOINT_MAP;
-    typedef JOINT_MAP::value_type TagJointPair;
+    struct DELTA;
+    typedef PNS_JOINT_MAP JOINT_MAP;
+    typedef boost::shared_ptr<DELTA> DELTA_PTR;
+
+    ///> max number of layers of a branch, before they are merged into a single one
+    static const int MaxDeltaDepth = 8;
 
     /// nodes are not copyable
     PNS_NODE( const PNS_NODE& aB );
     PNS_NODE& operator=( const PNS_NODE& aB );
 
+    ///> creates a branch of aParent
+    PNS_NODE( PNS_NODE* aParent );
+
+    ///> returns the joints of a tag that can be modified in this node, copying them
+    ///> from the parent layers or the root if needed
+    JOINT_MAP& touchJoints( const PNS_JOINT::HASH_TAG& aTag );
+
+    ///> returns the joint map storing the current joints of a tag
+    JOINT_MAP& findJoints( const PNS_JOINT::HASH_TAG& aTag );
+
     ///> tries to find matching joint and creates a new one if not found
     PNS_JOINT& touchJoint( const VECTOR2I&      aPos,
                            const PNS_LAYERSET&  aLayers,
@@ -416,6 +472,10 @@ private:
     void addSegment( PNS_SEGMENT* aSeg, bool aAllowRedundant );
     void addLine( PNS_LINE* aLine, bool aAllowRedundant );
     void addVia( PNS_VIA* aVia );
+
+    ///> adds an item to the index of the root or to the top layer of a branch
+    void addToIndex( PNS_ITEM* aItem );
+
     void removeSolid( PNS_SOLID* aSeg );
     void removeLine( PNS_LINE* aLine );
     void removeSegment( PNS_SEGMENT* aSeg );
@@ -431,12 +491,21 @@ private:
         return m_parent == NULL;
     }
 
-    ///> checks if this branch contains an updated version of the m_item
-    ///> from the root branch.
-    bool overrides( PNS_ITEM* aItem ) const
-    {
-        return m_override.find( aItem ) != m_override.end();
-    }
+    ///> checks if aItem, found in the layer aLayer of this branch (or in the root
+    ///> if aLayer is NULL), has been removed by one of the layers above aLayer.
+    bool removedAbove( const DELTA* aLayer, PNS_ITEM* aItem ) const;
+
+    ///> returns the items added to the root by this branch
+    void branchItems( ITEM_VECTOR& aItems ) const;
+
+    ///> returns the root items removed by this branch
+    void removedRootItems( ITEM_VECTOR& aItems ) const;
+
+    ///> returns the items of the root, or the items added by a branch
+    void localItems( ITEM_VECTOR& aItems ) const;
+
+    ///> merges a stack of layers into a single layer
+    DELTA_PTR mergeLayers( const DELTA_PTR& aTop ) const;
 
     PNS_SEGMENT* findRedundantSegment( PNS_SEGMENT* aSeg );
 
@@ -451,9 +520,13 @@ private:
                      bool            aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
+    ///> their position, layer set and net. Used by the root node only.
     JOINT_MAP m_joints;
 
+    ///> changes of a branch wrs to the root (NULL for the root). This layer belongs to this
+    ///> node only, the layers below it are shared with the parent and sibling nodes.
+    DELTA_PTR m_delta;
+
     ///> node this node was branched from
     PNS_NODE* m_parent;
 
@@ -463,16 +536,13 @@ private:
     ///> list of nodes branched from this one
     std::set<PNS_NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    boost::unordered_set<PNS_ITEM*> m_override;
-
     ///> worst case item-item clearance
     int m_maxClearance;
 
     ///> Clearance resolution functor
     PNS_CLEARANCE_FUNC* m_clearanceFunctor;
 
-    ///> Geometric/Net index of the items
+    ///> Geometric/Net index of the items (root node only)
     PNS_INDEX* m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
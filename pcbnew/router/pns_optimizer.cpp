@@ -125,7 +125,12 @@ PNS_OPTIMIZER::PNS_OPTIMIZER( PNS_NODE* aWorld ) :
     m_collisionKindMask( PNS_ITEM::ANY ),
     m_effortLevel( MERGE_SEGMENTS ),
     m_keepPostures( false ),
-    m_restrictAreaActive( false )
+    m_restrictAreaActive( false ),
+    m_timeLimit( 0 ),
+    m_interrupted( false ),
+    m_donePasses( 0 ),
+    m_mergeStep( -1 ),
+    m_maxCachedItems( MinCachedItems )
 {
 }
 
@@ -170,12 +175,36 @@ void PNS_OPTIMIZER::cacheAdd( PNS_ITEM* aItem, bool aIsStatic = false )
     if( m_cacheTags.find( aItem ) != m_cacheTags.end() )
         return;
 
+    if( (int) m_cacheTags.size() >= m_maxCachedItems )
+        pruneCache();
+
     m_cache.Add( aItem );
     m_cacheTags[aItem].m_hits = 1;
     m_cacheTags[aItem].m_isStatic = aIsStatic;
 }
 
 
+void PNS_OPTIMIZER::pruneCache()
+{
+    std::vector<PNS_ITEM*> dropped;
+
+    // keep the static items and the ones which have been hit more than once
+    for( CachedItemTags::iterator i = m_cacheTags.begin(); i != m_cacheTags.end(); ++i )
+    {
+        if( !i->second.m_isStatic && i->second.m_hits <= 1 )
+            dropped.push_back( i->first );
+        else if( !i->second.m_isStatic )
+            i->second.m_hits = 1;
+    }
+
+    BOOST_FOREACH( PNS_ITEM* item, dropped )
+    {
+        m_cache.Remove( item );
+        m_cacheTags.erase( item );
+    }
+}
+
+
 void PNS_OPTIMIZER::removeCachedSegments( PNS_LINE* aLine, int aStartVertex, int aEndVertex )
 {
     PNS_LINE::SEGMENT_REFS* segs = aLine->LinkedSegments();
@@ -423,7 +452,7 @@ bool PNS_OPTIMIZER::mergeObtuse( PNS_LINE* aLine )
 {
     SHAPE_LINE_CHAIN& line = aLine->Line();
 
-    int step = line.PointCount() - 3;
+    int step = m_mergeStep >= 0 ? m_mergeStep : line.PointCount() - 3;
     int iter = 0;
     int segs_pre = line.SegmentCount();
 
@@ -441,8 +470,9 @@ bool PNS_OPTIMIZER::mergeObtuse( PNS_LINE* aLine )
         if( step > max_step )
             step = max_step;
 
-        if( step < 2 )
+        if( step < 2 || timeExpired() )
         {
+            m_mergeStep = m_interrupted ? step : -1;
             line = current_path;
             return current_path.SegmentCount() < segs_pre;
         }
@@ -498,6 +528,7 @@ bool PNS_OPTIMIZER::mergeObtuse( PNS_LINE* aLine )
         {
             if( step <= 2 )
             {
+                m_mergeStep = -1;
                 line = current_path;
                 return line.SegmentCount() < segs_pre;
             }
@@ -513,7 +544,7 @@ bool PNS_OPTIMIZER::mergeObtuse( PNS_LINE* aLine )
 bool PNS_OPTIMIZER::mergeFull( PNS_LINE* aLine )
 {
     SHAPE_LINE_CHAIN& line = aLine->Line();
-    int step = line.SegmentCount() - 1;
+    int step = m_mergeStep >= 0 ? m_mergeStep : line.SegmentCount() - 1;
 
     int segs_pre = line.SegmentCount();
 
@@ -535,12 +566,21 @@ bool PNS_OPTIMIZER::mergeFull( PNS_LINE* aLine )
         if( step < 1 )
             break;
 
+        if( timeExpired() )
+        {
+            m_mergeStep = step;
+            break;
+        }
+
         bool found_anything = mergeStep( aLine, current_path, step );
 
         if( !found_anything )
             step--;
     }
 
+    if( !m_interrupted )
+        m_mergeStep = -1;
+
     aLine->SetShape( current_path );
 
     return current_path.SegmentCount() < segs_pre;
@@ -555,20 +595,78 @@ bool PNS_OPTIMIZER::Optimize( PNS_LINE* aLine, PNS_LINE* aResult )
         *aResult = *aLine;
 
     m_keepPostures = false;
+    m_donePasses = 0;
+    m_mergeStep = -1;
+
+    return runPasses( aResult );
+}
+
+
+bool PNS_OPTIMIZER::Refine( PNS_LINE* aLine )
+{
+    if( !m_interrupted )
+        return false;
+
+    return runPasses( aLine );
+}
+
+
+bool PNS_OPTIMIZER::timeExpired()
+{
+    if( m_timeLimit.Get() > 0 && m_timeLimit.Expired() )
+        m_interrupted = true;
+
+    return m_interrupted;
+}
+
+
+bool PNS_OPTIMIZER::runPasses( PNS_LINE* aLine )
+{
+    const int passes[] = { MERGE_SEGMENTS, MERGE_OBTUSE, SMART_PADS, FANOUT_CLEANUP };
 
     bool rv = false;
 
-    if( m_effortLevel & MERGE_SEGMENTS )
-        rv |= mergeFull( aResult );
+    m_interrupted = false;
+    m_timeLimit.Restart();
+    m_maxCachedItems = CachedItemsPerSegment * aLine->SegmentCount();
+
+    if( m_maxCachedItems < MinCachedItems )
+        m_maxCachedItems = MinCachedItems;
 
-    if( m_effortLevel & MERGE_OBTUSE )
-        rv |= mergeObtuse( aResult );
+    // every pass only accepts changes which make the line better, so when the time is up
+    // the line is the best found so far and the remaining passes are left for Refine()
+    for( unsigned int i = 0; i < sizeof( passes ) / sizeof( passes[0] ); i++ )
+    {
+        int pass = passes[i];
+
+        if( !( m_effortLevel & pass ) || ( m_donePasses & pass ) )
+            continue;
 
-    if( m_effortLevel & SMART_PADS )
-        rv |= runSmartPads( aResult );
+        if( timeExpired() )
+            break;
 
-    if( m_effortLevel & FANOUT_CLEANUP )
-        rv |= fanoutCleanup( aResult );
+        switch( pass )
+        {
+        case MERGE_SEGMENTS:
+            rv |= mergeFull( aLine );
+            break;
+
+        case MERGE_OBTUSE:
+            rv |= mergeObtuse( aLine );
+            break;
+
+        case SMART_PADS:
+            rv |= runSmartPads( aLine );
+            break;
+
+        case FANOUT_CLEANUP:
+            rv |= fanoutCleanup( aLine );
+            break;
+        }
+
+        if( !m_interrupted )
+            m_donePasses |= pass;
+    }
 
     return rv;
 }
@@ -28,6 +28,7 @@
 #include <geometry/shape_line_chain.h>
 
 #include "range.h"
+#include "time_limit.h"
 
 class PNS_NODE;
 class PNS_ROUTER;
@@ -104,6 +105,29 @@ public:
     bool Optimize( PNS_LINE* aLine, PNS_LINE* aResult = NULL );
     bool Optimize( PNS_DIFF_PAIR* aPair );
 
+    /**
+     * Function Refine()
+     *
+     * Continues the optimization of a line, after the previous Optimize() or Refine() call
+     * has been interrupted by the time limit (see Interrupted()).
+     * @param aLine is the (partially optimized) line returned by the interrupted call.
+     * @return true, if the line has been changed.
+     */
+    bool Refine( PNS_LINE* aLine );
+
+    ///> Limits the time spent in each Optimize()/Refine() call, 0 for no limit. When the
+    ///> time is up, the passes stop and the line is left with the best shape found so far.
+    void SetTimeLimit( int aMilliseconds )
+    {
+        m_timeLimit.Set( aMilliseconds );
+    }
+
+    ///> Returns true if the last Optimize()/Refine() call has run out of time.
+    bool Interrupted() const
+    {
+        return m_interrupted;
+    }
+
 
     void SetWorld( PNS_NODE* aNode ) { m_world = aNode; }
     void CacheStaticItem( PNS_ITEM* aItem );
@@ -128,7 +152,9 @@ public:
     }
 
 private:
-    static const int MaxCachedItems = 256;
+    ///> Minimum size of the collision cache, grows with the number of segments of the line.
+    static const int MinCachedItems = 256;
+    static const int CachedItemsPerSegment = 16;
 
     typedef std::vector<SHAPE_LINE_CHAIN> BREAKOUT_LIST;
 
@@ -140,6 +166,10 @@ private:
         bool m_isStatic;
     };
 
+    bool runPasses( PNS_LINE* aLine );
+    bool timeExpired();
+    void pruneCache();
+
     bool mergeObtuse( PNS_LINE* aLine );
     bool mergeFull( PNS_LINE* aLine );
     bool removeUglyCorners( PNS_LINE* aLine );
@@ -176,6 +206,17 @@ private:
 
     BOX2I m_restrictArea;
     bool m_restrictAreaActive;
+
+    TIME_LIMIT m_timeLimit;
+    bool m_interrupted;
+
+    ///> passes (OptimizationEffort flags) completed on the line being optimized
+    int m_donePasses;
+
+    ///> merge step to resume the interrupted merge pass with, -1 to start from the longest one
+    int m_mergeStep;
+
+    int m_maxCachedItems;
 };
 
 #endif
@@ -75,6 +75,29 @@ public:
      */
     virtual bool FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem ) = 0;
 
+    /**
+     * Function NeedsRefinement()
+     *
+     * Returns true if the optimization of the trace has been cut short by the
+     * optimizer time limit during the last Move(), and can be continued with Refine().
+     */
+    virtual bool NeedsRefinement() const
+    {
+        return false;
+    }
+
+    /**
+     * Function Refine()
+     *
+     * Continues the optimization of the currently routed trace for a limited time.
+     * Meant to be called on idle events, as long as NeedsRefinement() returns true.
+     * @return true, if the trace has been changed.
+     */
+    virtual bool Refine()
+    {
+        return false;
+    }
+
     /**
      * Function ToggleVia()
      *
@@ -20,6 +20,7 @@
 
 #include <cstdio>
 #include <vector>
+#include <map>
 
 #include <boost/foreach.hpp>
 
@@ -39,6 +40,7 @@
 
 #include "trace.h"
 #include "pns_node.h"
+#include "pns_item_pool.h"
 #include "pns_line_placer.h"
 #include "pns_line.h"
 #include "pns_solid.h"
@@ -71,33 +73,54 @@ PNS_PCBNEW_CLEARANCE_FUNC::PNS_PCBNEW_CLEARANCE_FUNC( PNS_ROUTER* aRouter ) :
 {
     BOARD* brd = m_router->GetBoard();
     PNS_NODE* world = m_router->GetWorld();
+    NETCLASSES& netClasses = brd->GetDesignSettings().m_NetClasses;
 
     PNS_TOPOLOGY topo( world );
     m_clearanceCache.resize( brd->GetNetCount() );
     m_useDpGap = false;
+    m_defaultClearance = Millimeter2iu( 0.254 );    // aBoard->m_NetClasses.Find ("Default clearance")->GetClearance();
+
+    // class 0 is for the items without a net
+    std::vector<int> classClearances( 1, m_defaultClearance );
+    std::map<NETCLASS*, int> classIndex;
 
     for( unsigned int i = 0; i < brd->GetNetCount(); i++ )
     {
         NETINFO_ITEM* ni = brd->FindNet( i );
-        if( ni == NULL )
-            continue;
+        NETCLASSPTR nc = ni ? netClasses.Find( ni->GetClassName() ) : NETCLASSPTR();
+
+        if( !nc )
+            nc = netClasses.GetDefault();
 
         CLEARANCE_ENT ent;
-        ent.coupledNet = topo.DpCoupledNet( i );
+        ent.coupledNet = ni ? topo.DpCoupledNet( i ) : -1;
 
-        wxString netClassName = ni->GetClassName();
-        NETCLASSPTR nc = brd->GetDesignSettings().m_NetClasses.Find( netClassName );
+        std::map<NETCLASS*, int>::iterator cls = classIndex.find( nc.get() );
 
-        int clearance = nc->GetClearance();
-        ent.clearance = clearance;
+        if( cls == classIndex.end() )
+        {
+            cls = classIndex.insert( std::make_pair( nc.get(), (int) classClearances.size() ) ).first;
+            classClearances.push_back( nc->GetClearance() );
+        }
+
+        ent.netClass = cls->second;
         m_clearanceCache[i] = ent;
 
-        TRACE( 1, "Add net %d netclass %s clearance %d", i % netClassName.mb_str() %
-            clearance );
+        TRACE( 1, "Add net %d netclass %s clearance %d", i % nc->GetName().mb_str() %
+            nc->GetClearance() );
+    }
+
+    // the clearance between two classes is the biggest one
+    m_classCount = classClearances.size();
+    m_classMatrix.resize( m_classCount * m_classCount );
+
+    for( int a = 0; a < m_classCount; a++ )
+    {
+        for( int b = 0; b < m_classCount; b++ )
+            m_classMatrix[a * m_classCount + b] = std::max( classClearances[a], classClearances[b] );
     }
 
     m_overrideEnabled = false;
-    m_defaultClearance = Millimeter2iu( 0.254 );    // aBoard->m_NetClasses.Find ("Default clearance")->GetClearance();
     m_overrideNetA = 0;
     m_overrideNetB = 0;
     m_overrideClearance = 0;
@@ -111,7 +134,7 @@ PNS_PCBNEW_CLEARANCE_FUNC::~PNS_PCBNEW_CLEARANCE_FUNC()
 
 int PNS_PCBNEW_CLEARANCE_FUNC::localPadClearance( const PNS_ITEM* aItem ) const
 {
-    if( !aItem->Parent() || aItem->Parent()->Type() != PCB_PAD_T )
+    if( !aItem->OfKind( PNS_ITEM::SOLID ) || !aItem->Parent() || aItem->Parent()->Type() != PCB_PAD_T )
         return 0;
 
     const D_PAD* pad = static_cast<D_PAD*>( aItem->Parent() );
@@ -122,27 +145,45 @@ int PNS_PCBNEW_CLEARANCE_FUNC::localPadClearance( const PNS_ITEM* aItem ) const
 int PNS_PCBNEW_CLEARANCE_FUNC::operator()( const PNS_ITEM* aA, const PNS_ITEM* aB )
 {
     int net_a = aA->Net();
-    int cl_a = ( net_a >= 0 ? m_clearanceCache[net_a].clearance : m_defaultClearance );
     int net_b = aB->Net();
-    int cl_b = ( net_b >= 0 ? m_clearanceCache[net_b].clearance : m_defaultClearance );
-
-    bool linesOnly = aA->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE ) && aB->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE );
 
     if( net_a == net_b )
         return 0;
 
-    if( m_useDpGap && linesOnly && net_a >= 0 && net_b >= 0 && m_clearanceCache[net_a].coupledNet == net_b )
+    int class_a = netClass( net_a );
+    int class_b = netClass( net_b );
+
+    // a single lookup for the most common case: two items which are not pads
+    int cl = classClearance( class_a, class_b );
+
+    if( m_useDpGap && class_a && class_b && m_clearanceCache[net_a].coupledNet == net_b
+        && aA->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE )
+        && aB->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE ) )
     {
-        cl_a = cl_b = m_router->Sizes().DiffPairGap() - 2 * PNS_HULL_MARGIN;
+        cl = m_router->Sizes().DiffPairGap() - 2 * PNS_HULL_MARGIN;
     }
 
-    int pad_a = localPadClearance( aA );
-    int pad_b = localPadClearance( aB );
+    if( aA->OfKind( PNS_ITEM::SOLID ) || aB->OfKind( PNS_ITEM::SOLID ) )
+        cl = std::max( cl, std::max( localPadClearance( aA ), localPadClearance( aB ) ) );
 
-    cl_a = std::max( cl_a, pad_a );
-    cl_b = std::max( cl_b, pad_b );
+    return cl;
+}
+
+
+bool PNS_PCBNEW_CLEARANCE_FUNC::SameClearances( const PNS_PCBNEW_CLEARANCE_FUNC& aOther ) const
+{
+    if( m_clearanceCache.size() != aOther.m_clearanceCache.size() )
+        return false;
+
+    for( unsigned int i = 0; i < m_clearanceCache.size(); i++ )
+    {
+        int cl = classClearance( netClass( i ), netClass( i ) );
 
-    return std::max( cl_a, cl_b );
+        if( cl != aOther.classClearance( aOther.netClass( i ), aOther.netClass( i ) ) )
+            return false;
+    }
+
+    return true;
 }
 
 
@@ -386,21 +427,114 @@ PNS_ITEM* PNS_ROUTER::syncVia( VIA* aVia )
 }
 
 
+PNS_ITEM* PNS_ROUTER::syncItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    PNS_ITEM* item = NULL;
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+        item = syncPad( static_cast<D_PAD*>( aItem ) );
+        break;
+
+    case PCB_TRACE_T:
+        item = syncTrack( static_cast<TRACK*>( aItem ) );
+        break;
+
+    case PCB_VIA_T:
+        item = syncVia( static_cast<VIA*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+
+    if( !item )
+        return NULL;
+
+    m_world->Add( item );
+
+    // zero-length and redundant segments are not added to the world
+    if( !m_world->Contains( item ) )
+    {
+        delete item;
+        return NULL;
+    }
+
+    return item;
+}
+
+
 void PNS_ROUTER::SetBoard( BOARD* aBoard )
 {
+    if( m_board == aBoard )
+        return;
+
+    if( m_board )
+        m_board->RemoveListener( this );
+
     m_board = aBoard;
+    m_worldDirty = true;
+
+    if( m_board )
+        m_board->AddListener( this );
+
     TRACE( 1, "m_board = %p\n", m_board );
 }
 
 
-void PNS_ROUTER::SyncWorld()
+void PNS_ROUTER::markDirty( BOARD_ITEM* aItem )
 {
-    if( !m_board )
+    switch( aItem->Type() )
     {
-        TRACEn( 0, "No board attached, aborting sync." );
-        return;
+    case PCB_MODULE_T:
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+            m_dirtyItems.insert( pad );
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        m_dirtyItems.insert( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
     }
+}
 
+
+void PNS_ROUTER::OnBoardItemAdded( BOARD_ITEM* aItem )
+{
+    markDirty( aItem );
+}
+
+
+void PNS_ROUTER::OnBoardItemChanged( BOARD_ITEM* aItem )
+{
+    markDirty( aItem );
+}
+
+
+void PNS_ROUTER::OnBoardChanged()
+{
+    m_worldDirty = true;
+}
+
+
+void PNS_ROUTER::OnBoardDestroyed()
+{
+    // the world items refer to the board items, it cannot be updated anymore
+    m_board = NULL;
+    m_worldDirty = true;
+    m_syncedItems.clear();
+    m_dirtyItems.clear();
+}
+
+
+void PNS_ROUTER::rebuildWorld()
+{
     ClearWorld();
 
     m_world = new PNS_NODE();
@@ -409,29 +543,134 @@ void PNS_ROUTER::SyncWorld()
     {
         for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
         {
-            PNS_ITEM* solid = syncPad( pad );
+            PNS_ITEM* solid = syncItem( pad );
 
             if( solid )
-                m_world->Add( solid );
+                m_syncedItems[pad] = solid;
         }
     }
 
     for( TRACK* t = m_board->m_Track; t; t = t->Next() )
     {
-        KICAD_T type = t->Type();
+        PNS_ITEM* item = syncItem( t );
+
+        if( item )
+            m_syncedItems[t] = item;
+    }
+}
+
+
+void PNS_ROUTER::updateWorld()
+{
+    SYNCED_ITEMS synced;
+
+    // Walk through the board (which is cheap compared to creating the world items), so the
+    // dirty items are only looked up among the items which are still on the board.
+    // The world items of the board items not found any more are removed afterwards.
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+        {
+            SYNCED_ITEMS::iterator it = m_syncedItems.find( pad );
+            PNS_ITEM* item = NULL;
+
+            if( it != m_syncedItems.end() )
+            {
+                item = it->second;
+                m_syncedItems.erase( it );
+
+                if( m_dirtyItems.find( pad ) != m_dirtyItems.end() )
+                {
+                    m_world->Remove( item );
+                    item = syncItem( pad );
+                }
+            }
+            else
+            {
+                item = syncItem( pad );
+            }
+
+            if( item )
+                synced[pad] = item;
+        }
+    }
+
+    for( TRACK* t = m_board->m_Track; t; t = t->Next() )
+    {
+        SYNCED_ITEMS::iterator it = m_syncedItems.find( t );
         PNS_ITEM* item = NULL;
 
-        if( type == PCB_TRACE_T )
-            item = syncTrack( t );
-        else if( type == PCB_VIA_T )
-            item = syncVia( static_cast<VIA*>( t ) );
+        if( it != m_syncedItems.end() )
+        {
+            item = it->second;
+            m_syncedItems.erase( it );
+
+            if( m_dirtyItems.find( t ) != m_dirtyItems.end() )
+            {
+                m_world->Remove( item );
+                item = syncItem( t );
+            }
+        }
+        else
+        {
+            item = syncItem( t );
+        }
 
         if( item )
-            m_world->Add( item );
+            synced[t] = item;
     }
 
+    for( SYNCED_ITEMS::iterator it = m_syncedItems.begin(); it != m_syncedItems.end(); ++it )
+        m_world->Remove( it->second );
+
+    m_syncedItems.swap( synced );
+}
+
+
+void PNS_ROUTER::SyncWorld()
+{
+    if( !m_board )
+    {
+        TRACEn( 0, "No board attached, aborting sync." );
+        return;
+    }
+
+    // the synced router becomes the one used for debug drawing and topology queries
+    theRouter = this;
+
     int worstClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
-    m_clearanceFunc = new PNS_PCBNEW_CLEARANCE_FUNC( this );
+    PNS_PCBNEW_CLEARANCE_FUNC* clearanceFunc = NULL;
+
+    // The world has to be rebuilt from scratch if the design rules have changed
+    if( m_world && !m_worldDirty )
+    {
+        clearanceFunc = new PNS_PCBNEW_CLEARANCE_FUNC( this );
+
+        if( m_world->GetMaxClearance() != 4 * worstClearance || !m_clearanceFunc
+                || !clearanceFunc->SameClearances( *m_clearanceFunc ) )
+            m_worldDirty = true;
+    }
+
+    if( !m_world || m_worldDirty )
+    {
+        TRACEn( 1, "Rebuilding the world." );
+        rebuildWorld();
+    }
+    else
+    {
+        m_world->KillChildren();
+        updateWorld();
+        delete m_clearanceFunc;
+    }
+
+    m_dirtyItems.clear();
+    m_worldDirty = false;
+
+    // net names (thus coupled nets) may have changed, even if the clearances have not
+    if( !clearanceFunc )
+        clearanceFunc = new PNS_PCBNEW_CLEARANCE_FUNC( this );
+
+    m_clearanceFunc = clearanceFunc;
     m_world->SetClearanceFunctor( m_clearanceFunc );
     m_world->SetMaxClearance( 4 * worstClearance );
 }
@@ -447,6 +686,7 @@ PNS_ROUTER::PNS_ROUTER()
     m_world = NULL;
     m_placer = NULL;
     m_previewItems = NULL;
+    m_debugGraphics = true;
     m_board = NULL;
     m_dragger = NULL;
     m_mode = PNS_MODE_ROUTE_SINGLE;
@@ -461,7 +701,9 @@ PNS_ROUTER::PNS_ROUTER()
     m_snappingEnabled  = false;
     m_violation = false;
     m_gridHelper = NULL;
-
+    m_worldDirty = true;
+    m_recordEvents = false;
+    m_shoveIterations = 0;
 }
 
 
@@ -489,6 +731,9 @@ PNS_ROUTER* PNS_ROUTER::GetInstance()
 
 PNS_ROUTER::~PNS_ROUTER()
 {
+    if( m_board )
+        m_board->RemoveListener( this );
+
     ClearWorld();
     theRouter = NULL;
 
@@ -518,6 +763,9 @@ void PNS_ROUTER::ClearWorld()
     m_world = NULL;
     m_placer = NULL;
     m_previewItems = NULL;
+
+    m_syncedItems.clear();
+    m_worldDirty = true;
 }
 
 
@@ -574,7 +822,12 @@ const VECTOR2I PNS_ROUTER::SnapToItem( PNS_ITEM* aItem, VECTOR2I aP, bool& aSpli
             anchor = s.B;
         else
         {
-            anchor = m_gridHelper->AlignToSegment ( aP, s );
+            // no grid without an editor frame (e.g. when replaying a routing session)
+            if( m_gridHelper )
+                anchor = m_gridHelper->AlignToSegment ( aP, s );
+            else
+                anchor = s.NearestPoint( aP );
+
             aSplitsSegment = (anchor != s.A && anchor != s.B );
         }
 
@@ -591,6 +844,8 @@ const VECTOR2I PNS_ROUTER::SnapToItem( PNS_ITEM* aItem, VECTOR2I aP, bool& aSpli
 
 bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 {
+    logEvent( PNS_LOGGER::EVT_START_DRAG, aP, aStartItem, m_settings.Mode(), m_snappingEnabled );
+
     if( !aStartItem || aStartItem->OfKind( PNS_ITEM::SOLID ) )
         return false;
 
@@ -611,42 +866,58 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 
 bool PNS_ROUTER::StartRouting( const VECTOR2I& aP, PNS_ITEM* aStartItem, int aLayer )
 {
+    logEvent( PNS_LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer, m_mode, m_settings.Mode(),
+              m_snappingEnabled );
+
+    m_placer = CreatePlacer( m_mode, aLayer );
+
+    if( !m_placer )
+        return false;
+
+    bool rv = m_placer->Start( aP, aStartItem );
+
+    if( !rv )
+        return false;
+
+    m_currentEnd = aP;
+    m_state = ROUTE_TRACK;
+    return rv;
+}
+
+
+PNS_PLACEMENT_ALGO* PNS_ROUTER::CreatePlacer( PNS_ROUTER_MODE aMode, int aLayer )
+{
+    PNS_PLACEMENT_ALGO* placer;
+
     m_clearanceFunc->UseDpGap( false );
 
-    switch( m_mode )
+    switch( aMode )
     {
     case PNS_MODE_ROUTE_SINGLE:
-        m_placer = new PNS_LINE_PLACER( this );
+        placer = new PNS_LINE_PLACER( this );
         break;
     case PNS_MODE_ROUTE_DIFF_PAIR:
-        m_placer = new PNS_DIFF_PAIR_PLACER( this );
+        placer = new PNS_DIFF_PAIR_PLACER( this );
         m_clearanceFunc->UseDpGap( true );
         break;
     case PNS_MODE_TUNE_SINGLE:
-        m_placer = new PNS_MEANDER_PLACER( this );
+        placer = new PNS_MEANDER_PLACER( this );
         break;
     case PNS_MODE_TUNE_DIFF_PAIR:
-        m_placer = new PNS_DP_MEANDER_PLACER( this );
+        placer = new PNS_DP_MEANDER_PLACER( this );
         break;
     case PNS_MODE_TUNE_DIFF_PAIR_SKEW:
-        m_placer = new PNS_MEANDER_SKEW_PLACER( this );
+        placer = new PNS_MEANDER_SKEW_PLACER( this );
         break;
 
     default:
-        return false;
+        return NULL;
     }
 
-    m_placer->UpdateSizes ( m_sizes );
-    m_placer->SetLayer( aLayer );
-
-    bool rv = m_placer->Start( aP, aStartItem );
+    placer->UpdateSizes ( m_sizes );
+    placer->SetLayer( aLayer );
 
-    if( !rv )
-        return false;
-
-    m_currentEnd = aP;
-    m_state = ROUTE_TRACK;
-    return rv;
+    return placer;
 }
 
 
@@ -675,6 +946,9 @@ void PNS_ROUTER::eraseView()
 
 void PNS_ROUTER::DisplayItem( const PNS_ITEM* aItem, int aColor, int aClearance )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -699,6 +973,9 @@ void PNS_ROUTER::DisplayItems( const PNS_ITEMSET& aItems )
 
 void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth )
 {
+    if( !m_previewItems || !m_debugGraphics )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Line( aLine, aWidth, aType );
@@ -710,6 +987,9 @@ void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int
 
 void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 {
+    if( !m_previewItems || !m_debugGraphics )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Point( aPos, aType );
@@ -721,8 +1001,14 @@ void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 
 void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
 {
+    logEvent( PNS_LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
+#ifdef PNS_DEBUG
+    const PNS_ITEM_POOL::STATS before = PNS_ITEM_POOL::Instance().Stats();
+#endif
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -736,6 +1022,36 @@ void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
     default:
         break;
     }
+
+#ifdef PNS_DEBUG
+    const PNS_ITEM_POOL::STATS after = PNS_ITEM_POOL::Instance().Stats();
+
+    TRACE( 1, "item allocations: %lld (heap chunks: %lld), live items: %lld",
+           ( after.m_allocations - before.m_allocations ) %
+           ( after.m_heapAllocations - before.m_heapAllocations ) % after.m_liveBlocks );
+#endif
+}
+
+
+bool PNS_ROUTER::RefineRoute()
+{
+    if( m_state != ROUTE_TRACK || !m_placer->NeedsRefinement() )
+        return false;
+
+    eraseView();
+
+    bool changed = m_placer->Refine();
+
+    // the preview is the same if nothing has changed, so there is no need to repaint it
+    updatePlacingView();
+
+    return changed;
+}
+
+
+bool PNS_ROUTER::RefinementPending() const
+{
+    return m_state == ROUTE_TRACK && m_placer->NeedsRefinement();
 }
 
 
@@ -818,6 +1134,9 @@ void PNS_ROUTER::updateView( PNS_NODE* aNode, PNS_ITEMSET& aCurrent )
 
 void PNS_ROUTER::UpdateSizes ( const PNS_SIZES_SETTINGS& aSizes )
 {
+    logEvent( PNS_LOGGER::EVT_SIZES, VECTOR2I(), NULL, aSizes.TrackWidth(),
+              aSizes.ViaDiameter(), aSizes.ViaDrill() );
+
     m_sizes = aSizes;
 
     // Change track/via size settings
@@ -833,6 +1152,12 @@ void PNS_ROUTER::movePlacing( const VECTOR2I& aP, PNS_ITEM* aEndItem )
     eraseView();
 
     m_placer->Move( aP, aEndItem );
+    updatePlacingView();
+}
+
+
+void PNS_ROUTER::updatePlacingView()
+{
     PNS_ITEMSET current = m_placer->Traces();
 
     BOOST_FOREACH( const PNS_ITEM* item, current.CItems() )
@@ -865,9 +1190,12 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
 
         if( parent )
         {
-            m_view->Remove( parent );
+            if( m_view )
+                m_view->Remove( parent );
+
             m_board->Remove( parent );
             m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
+            m_syncedItems.erase( parent );
         }
     }
 
@@ -915,10 +1243,17 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
         {
             item->SetParent( newBI );
             newBI->ClearFlags();
-            m_view->Add( newBI );
+
+            if( m_view )
+                m_view->Add( newBI );
+
             m_board->Add( newBI );
             m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
             newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
+
+            // the item is committed to the world below, it is already in sync
+            m_syncedItems[newBI] = item;
+            m_dirtyItems.erase( newBI );
         }
     }
 
@@ -931,6 +1266,8 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
     bool rv = false;
 
+    logEvent( PNS_LOGGER::EVT_FIX, aP, aEndItem );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -961,16 +1298,15 @@ void PNS_ROUTER::StopRouting()
         std::vector<int> nets;
         m_placer->GetModifiedNets( nets );
 
-        BOOST_FOREACH ( int n, nets )
-        {
-            // Update the ratsnest with new changes
-            m_board->GetRatsnest()->Recalculate( n );
-        }
+        // Update the ratsnest with new changes
+        m_board->GetRatsnest()->Recalculate( nets );
     }
 
     if( !RoutingInProgress() )
         return;
 
+    logEvent( PNS_LOGGER::EVT_STOP );
+
     if( m_placer )
         delete m_placer;
 
@@ -990,6 +1326,8 @@ void PNS_ROUTER::StopRouting()
 
 void PNS_ROUTER::FlipPosture()
 {
+    logEvent( PNS_LOGGER::EVT_FLIP_POSTURE );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -999,6 +1337,8 @@ void PNS_ROUTER::FlipPosture()
 
 void PNS_ROUTER::SwitchLayer( int aLayer )
 {
+    logEvent( PNS_LOGGER::EVT_SWITCH_LAYER, VECTOR2I(), NULL, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -1012,6 +1352,8 @@ void PNS_ROUTER::SwitchLayer( int aLayer )
 
 void PNS_ROUTER::ToggleViaPlacement()
 {
+    logEvent( PNS_LOGGER::EVT_TOGGLE_VIA );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -1057,6 +1399,20 @@ void PNS_ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    if( m_recordEvents )
+    {
+        m_eventLog.Save( "/tmp/pns_events.log" );
+        m_eventLog.Clear();
+    }
+}
+
+
+void PNS_ROUTER::logEvent( PNS_LOGGER::EVENT_TYPE aType, const VECTOR2I& aP,
+                           const PNS_ITEM* aItem, int aArg0, int aArg1, int aArg2, int aArg3 )
+{
+    if( m_recordEvents )
+        m_eventLog.LogEvent( aType, aP, aItem, aArg0, aArg1, aArg2, aArg3 );
 }
 
 
@@ -25,18 +25,22 @@
 
 #include <boost/optional.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <geometry/shape_line_chain.h>
 #include <class_undoredo_container.h>
+#include <board_listener.h>
 
 #include "pns_routing_settings.h"
 #include "pns_sizes_settings.h"
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 class BOARD;
 class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
 class D_PAD;
 class TRACK;
 class VIA;
@@ -74,8 +78,12 @@ enum PNS_ROUTER_MODE {
  * Class PNS_ROUTER
  *
  * Main router class.
+ * The world (the root PNS_NODE) is built once from the board and then kept in sync
+ * with the board changes reported to the router (see BOARD_LISTENER), so that
+ * SyncWorld() only re-creates the items which were added or modified since the
+ * previous call.
  */
-class PNS_ROUTER
+class PNS_ROUTER : public BOARD_LISTENER
 {
 private:
     enum RouterState
@@ -96,15 +104,54 @@ public:
 
     void ClearWorld();
     void SetBoard( BOARD* aBoard );
+
+    /**
+     * Function SyncWorld()
+     * updates the world with the board changes since the previous call. The world is
+     * built from scratch the first time, and when the design rules or the whole board
+     * (e.g. after a netlist update) have changed.
+     */
     void SyncWorld();
 
+    ///> BOARD_LISTENER notifications, used to track the items to be synced.
+    void OnBoardItemAdded( BOARD_ITEM* aItem );
+    void OnBoardItemChanged( BOARD_ITEM* aItem );
+    void OnBoardChanged();
+    void OnBoardDestroyed();
+
     void SetView( KIGFX::VIEW* aView );
 
     bool RoutingInProgress() const;
     bool StartRouting( const VECTOR2I& aP, PNS_ITEM* aItem, int aLayer );
+
+    /**
+     * Function CreatePlacer()
+     * creates a placement algorithm for a routing or tuning mode, set up with the current
+     * sizes. It is used by StartRouting() and by tools which run several placers at a time
+     * (see PNS_BATCH_TUNER).
+     * @return the new placer (to be deleted by the caller), or NULL for an invalid mode.
+     */
+    PNS_PLACEMENT_ALGO* CreatePlacer( PNS_ROUTER_MODE aMode, int aLayer );
     void Move( const VECTOR2I& aP, PNS_ITEM* aItem );
     bool FixRoute( const VECTOR2I& aP, PNS_ITEM* aItem );
 
+    /**
+     * Function RefineRoute()
+     *
+     * Continues the optimization of the routed trace, if it has been interrupted by the
+     * optimizer time limit, and updates the preview. Meant to be called on idle events.
+     * @return true, if the trace (and so the preview) has changed.
+     */
+    bool RefineRoute();
+
+    /**
+     * Function RefinementPending()
+     *
+     * Returns true if RefineRoute() has some work left, even if the last call has not
+     * changed the trace.
+     */
+    bool RefinementPending() const;
+
     void StopRouting();
 
     int GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const;
@@ -123,6 +170,13 @@ public:
     void DisplayDebugPoint( const VECTOR2I aPos, int aType = 0 );
     void DisplayDebugBox( const BOX2I& aBox, int aType = 0, int aWidth = 0 );
 
+    ///> Enables or disables the debug graphics, which must be disabled while placers
+    ///> run in several threads (the view is not thread safe).
+    void EnableDebugGraphics( bool aEnable )
+    {
+        m_debugGraphics = aEnable;
+    }
+
     void SwitchLayer( int layer );
 
     void ToggleViaPlacement();
@@ -131,8 +185,51 @@ public:
     int GetCurrentLayer() const;
     const std::vector<int> GetCurrentNets() const;
 
+    /**
+     * Function DumpLog()
+     * saves the log of the current drag/route operation and, if the events are being recorded,
+     * the event log. The event log is cleared afterwards, so the next dump contains only
+     * the events recorded since this one.
+     */
     void DumpLog();
 
+    /**
+     * Function RecordEvents()
+     * enables or disables recording of the routing commands (start, moves, layer switches,
+     * fix...) into EventLog(), so that the routing session can be replayed later
+     * (see tools/router_bench.cpp). Recording is disabled by default, a new recording starts
+     * with an empty log. The log is saved by DumpLog().
+     */
+    void RecordEvents( bool aEnable )
+    {
+        if( aEnable && !m_recordEvents )
+            m_eventLog.Clear();
+
+        m_recordEvents = aEnable;
+    }
+
+    bool IsRecordingEvents() const
+    {
+        return m_recordEvents;
+    }
+
+    PNS_LOGGER& EventLog()
+    {
+        return m_eventLog;
+    }
+
+    ///> Adds aCount to the number of shove iterations, reported by ShoveIterations()
+    void CountShoveIterations( int aCount )
+    {
+        m_shoveIterations += aCount;
+    }
+
+    ///> Returns the number of shove iterations since the router creation (for profiling)
+    long long ShoveIterations() const
+    {
+        return m_shoveIterations;
+    }
+
     PNS_CLEARANCE_FUNC* GetClearanceFunc() const
     {
         return m_clearanceFunc;
@@ -222,7 +319,10 @@ public:
     }
 
 private:
+    typedef boost::unordered_map<BOARD_CONNECTED_ITEM*, PNS_ITEM*> SYNCED_ITEMS;
+
     void movePlacing( const VECTOR2I& aP, PNS_ITEM* aItem );
+    void updatePlacingView();
     void moveDragging( const VECTOR2I& aP, PNS_ITEM* aItem );
 
     void eraseView();
@@ -239,6 +339,20 @@ private:
     PNS_ITEM* syncTrack( TRACK* aTrack );
     PNS_ITEM* syncVia( VIA* aVia );
 
+    ///> Creates the world item of a pad, track or via and adds it to the world.
+    ///> Returns the item, or NULL if the board item is ignored by the router.
+    PNS_ITEM* syncItem( BOARD_CONNECTED_ITEM* aItem );
+
+    ///> Builds the world from scratch.
+    void rebuildWorld();
+
+    ///> Updates the world items of the board items added, modified or removed since
+    ///> the last sync.
+    void updateWorld();
+
+    ///> Marks a pad, track or via (or the pads of a footprint) as to be synced.
+    void markDirty( BOARD_ITEM* aItem );
+
     void commitPad( PNS_SOLID* aPad );
     void commitSegment( PNS_SEGMENT* aTrack );
     void commitVia( PNS_VIA* aVia );
@@ -247,6 +361,10 @@ private:
 
     void markViolations( PNS_NODE* aNode, PNS_ITEMSET& aCurrent, PNS_NODE::ITEM_VECTOR& aRemoved );
 
+    void logEvent( PNS_LOGGER::EVENT_TYPE aType, const VECTOR2I& aP = VECTOR2I(),
+                   const PNS_ITEM* aItem = NULL, int aArg0 = 0, int aArg1 = 0, int aArg2 = 0,
+                   int aArg3 = 0 );
+
     VECTOR2I m_currentEnd;
     RouterState m_state;
 
@@ -262,6 +380,7 @@ private:
 
     KIGFX::VIEW* m_view;
     KIGFX::VIEW_GROUP* m_previewItems;
+    bool m_debugGraphics;
 
     bool m_snappingEnabled;
     bool m_violation;
@@ -269,6 +388,16 @@ private:
     PNS_ROUTING_SETTINGS m_settings;
     PNS_PCBNEW_CLEARANCE_FUNC* m_clearanceFunc;
 
+    ///> World items of the synced board items (not owned, they belong to m_world)
+    SYNCED_ITEMS m_syncedItems;
+
+    ///> Board items added or modified since the last sync (may be deleted already,
+    ///> so they are only used as keys)
+    boost::unordered_set<BOARD_CONNECTED_ITEM*> m_dirtyItems;
+
+    ///> The whole world has to be rebuilt on the next sync
+    bool m_worldDirty;
+
     boost::unordered_set<BOARD_CONNECTED_ITEM*> m_hiddenItems;
 
     ///> Stores list of modified items in the current operation
@@ -280,6 +409,10 @@ private:
     wxString m_failureReason;
 
     GRID_HELPER *m_gridHelper;
+
+    bool m_recordEvents;
+    PNS_LOGGER m_eventLog;
+    long long m_shoveIterations;
 };
 
 #endif
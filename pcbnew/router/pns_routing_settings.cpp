@@ -36,6 +36,7 @@ PNS_ROUTING_SETTINGS::PNS_ROUTING_SETTINGS()
     m_shoveIterationLimit = 250;
     m_shoveTimeLimit = 1000;
     m_walkaroundIterationLimit = 40;
+    m_optimizerTimeLimit = 20;
     m_jumpOverObstacles = false;
     m_smoothDraggedSegments = true;
     m_canViolateDRC = false;
@@ -55,6 +56,7 @@ void PNS_ROUTING_SETTINGS::Save( TOOL_SETTINGS& aSettings ) const
     aSettings.Set( "ShoveTimeLimit", m_shoveTimeLimit.Get() );
     aSettings.Set( "ShoveIterationLimit", m_shoveIterationLimit );
     aSettings.Set( "WalkaroundIterationLimit", m_walkaroundIterationLimit );
+    aSettings.Set( "OptimizerTimeLimit", m_optimizerTimeLimit );
     aSettings.Set( "JumpOverObstacles", m_jumpOverObstacles );
     aSettings.Set( "SmoothDraggedSegments", m_smoothDraggedSegments );
     aSettings.Set( "CanViolateDRC", m_canViolateDRC );
@@ -75,6 +77,7 @@ void PNS_ROUTING_SETTINGS::Load( const TOOL_SETTINGS& aSettings )
     m_shoveTimeLimit.Set( aSettings.Get( "ShoveTimeLimit", 1000 ) );
     m_shoveIterationLimit = aSettings.Get( "ShoveIterationLimit", 250 );
     m_walkaroundIterationLimit = aSettings.Get( "WalkaroundIterationLimit", 50 );
+    m_optimizerTimeLimit = aSettings.Get( "OptimizerTimeLimit", 20 );
     m_jumpOverObstacles = aSettings.Get( "JumpOverObstacles", false  );
     m_smoothDraggedSegments = aSettings.Get( "SmoothDraggedSegments", true );
     m_canViolateDRC = aSettings.Get( "CanViolateDRC", false );
@@ -68,6 +68,13 @@ public:
     ///> Returns the optimizer effort. Bigger means cleaner traces, but slower routing.
     PNS_OPTIMIZATION_EFFORT OptimizerEffort() const { return m_optimizerEffort; }
 
+    ///> Returns the time (in ms) the optimizer may spend on each routing step, 0 for no limit.
+    ///> The optimization of the trace is continued on idle events when it is exceeded.
+    int OptimizerTimeLimit() const { return m_optimizerTimeLimit; }
+
+    ///> Sets the time (in ms) the optimizer may spend on each routing step.
+    void SetOptimizerTimeLimit( int aMilliseconds ) { m_optimizerTimeLimit = aMilliseconds; }
+
     ///> Sets the optimizer effort. Bigger means cleaner traces, but slower routing.
     void SetOptimizerEffort( PNS_OPTIMIZATION_EFFORT aEffort ) { m_optimizerEffort = aEffort; }
 
@@ -151,6 +158,7 @@ private:
 
     int m_walkaroundIterationLimit;
     int m_shoveIterationLimit;
+    int m_optimizerTimeLimit;
     TIME_LIMIT m_shoveTimeLimit;
     TIME_LIMIT m_walkaroundTimeLimit;
 };
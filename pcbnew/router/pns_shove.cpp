@@ -1024,6 +1024,8 @@ PNS_SHOVE::SHOVE_STATUS PNS_SHOVE::shoveMainLoop()
         }
     }
 
+    Router()->CountShoveIterations( m_iter );
+
     return st;
 }
 
@@ -90,9 +90,6 @@ PNS_TOOL_BASE::~PNS_TOOL_BASE()
 
 void PNS_TOOL_BASE::Reset( RESET_REASON aReason )
 {
-    if( m_router )
-        delete m_router;
-
     if( m_gridHelper)
         delete m_gridHelper;
 
@@ -100,10 +97,22 @@ void PNS_TOOL_BASE::Reset( RESET_REASON aReason )
     m_ctls = getViewControls();
     m_board = getModel<BOARD>();
 
-    m_router = new PNS_ROUTER;
+    // The router world is kept between the tool runs and updated with the board changes,
+    // it is created from scratch only for a new board or after switching the canvas
+    if( m_router && ( aReason != RUN || m_router->GetBoard() != m_board ) )
+    {
+        delete m_router;
+        m_router = NULL;
+    }
+
+    if( !m_router )
+    {
+        m_router = new PNS_ROUTER;
+
+        m_router->ClearWorld();
+        m_router->SetBoard( m_board );
+    }
 
-    m_router->ClearWorld();
-    m_router->SetBoard( m_board );
     m_router->SyncWorld();
     m_router->LoadSettings( m_savedSettings );
     m_router->UpdateSizes( m_savedSizes );
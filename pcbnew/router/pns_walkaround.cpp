@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <climits>
+
 #include <boost/foreach.hpp>
 #include <boost/optional.hpp>
 
@@ -31,8 +33,9 @@ using boost::optional;
 
 void PNS_WALKAROUND::start( const PNS_LINE& aInitialPath )
 {
-    m_iteration = 0;
+    m_iteration[0] = m_iteration[1] = 0;
     m_iterationLimit = 50;
+    m_doneIteration = INT_MAX;
 }
 
 
@@ -57,6 +60,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
+    int& blockage_count = aWindingDirection ? m_recursiveBlockageCount[0] : m_recursiveBlockageCount[1];
 
     if( !current_obs )
         return DONE;
@@ -67,9 +71,9 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( blockage_count < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -84,12 +88,18 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_walkaround_log )
+#endif /* USE_OPENMP */
+    {
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw",
+                           m_iteration[aWindingDirection ? 0 : 1] );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -140,6 +150,56 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 }
 
 
+void PNS_WALKAROUND::setDoneIteration( int aIteration )
+{
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_walkaround_done )
+#endif /* USE_OPENMP */
+    {
+        if( aIteration < m_doneIteration )
+            m_doneIteration = aIteration;
+    }
+}
+
+
+int PNS_WALKAROUND::doneIteration()
+{
+    int iteration;
+
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_walkaround_done )
+#endif /* USE_OPENMP */
+    iteration = m_doneIteration;
+
+    return iteration;
+}
+
+
+void PNS_WALKAROUND::walkDirection( PNS_LINE& aPath, WALKAROUND_STATUS& aStatus,
+                                    bool aWindingDirection )
+{
+    int& iteration = aWindingDirection ? m_iteration[0] : m_iteration[1];
+
+    while( aStatus == IN_PROGRESS && iteration < m_iterationLimit )
+    {
+        aStatus = singleStep( aPath, aWindingDirection );
+
+        if( aStatus == DONE )
+        {
+            setDoneIteration( iteration );
+            break;
+        }
+
+        iteration++;
+
+        // The other direction has got around the obstacles in less steps, this one
+        // can't be picked anymore (unless the longer path is requested).
+        if( !m_forceLongerPath && iteration > doneIteration() )
+            break;
+    }
+}
+
+
 PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitialPath,
         PNS_LINE& aWalkPath, bool aOptimize )
 {
@@ -160,7 +220,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -173,50 +233,37 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
-
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
-
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
+    // Both directions only read the world, so they are walked at the same time. The result
+    // does not depend on which thread finishes first: a direction is given up only when the
+    // other one got around the obstacles in less steps, as if they were walked in turns.
+    bool parallel = s_cw == IN_PROGRESS && s_ccw == IN_PROGRESS;
 
-        m_iteration++;
+#ifdef USE_OPENMP
+    #pragma omp parallel sections num_threads( 2 ) if( parallel )
+#endif /* USE_OPENMP */
+    {
+#ifdef USE_OPENMP
+        #pragma omp section
+#endif /* USE_OPENMP */
+        walkDirection( path_cw, s_cw, true );
+
+#ifdef USE_OPENMP
+        #pragma omp section
+#endif /* USE_OPENMP */
+        walkDirection( path_ccw, s_ccw, false );
     }
 
-    if( m_iteration == m_iterationLimit )
-    {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
+    int len_cw  = path_cw.CLine().Length();
+    int len_ccw = path_ccw.CLine().Length();
 
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-        else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
-    }
+    if( m_forceLongerPath )
+        aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+    else if( s_cw == DONE && ( s_ccw != DONE || m_iteration[0] < m_iteration[1] ) )
+        aWalkPath = path_cw;
+    else if( s_ccw == DONE && ( s_cw != DONE || m_iteration[1] < m_iteration[0] ) )
+        aWalkPath = path_ccw;
+    else
+        aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
 
     if( m_cursorApproachMode )
     {
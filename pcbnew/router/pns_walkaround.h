@@ -46,9 +46,10 @@ public:
         m_itemMask = PNS_ITEM::ANY;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
-        m_iteration = 0;
+        m_iteration[0] = m_iteration[1] = 0;
+        m_doneIteration = 0;
         m_forceCw = false;
     }
 
@@ -127,13 +128,21 @@ private:
     void start( const PNS_LINE& aInitialPath );
 
     WALKAROUND_STATUS singleStep( PNS_LINE& aPath, bool aWindingDirection );
+    void walkDirection( PNS_LINE& aPath, WALKAROUND_STATUS& aStatus, bool aWindingDirection );
     PNS_NODE::OPT_OBSTACLE nearestObstacle( const PNS_LINE& aPath );
 
+    void setDoneIteration( int aIteration );
+    int doneIteration();
+
     PNS_NODE* m_world;
 
-    int m_recursiveBlockageCount;
-    int m_iteration;
+    int m_recursiveBlockageCount[2];
+    int m_iteration[2];
     int m_iterationLimit;
+
+    ///> first iteration at which one of the directions got around all the obstacles
+    int m_doneIteration;
+
     int m_itemMask;
     bool m_forceSingleDirection, m_forceLongerPath;
     bool m_cursorApproachMode;
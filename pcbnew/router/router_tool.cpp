@@ -233,12 +233,19 @@ private:
 
 ROUTER_TOOL::~ROUTER_TOOL()
 {
+    getEditFrame<wxWindow>()->Unbind( wxEVT_IDLE, &ROUTER_TOOL::onIdle, this );
+
     m_savedSettings.Save( GetSettings() );
 }
 
 bool ROUTER_TOOL::Init()
 {
     m_savedSettings.Load( GetSettings() );
+
+    // the optimizer may be interrupted by its time limit while the mouse moves,
+    // the routed trace is refined when the application is idle
+    getEditFrame<wxWindow>()->Bind( wxEVT_IDLE, &ROUTER_TOOL::onIdle, this );
+
     return true;
 }
 
@@ -299,6 +306,21 @@ void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
             TRACEn( 2, "saving drag/route log...\n" );
             m_router->DumpLog();
             break;
+
+        case '9':
+            // starts recording the routing events, or saves the recorded ones and stops
+            if( m_router->IsRecordingEvents() )
+            {
+                TRACEn( 2, "saving event log...\n" );
+                m_router->DumpLog();
+                m_router->RecordEvents( false );
+            }
+            else
+            {
+                TRACEn( 2, "recording events...\n" );
+                m_router->RecordEvents( true );
+            }
+            break;
         }
     }
     else
@@ -544,6 +566,23 @@ bool ROUTER_TOOL::finishInteractive()
 }
 
 
+void ROUTER_TOOL::onIdle( wxIdleEvent& aEvent )
+{
+    aEvent.Skip();
+
+    if( !m_router || !m_router->RoutingInProgress() )
+        return;
+
+    if( m_router->RefineRoute() )
+        m_frame->GetGalCanvas()->Refresh();
+
+    // keep the idle events coming until the trace is fully optimized, even if the last
+    // time slice has not changed it
+    if( m_router->RefinementPending() )
+        aEvent.RequestMore();
+}
+
+
 void ROUTER_TOOL::performRouting()
 {
     if( !prepareInteractive() )
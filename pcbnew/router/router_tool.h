@@ -58,6 +58,10 @@ private:
 
     bool prepareInteractive();
     bool finishInteractive();
+
+    ///> Continues the optimization of the routed trace when the application is idle.
+    ///> Bound to the frame for the tool lifetime, it does nothing unless a trace is being routed.
+    void onIdle( wxIdleEvent& aEvent );
 };
 
 #endif
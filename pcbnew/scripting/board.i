@@ -72,6 +72,11 @@
 %template(VIA_DIMENSION_Vector) std::vector<VIA_DIMENSION>;
 %template (RATSNEST_Vector) std::vector<RATSNEST_ITEM>;
 
+// std::list templates
+
+%include <std_list.i>
+%template(BOARD_CONNECTED_ITEM_List) std::list<BOARD_CONNECTED_ITEM*>;
+
 %extend BOARD
 {
     %pythoncode
@@ -28,7 +28,10 @@
  */
 
 
-%module pcbnew
+%module(threads="1") pcbnew
+
+// The Python interpreter lock is held by wrappers, unless stated otherwise
+%nothread;
 
 %feature("autodoc", "1");
 #ifdef ENABLE_DOCSTRINGS_FROM_DOXYGEN
@@ -105,9 +108,11 @@
   #include <class_zone_settings.h>
   #include <class_netclass.h>
   #include <class_netinfo.h>
+  #include <connectivity.h>
   #include <pcbnew_scripting_helpers.h>
 
   #include <plotcontroller.h>
+  #include <pcb_image_renderer.h>
   #include <pcb_plot_params.h>
   #include <exporters/gendrill_Excellon_writer.h>
   #include <colors.h>
@@ -144,8 +149,15 @@
 %include <class_zone_settings.h>
 %include <class_netclass.h>
 %include <class_netinfo.h>
+%include <connectivity.h>
 
 %include <plotcontroller.h>
+
+// Rendering does not touch Python objects, so boards may be rendered by several Python threads
+%thread PCB_IMAGE_RENDERER::Render;
+%thread PCB_IMAGE_RENDERER::SaveImage;
+%include <pcb_image_renderer.h>
+
 %include <pcb_plot_params.h>
 %include <plot_common.h>
 %include <exporters/gendrill_Excellon_writer.h>
@@ -34,6 +34,8 @@
 #include <pcbnew_id.h>
 #include <build_version.h>
 #include <class_board.h>
+#include <class_marker_pcb.h>
+#include <drc_stuff.h>
 #include <kicad_string.h>
 #include <io_mgr.h>
 #include <macros.h>
@@ -71,7 +73,13 @@ BOARD* LoadBoard( wxString& aFileName )
 
 BOARD* LoadBoard( wxString& aFileName, IO_MGR::PCB_FILE_T aFormat )
 {
-    return IO_MGR::Load( aFormat, aFileName );
+    BOARD* brd = IO_MGR::Load( aFormat, aFileName );
+
+    // Zone fillings are read from the file with the board, so they are up to date
+    if( brd )
+        brd->ClearZonesDirty();
+
+    return brd;
 }
 
 
@@ -107,3 +115,21 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+wxString TestTrackClearances( BOARD* aBoard, bool aUseIndex )
+{
+    DRC                         drc( aBoard );
+    std::vector<MARKER_PCB*>    markers;
+    wxString                    report;
+
+    drc.TestTrackClearances( markers, aUseIndex );
+
+    for( unsigned ii = 0; ii < markers.size(); ++ii )
+    {
+        report << markers[ii]->GetReporter().ShowReport();
+        delete markers[ii];
+    }
+
+    return report;
+}
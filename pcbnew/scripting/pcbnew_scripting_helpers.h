@@ -43,5 +43,14 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function TestTrackClearances
+ * runs the DRC track and via clearance tests on aBoard.
+ * @param aUseIndex = true to use the spatially indexed test, false to use the legacy
+ *                    sweep (for regression testing).
+ * @return the report of the markers found, one per line, in track list order.
+ */
+wxString TestTrackClearances( BOARD* aBoard, bool aUseIndex = true );
+
 
 #endif
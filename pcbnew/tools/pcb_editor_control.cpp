@@ -461,14 +461,8 @@ int PCB_EDITOR_CONTROL::ZoneFillAll( const TOOL_EVENT& aEvent )
     BOARD* board = getModel<BOARD>();
     RN_DATA* ratsnest = board->GetRatsnest();
 
-    for( int i = 0; i < board->GetAreaCount(); ++i )
-    {
-        ZONE_CONTAINER* zone = board->GetArea( i );
-        m_frame->Fill_Zone( zone );
-        zone->SetIsFilled( true );
-        ratsnest->Update( zone );
-        zone->ViewUpdate();
-    }
+    // Zones are filled concurrently, and the ratsnest is updated for each filled zone
+    m_frame->Fill_All_Zones( m_frame );
 
     ratsnest->Recalculate();
 
@@ -0,0 +1,156 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file union_find.h
+ * @brief Disjoint-set forest used to group connected items into clusters.
+ */
+
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * Class UNION_FIND
+ * is a disjoint-set forest (union by size, path halving) of items identified by their
+ * index. Merging two clusters and finding the cluster of an item take an amortized
+ * O(alpha(n)) time, instead of relabelling all the items of one of the clusters.
+ *
+ * Items can be added one by one (e.g. when a track is added to a net), but not removed:
+ * after a removal the clusters of the net have to be rebuilt.
+ */
+class UNION_FIND
+{
+public:
+    UNION_FIND( int aCount = 0 )
+    {
+        Reset( aCount );
+    }
+
+    /**
+     * Function Reset
+     * Removes all the items, then creates aCount items, each one in its own cluster.
+     */
+    void Reset( int aCount )
+    {
+        m_parent.resize( aCount );
+        m_size.assign( aCount, 1 );
+        m_clusters = aCount;
+
+        for( int i = 0; i < aCount; ++i )
+            m_parent[i] = i;
+    }
+
+    /**
+     * Function Add
+     * Adds a new item, in its own cluster.
+     * @return the index of the new item.
+     */
+    int Add()
+    {
+        int index = m_parent.size();
+
+        m_parent.push_back( index );
+        m_size.push_back( 1 );
+        ++m_clusters;
+
+        return index;
+    }
+
+    /**
+     * Function Find
+     * @return the representative item of the cluster containing aItem.
+     */
+    int Find( int aItem )
+    {
+        while( m_parent[aItem] != aItem )
+        {
+            m_parent[aItem] = m_parent[m_parent[aItem]];
+            aItem = m_parent[aItem];
+        }
+
+        return aItem;
+    }
+
+    /**
+     * Function Union
+     * Merges the clusters containing aFirst and aSecond.
+     * @return true if they were in different clusters.
+     */
+    bool Union( int aFirst, int aSecond )
+    {
+        aFirst = Find( aFirst );
+        aSecond = Find( aSecond );
+
+        if( aFirst == aSecond )
+            return false;
+
+        if( m_size[aFirst] < m_size[aSecond] )
+            std::swap( aFirst, aSecond );
+
+        m_parent[aSecond] = aFirst;
+        m_size[aFirst] += m_size[aSecond];
+        --m_clusters;
+
+        return true;
+    }
+
+    /**
+     * Function Connected
+     * @return true if aFirst and aSecond belong to the same cluster.
+     */
+    bool Connected( int aFirst, int aSecond )
+    {
+        return Find( aFirst ) == Find( aSecond );
+    }
+
+    /**
+     * Function ClusterSize
+     * @return the number of items in the cluster containing aItem.
+     */
+    int ClusterSize( int aItem )
+    {
+        return m_size[Find( aItem )];
+    }
+
+    ///> Returns the number of items.
+    int GetCount() const
+    {
+        return m_parent.size();
+    }
+
+    ///> Returns the number of clusters.
+    int GetClusterCount() const
+    {
+        return m_clusters;
+    }
+
+private:
+    std::vector<int> m_parent;
+    std::vector<int> m_size;
+    int m_clusters;
+};
+
+#endif /* UNION_FIND_H */
@@ -28,6 +28,7 @@
 
 
 #include <algorithm> // sort
+#include <memory>
 
 #include <fctsys.h>
 #include <trigo.h>
@@ -64,22 +65,58 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
     if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
         return 0;
 
+    if( aOutlineBuffer )
+    {
+        // Only the outline is wanted: keep the smoothed polygon for ourselves, because
+        // this zone can be filled by another thread in the meantime
+        std::auto_ptr<CPolyLine> smoothedPoly( buildSmoothedPoly() );
+
+        aOutlineBuffer->Append( ConvertPolyListToPolySet( smoothedPoly->m_CornersList ) );
+        return true;
+    }
+
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
+    delete m_smoothedPoly;
+    m_smoothedPoly = buildSmoothedPoly();
+
+    /* For copper layers, we now must add holes in the Polygon list.
+     * holes are pads and tracks with their clearance area
+     * for non copper layers just recalculate the m_FilledPolysList
+     * with m_ZoneMinThickness taken in account
+     */
+    m_FilledPolysList.RemoveAllContours();
+    ClearDirty();
+
+    if( IsOnCopperLayer() )
     {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
+        AddClearanceAreasPolygonsToPolysList_NG( aPcb );
     }
+    else
+    {
+        int margin = m_ZoneMinThickness / 2;
+        m_FilledPolysList = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
+        m_FilledPolysList.Inflate( -margin, 16 );
+        m_FilledPolysList.Fracture();
+    }
+
+    if( m_FillMode )   // if fill mode uses segments, create them:
+        FillZoneAreasWithSegments();
+
+    m_IsFilled = true;
+
+    return true;
+}
+
 
+CPolyLine* ZONE_CONTAINER::buildSmoothedPoly() const
+{
     switch( m_cornerSmoothingType )
     {
     case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
+        return m_Poly->Chamfer( m_cornerRadius );
 
     case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
 
     default:
         // Acute angles between adjacent edges can create issues in calculations,
@@ -87,41 +124,8 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
         // We can avoid issues by creating a very small chamfer which remove acute angles,
         // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
         // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
-    }
-
-    if( aOutlineBuffer )
-        aOutlineBuffer->Append( ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList ) );
-
-    /* For copper layers, we now must add holes in the Polygon list.
-     * holes are pads and tracks with their clearance area
-     * for non copper layers just recalculate the m_FilledPolysList
-     * with m_ZoneMinThickness taken in account
-     */
-    else
-    {
-        m_FilledPolysList.RemoveAllContours();
-
-        if( IsOnCopperLayer() )
-        {
-            AddClearanceAreasPolygonsToPolysList_NG( aPcb );
-        }
-        else
-        {
-            int margin = m_ZoneMinThickness / 2;
-            m_FilledPolysList = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
-            m_FilledPolysList.Inflate( -margin, 16 );
-            m_FilledPolysList.Fracture();
-        }
-
-        if( m_FillMode )   // if fill mode uses segments, create them:
-            FillZoneAreasWithSegments();
-
-        m_IsFilled = true;
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
     }
-
-    return true;
 }
 
 
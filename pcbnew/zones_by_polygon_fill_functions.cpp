@@ -26,17 +26,24 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <wx/progdlg.h>
+#include <set>
 
 #include <fctsys.h>
 #include <pgm_base.h>
 #include <class_drawpanel.h>
 #include <class_draw_panel_gal.h>
+#include <confirm.h>
 #include <ratsnest_data.h>
 #include <wxPcbStruct.h>
 #include <macros.h>
 
 #include <class_board.h>
+#include <class_module.h>
 #include <class_track.h>
 #include <class_zone.h>
 
@@ -127,62 +134,205 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 {
     int errorLevel = 0;
-    int areaCount = GetBoard()->GetAreaCount();
     wxBusyCursor dummyCursor;
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < GetBoard()->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
+
+        if( !zoneContainer->GetIsKeepout() )
+            zones.push_back( zoneContainer );
+    }
+
+    // Remove segment zones
+    GetBoard()->m_Zone.DeleteAll();
+
+    std::vector<ZONE_CONTAINER*> failedZones;
+
+    // All the zones are up to date, unless the fill is aborted
+    if( fillZones( zones, aActiveWindow, &failedZones ) )
+        GetBoard()->ClearZonesDirty();
+    else
+        errorLevel = 1;
+
+    TestConnections();
+
+    // Recalculate the active ratsnest, i.e. the unconnected links
+    TestForActiveLinksInRatsnest( 0 );
+
+    if( !failedZones.empty() )
+    {
+        errorLevel = 1;
+
+        if( aVerbose )
+        {
+            wxString msg = _( "The following zones cannot be filled (malformed outline):" );
+
+            for( unsigned ii = 0; ii < failedZones.size(); ii++ )
+            {
+                msg << wxT( "\n" ) << failedZones[ii]->GetSelectMenuText();
+            }
+
+            DisplayError( this, msg );
+        }
+    }
+
+    return errorLevel;
+}
+
+
+int PCB_EDIT_FRAME::Fill_Dirty_Zones( wxWindow* aActiveWindow )
+{
+    std::vector<ZONE_CONTAINER*> zones;
+
+    GetBoard()->GetDirtyZones( zones );
+
+    if( zones.empty() )
+        return 0;
+
+    wxBusyCursor dummyCursor;
+
+    fillZones( zones, aActiveWindow );
+
+    // Update the connectivity & the active ratsnest of the refilled nets only
+    std::set<int> netCodes;
+
+    for( unsigned ii = 0; ii < zones.size(); ii++ )
+        netCodes.insert( zones[ii]->GetNetCode() );
+
+    for( std::set<int>::const_iterator it = netCodes.begin(); it != netCodes.end(); ++it )
+        TestNetConnection( NULL, *it );
+
+    return zones.size();
+}
+
+
+bool PCB_EDIT_FRAME::fillZones( const std::vector<ZONE_CONTAINER*>& aZones,
+                                wxWindow* aActiveWindow,
+                                std::vector<ZONE_CONTAINER*>* aFailedZones )
+{
     wxString msg;
     wxProgressDialog * progressDialog = NULL;
 
+    // The zones are filled on working copies, so the board is only read while the
+    // fillings are calculated (by all the worker threads when OpenMP is enabled).
+    // The fillings are moved to the board zones by this thread afterwards.
+    std::vector<ZONE_CONTAINER*> workZones;
+
+    for( unsigned ii = 0; ii < aZones.size(); ii++ )
+    {
+        ZONE_CONTAINER* workZone = new ZONE_CONTAINER( *aZones[ii] );
+        workZone->UnFill();
+        workZones.push_back( workZone );
+    }
+
+    int zoneCount = aZones.size();
+
     // Create a message with a long net name, and build a wxProgressDialog
     // with a correct size to show this long net name
-    msg.Printf( FORMAT_STRING, 000, areaCount, wxT("XXXXXXXXXXXXXXXXX" ) );
+    msg.Printf( FORMAT_STRING, 000, zoneCount, wxT("XXXXXXXXXXXXXXXXX" ) );
 
     if( aActiveWindow )
         progressDialog = new wxProgressDialog( _( "Fill All Zones" ), msg,
-                                     areaCount+2, aActiveWindow,
+                                     zoneCount+2, aActiveWindow,
                                      wxPD_AUTO_HIDE | wxPD_CAN_ABORT |
                                      wxPD_APP_MODAL | wxPD_ELAPSED_TIME );
     // Display the actual message
     if( progressDialog )
         progressDialog->Update( 0, _( "Starting zone fill..." ) );
 
-    // Remove segment zones
-    GetBoard()->m_Zone.DeleteAll();
-
-    int ii;
+    // The bounding radius of pads is calculated on first use, so do it
+    // before the pads are shared by the worker threads
+    for( MODULE* module = GetBoard()->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+            pad->GetBoundingRadius();
+    }
 
-    for( ii = 0; ii < areaCount; ii++ )
+    std::vector<char> filled( zoneCount, 0 );   // filled[ii] != 0 once workZones[ii] is filled
+    std::vector<char> failed( zoneCount, 0 );   // failed[ii] != 0 if it cannot be filled
+    int  filledCount = 0;
+    bool aborted = false;
+    int  ii;
+
+    // The zone dump file cannot be written by several threads
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1) if( !g_DumpZonesWhenFilling )
+#endif /* USE_OPENMP */
+    for( ii = 0; ii < zoneCount; ii++ )
     {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
+        bool skip;
+        int  count;
+
+#ifdef USE_OPENMP
+        #pragma omp critical(zoneFillProgress)
+#endif /* USE_OPENMP */
+        skip = aborted;
+
+        if( skip )
             continue;
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+        if( !workZones[ii]->BuildFilledSolidAreasPolygons( GetBoard() ) )
+            failed[ii] = 1;
+
+        filled[ii] = 1;
+
+#ifdef USE_OPENMP
+        #pragma omp critical(zoneFillProgress)
+#endif /* USE_OPENMP */
+        count = ++filledCount;
+
+        // Only the thread running the event loop (the master thread) can use the dialog
+#ifdef USE_OPENMP
+        if( omp_get_thread_num() != 0 )
+            continue;
+#endif /* USE_OPENMP */
 
         if( progressDialog )
         {
-            if( !progressDialog->Update( ii+1, msg ) )
-                break;  // Aborted by user
+            msg.Printf( FORMAT_STRING, count, zoneCount, GetChars( aZones[ii]->GetNetname() ) );
+
+            if( !progressDialog->Update( count, msg ) )
+            {
+                // Aborted by user: the zones already filled are kept
+#ifdef USE_OPENMP
+                #pragma omp critical(zoneFillProgress)
+#endif /* USE_OPENMP */
+                aborted = true;
+            }
         }
-
-        errorLevel = Fill_Zone( zoneContainer );
-
-        if( errorLevel && !aVerbose )
-            break;
     }
 
     if( progressDialog )
     {
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( zoneCount+1, _( "Updating ratsnest..." ) );
 #ifdef __WXMAC__
         // Work around a dialog z-order issue on OS X
         aActiveWindow->Raise();
 #endif
     }
-    TestConnections();
 
-    // Recalculate the active ratsnest, i.e. the unconnected links
-    TestForActiveLinksInRatsnest( 0 );
+    for( ii = 0; ii < zoneCount; ii++ )
+    {
+        if( filled[ii] )
+        {
+            aZones[ii]->TakeFilledAreas( *workZones[ii] );
+            aZones[ii]->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+            GetBoard()->GetRatsnest()->Update( aZones[ii] );
+        }
+
+        if( failed[ii] && aFailedZones )
+            aFailedZones->push_back( aZones[ii] );
+
+        delete workZones[ii];
+    }
+
+    if( filledCount )
+        OnModify();
+
     if( progressDialog )
         progressDialog->Destroy();
-    return errorLevel;
+
+    return !aborted;
 }
@@ -0,0 +1,28 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+class TestDrcTrackClearances(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+
+    def test_indexed_matches_legacy(self):
+        indexed = TestTrackClearances(self.pcb, True)
+        legacy = TestTrackClearances(self.pcb, False)
+        self.assertEqual(indexed, legacy)
+
+    def test_indexed_matches_legacy_with_errors(self):
+        # shift every other track, so they get too close to their neighbours
+        for i, track in enumerate(self.pcb.GetTracks()):
+            if i % 2:
+                track.Move(wxPointMM(0.3, 0.2))
+
+        indexed = TestTrackClearances(self.pcb, True)
+        legacy = TestTrackClearances(self.pcb, False)
+        self.assertNotEqual(legacy, "")
+        self.assertEqual(indexed, legacy)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,46 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+class TestZoneDirtyTracking(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.zone = self.pcb.GetArea(0)
+
+    def find_track(self, layer):
+        area = self.zone.GetBoundingBox()
+
+        for track in self.pcb.GetTracks():
+            if track.Type() == PCB_TRACE_T and track.GetLayer() == layer \
+                    and area.Contains(track.GetStart()):
+                return track
+
+        return None
+
+    def test_loaded_zones_are_clean(self):
+        self.assertTrue(self.zone.IsFilled())
+        self.assertFalse(self.zone.IsDirty())
+
+    def test_removed_track_marks_zone(self):
+        track = self.find_track(self.zone.GetLayer())
+        self.assertNotEqual(track, None)
+
+        self.pcb.Remove(track)
+        self.assertTrue(self.zone.IsDirty())
+        self.assertTrue(self.zone.GetDirtyArea().Contains(track.GetStart()))
+
+        self.pcb.ClearZonesDirty()
+        self.assertFalse(self.zone.IsDirty())
+
+    def test_other_layer_does_not_mark_zone(self):
+        other = F_Cu if self.zone.GetLayer() == B_Cu else B_Cu
+        track = self.find_track(other)
+        self.assertNotEqual(track, None)
+
+        self.pcb.Remove(track)
+        self.assertFalse(self.zone.IsDirty())
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,59 @@
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+class TestConnectivity(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.connectivity = self.pcb.GetConnectivity()
+        # build the clusters from the loaded board items
+        self.connectivity.MarkDirty()
+
+    def find_track(self, netcode_to_avoid = -1):
+        for track in self.pcb.GetTracks():
+            if track.Type() == PCB_TRACE_T and track.GetNetCode() > 0 \
+                    and track.GetNetCode() != netcode_to_avoid:
+                return track
+
+        return None
+
+    def connected_items(self, item):
+        items = BOARD_CONNECTED_ITEM_List()
+        self.connectivity.GetConnectedItems(item, items, RN_ALL)
+        return list(items)
+
+    def test_track_is_connected_to_itself(self):
+        track = self.find_track()
+        self.assertNotEqual(track, None)
+        self.assertTrue(self.connectivity.AreConnected(track, track))
+
+    def test_other_net_is_not_connected(self):
+        track = self.find_track()
+        other = self.find_track(track.GetNetCode())
+        self.assertNotEqual(other, None)
+        self.assertFalse(self.connectivity.AreConnected(track, other))
+        self.assertFalse(self.connectivity.AreConnected(other, track))
+
+    def test_connected_items(self):
+        track = self.find_track()
+        items = self.connected_items(track)
+
+        self.assertTrue(len(items) > 1)
+        self.assertTrue(any(item.this == track.this for item in items))
+
+        for item in items:
+            self.assertEqual(item.GetNetCode(), track.GetNetCode())
+            self.assertTrue(self.connectivity.AreConnected(track, item))
+
+    def test_removed_track_is_not_connected(self):
+        track = self.find_track()
+        self.assertTrue(self.connectivity.GetClusterCode(track) > 0)
+
+        self.pcb.Remove(track)
+        self.assertEqual(self.connectivity.GetClusterCode(track), 0)
+        self.assertFalse(self.connectivity.AreConnected(track, track))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,78 @@
+import os
+import shutil
+import struct
+import tempfile
+import threading
+import unittest
+import pcbnew
+
+from pcbnew import *
+
+class TestImageRenderer(unittest.TestCase):
+
+    WIDTH = 640
+    HEIGHT = 480
+
+    def setUp(self):
+        self.tmpdir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def render(self, pcb, name):
+        filename = os.path.join(self.tmpdir, name)
+
+        renderer = PCB_IMAGE_RENDERER(self.WIDTH, self.HEIGHT)
+        renderer.DisplayBoard(pcb)
+        renderer.Render()
+        self.assertTrue(renderer.SaveImage(filename))
+
+        return filename
+
+    def read_png(self, filename):
+        self.assertTrue(os.path.isfile(filename))
+
+        f = open(filename, 'rb')
+        data = f.read()
+        f.close()
+
+        # PNG signature, then the IHDR chunk holding the image size
+        self.assertEqual(data[:8], b'\x89PNG\r\n\x1a\n')
+        self.assertEqual(data[12:16], b'IHDR')
+        self.assertEqual(struct.unpack('>II', data[16:24]), (self.WIDTH, self.HEIGHT))
+
+        return data
+
+    def test_render_to_png(self):
+        pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.read_png(self.render(pcb, "board.png"))
+
+    def test_render_from_threads(self):
+        boards = [ LoadBoard("data/complex_hierarchy.kicad_pcb") for i in range(2) ]
+        reference = self.read_png(self.render(boards[0], "reference.png"))
+
+        files = [ None, None ]
+        errors = []
+
+        def worker(index):
+            try:
+                files[index] = self.render(boards[index], "thread%d.png" % index)
+            except Exception as e:
+                errors.append(e)
+
+        threads = [ threading.Thread(target=worker, args=(i,)) for i in range(2) ]
+
+        for thread in threads:
+            thread.start()
+
+        for thread in threads:
+            thread.join()
+
+        self.assertEqual(errors, [])
+
+        # both boards are the same, so the images rendered in parallel match the reference
+        for filename in files:
+            self.assertEqual(self.read_png(filename), reference)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,334 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fracture_bench.cpp
+ * @brief Benchmark of SHAPE_POLY_SET::Fracture() on a zone-like polygon with many holes.
+ *
+ * The result is compared with the one of the original fracturing algorithm (testing
+ * all the edges for each hole), kept here as a reference.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include <geometry/shape_poly_set.h>
+#include <math/math_util.h>
+#include <profile.h>
+
+typedef SHAPE_POLY_SET::POLYGON POLYGON;
+
+
+struct REF_EDGE
+{
+    REF_EDGE( bool connected, const VECTOR2I& p1, const VECTOR2I& p2 ) :
+        m_connected( connected ),
+        m_p1( p1 ),
+        m_p2( p2 ),
+        m_next( NULL )
+    {
+    }
+
+    bool matches( int y ) const
+    {
+        return y >= std::min( m_p1.y, m_p2.y ) && y <= std::max( m_p1.y, m_p2.y );
+    }
+
+    bool m_connected;
+    VECTOR2I m_p1, m_p2;
+    REF_EDGE* m_next;
+};
+
+
+static int refProcessEdge( std::vector<REF_EDGE*>& edges, REF_EDGE* edge )
+{
+    int x = edge->m_p1.x;
+    int y = edge->m_p1.y;
+    int min_dist = std::numeric_limits<int>::max();
+    int x_nearest = 0;
+
+    REF_EDGE* e_nearest = NULL;
+
+    for( unsigned i = 0; i < edges.size(); ++i )
+    {
+        REF_EDGE* e = edges[i];
+
+        if( !e->matches( y ) )
+            continue;
+
+        int x_intersect;
+
+        if( e->m_p1.y == e->m_p2.y )
+            x_intersect = std::max( e->m_p1.x, e->m_p2.x );
+        else
+            x_intersect = e->m_p1.x + rescale( e->m_p2.x - e->m_p1.x, y - e->m_p1.y,
+                                               e->m_p2.y - e->m_p1.y );
+
+        int dist = x - x_intersect;
+
+        if( dist >= 0 && dist < min_dist && e->m_connected )
+        {
+            min_dist = dist;
+            x_nearest = x_intersect;
+            e_nearest = e;
+        }
+    }
+
+    if( !e_nearest )
+        return 0;
+
+    int count = 0;
+
+    REF_EDGE* lead1 = new REF_EDGE( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
+    REF_EDGE* lead2 = new REF_EDGE( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
+    REF_EDGE* split_2 = new REF_EDGE( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
+
+    edges.push_back( split_2 );
+    edges.push_back( lead1 );
+    edges.push_back( lead2 );
+
+    REF_EDGE* link = e_nearest->m_next;
+
+    e_nearest->m_p2 = VECTOR2I( x_nearest, y );
+    e_nearest->m_next = lead1;
+    lead1->m_next = edge;
+
+    REF_EDGE* last;
+
+    for( last = edge; last->m_next != edge; last = last->m_next )
+    {
+        last->m_connected = true;
+        count++;
+    }
+
+    last->m_connected = true;
+    last->m_next = lead2;
+    lead2->m_next = split_2;
+    split_2->m_next = link;
+
+    return count + 1;
+}
+
+
+///> The original (quadratic) fracturing algorithm
+static void refFracture( POLYGON& paths )
+{
+    if( paths.size() == 1 )
+        return;
+
+    std::vector<REF_EDGE*> edges, border_edges;
+    REF_EDGE* root = NULL;
+    int num_unconnected = 0;
+
+    for( unsigned p = 0; p < paths.size(); p++ )
+    {
+        const SHAPE_LINE_CHAIN& path = paths[p];
+        REF_EDGE *prev = NULL, *first_edge = NULL;
+        int x_min = std::numeric_limits<int>::max();
+
+        for( int i = 0; i < path.PointCount(); i++ )
+            x_min = std::min( x_min, path.CPoint( i ).x );
+
+        for( int i = 0; i < path.PointCount(); i++ )
+        {
+            REF_EDGE* fe = new REF_EDGE( p == 0, path.CPoint( i ), path.CPoint( i + 1 ) );
+
+            if( !root )
+                root = fe;
+
+            if( !first_edge )
+                first_edge = fe;
+
+            if( prev )
+                prev->m_next = fe;
+
+            if( i == path.PointCount() - 1 )
+                fe->m_next = first_edge;
+
+            prev = fe;
+            edges.push_back( fe );
+
+            if( p != 0 && fe->m_p1.x == x_min )
+                border_edges.push_back( fe );
+
+            if( !fe->m_connected )
+                num_unconnected++;
+        }
+    }
+
+    while( num_unconnected > 0 )
+    {
+        int x_min = std::numeric_limits<int>::max();
+        REF_EDGE* smallestX = NULL;
+
+        for( unsigned i = 0; i < border_edges.size(); ++i )
+        {
+            if( border_edges[i]->m_p1.x < x_min && !border_edges[i]->m_connected )
+            {
+                x_min = border_edges[i]->m_p1.x;
+                smallestX = border_edges[i];
+            }
+        }
+
+        int count = smallestX ? refProcessEdge( edges, smallestX ) : 0;
+
+        if( count == 0 )
+            break;
+
+        num_unconnected -= count;
+    }
+
+    SHAPE_LINE_CHAIN newPath;
+    REF_EDGE* e;
+
+    newPath.SetClosed( true );
+
+    for( e = root; e->m_next != root; e = e->m_next )
+        newPath.Append( e->m_p1 );
+
+    newPath.Append( e->m_p1 );
+
+    for( unsigned i = 0; i < edges.size(); ++i )
+        delete edges[i];
+
+    paths.clear();
+    paths.push_back( newPath );
+}
+
+
+///> Builds a square outline with a aGrid x aGrid array of round holes (like a zone
+///> around a BGA or a via stitching array)
+static void buildZone( SHAPE_POLY_SET& aPoly, int aGrid )
+{
+    const int pitch = 1000000;  // 1 mm
+    const int radius = 300000;
+    const int segs = 16;
+    const int size = ( aGrid + 1 ) * pitch;
+
+    aPoly.NewOutline();
+    aPoly.Append( 0, 0 );
+    aPoly.Append( size, 0 );
+    aPoly.Append( size, size );
+    aPoly.Append( 0, size );
+
+    for( int i = 0; i < aGrid; i++ )
+    {
+        for( int j = 0; j < aGrid; j++ )
+        {
+            // a small offset per column, so the holes are not perfectly aligned
+            int cx = ( i + 1 ) * pitch + ( j % 7 ) * 1000;
+            int cy = ( j + 1 ) * pitch;
+
+            aPoly.NewHole();
+
+            for( int k = 0; k < segs; k++ )
+            {
+                double a = 2.0 * M_PI * k / segs;
+
+                aPoly.Append( cx + (int) floor( radius * cos( a ) + 0.5 ),
+                              cy + (int) floor( radius * sin( a ) + 0.5 ), -1,
+                              aPoly.HoleCount( 0 ) - 1 );
+            }
+        }
+    }
+}
+
+
+static bool samePolySets( SHAPE_POLY_SET& aA, SHAPE_POLY_SET& aB )
+{
+    if( aA.OutlineCount() != aB.OutlineCount() )
+        return false;
+
+    for( int i = 0; i < aA.OutlineCount(); i++ )
+    {
+        const POLYGON& pa = aA.CPolygon( i );
+        const POLYGON& pb = aB.CPolygon( i );
+
+        if( pa.size() != pb.size() )
+            return false;
+
+        for( unsigned j = 0; j < pa.size(); j++ )
+        {
+            if( pa[j].PointCount() != pb[j].PointCount() )
+                return false;
+
+            for( int k = 0; k < pa[j].PointCount(); k++ )
+            {
+                if( pa[j].CPoint( k ) != pb[j].CPoint( k ) )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int main( int argc, char** argv )
+{
+    int grid = argc > 1 ? atoi( argv[1] ) : 100;
+    bool checkRef = !( argc > 2 && argv[2][0] == 'n' );
+
+    SHAPE_POLY_SET zone;
+    buildZone( zone, grid );
+
+    printf( "Fracturing a zone with %d holes\n", zone.HoleCount( 0 ) );
+
+    SHAPE_POLY_SET fractured( zone );
+    prof_counter cnt;
+
+    prof_start( &cnt );
+    fractured.Fracture();
+    prof_end( &cnt );
+
+    printf( "Fracture():           %.1f ms, %d outline(s)\n", cnt.msecs(), fractured.OutlineCount() );
+
+    if( !checkRef )
+        return 0;
+
+    SHAPE_POLY_SET reference( zone );
+
+    prof_start( &cnt );
+    reference.Simplify();
+
+    for( int i = 0; i < reference.OutlineCount(); i++ )
+        refFracture( reference.Polygon( i ) );
+
+    prof_end( &cnt );
+
+    printf( "reference algorithm:  %.1f ms\n", cnt.msecs() );
+
+    if( !samePolySets( fractured, reference ) )
+    {
+        printf( "ERROR: results differ from the reference algorithm\n" );
+        return 1;
+    }
+
+    printf( "results match the reference algorithm\n" );
+
+    return 0;
+}
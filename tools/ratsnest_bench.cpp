@@ -0,0 +1,148 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file ratsnest_bench.cpp
+ * @brief Benchmark of the ratsnest update while a footprint is dragged.
+ *
+ * A synthetic board with a grid of footprints is created, then one of them is moved
+ * step by step, updating the ratsnest after each step (as the interactive tools do).
+ * Time and the number of heap allocations are reported.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_netinfo.h>
+#include <ratsnest_data.h>
+#include <profile.h>
+
+static unsigned long long allocCount = 0;
+
+void* operator new( std::size_t aSize ) throw( std::bad_alloc )
+{
+    ++allocCount;
+
+    void* ptr = malloc( aSize ? aSize : 1 );
+
+    if( !ptr )
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+
+void operator delete( void* aPtr ) throw()
+{
+    free( aPtr );
+}
+
+
+///> Creates a aGrid x aGrid array of footprints, each one having aPads pads. The pads with
+///> the same index belong to the same net, so every net spans all the footprints.
+static void buildBoard( BOARD* aBoard, int aGrid, int aPads )
+{
+    const int pitch = 5000000;      // 5 mm between footprints
+    const int padPitch = 500000;    // 0.5 mm between pads
+
+    for( int net = 1; net <= aPads; ++net )
+        aBoard->AppendNet( new NETINFO_ITEM( aBoard, wxString::Format( wxT( "N%d" ), net ), net ) );
+
+    for( int i = 0; i < aGrid; ++i )
+    {
+        for( int j = 0; j < aGrid; ++j )
+        {
+            MODULE* module = new MODULE( aBoard );
+            wxPoint pos( i * pitch, j * pitch );
+
+            for( int p = 0; p < aPads; ++p )
+            {
+                D_PAD* pad = new D_PAD( module );
+                wxPoint offset( ( p % 4 ) * padPitch, ( p / 4 ) * padPitch );
+
+                pad->SetShape( PAD_RECT );
+                pad->SetSize( wxSize( padPitch / 2, padPitch / 2 ) );
+                pad->SetLayerSet( D_PAD::SMDMask() );
+                pad->SetPos0( offset );
+                pad->SetPosition( pos + offset );
+                pad->SetNetCode( p + 1 );
+                module->Add( pad );
+            }
+
+            module->SetPosition( pos );
+            aBoard->Add( module );
+        }
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+    int grid  = argc > 1 ? atoi( argv[1] ) : 30;
+    int pads  = argc > 2 ? atoi( argv[2] ) : 16;
+    int steps = argc > 3 ? atoi( argv[3] ) : 200;
+
+    BOARD board;
+    buildBoard( &board, grid, pads );
+
+    RN_DATA* ratsnest = board.GetRatsnest();
+    prof_counter cnt;
+
+    unsigned long long allocs = allocCount;
+    prof_start( &cnt );
+    ratsnest->ProcessBoard();
+    ratsnest->Recalculate();
+    prof_end( &cnt );
+
+    printf( "%d footprints, %d nets\n", grid * grid, pads );
+    printf( "initial ratsnest:  %.1f ms, %llu allocations\n", cnt.msecs(), allocCount - allocs );
+
+    // Drag the footprint in the middle of the board
+    MODULE* module = board.m_Modules;
+
+    for( int i = 0; i < ( grid * grid ) / 2; ++i )
+        module = module->Next();
+
+    allocs = allocCount;
+    prof_start( &cnt );
+
+    for( int i = 0; i < steps; ++i )
+    {
+        module->Move( wxPoint( i % 2 ? -100000 : 100000, 50000 ) );
+        ratsnest->Update( module );
+        ratsnest->Recalculate();
+    }
+
+    prof_end( &cnt );
+
+    printf( "%d drag steps:     %.1f ms (%.2f ms/step), %llu allocations/step\n", steps,
+            cnt.msecs(), cnt.msecs() / steps, ( allocCount - allocs ) / steps );
+    printf( "unconnected:       %d\n", ratsnest->GetUnconnectedCount() );
+
+    return 0;
+}
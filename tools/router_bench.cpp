@@ -0,0 +1,384 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file router_bench.cpp
+ * @brief Replays a recorded routing session through the router, without the GUI.
+ *
+ * The board is loaded from a .kicad_pcb file and the router commands are read from an
+ * event log saved by PNS_ROUTER::DumpLog() (in debug builds, the '9' key starts recording
+ * the commands in the router tool and pressing it again saves them, see
+ * PNS_ROUTER::RecordEvents()). The latency of the commands, the number of shove iterations
+ * and a hash of the resulting tracks and vias are reported, so that the router performance
+ * and results can be compared between versions.
+ *
+ * Before the replay, the joint lookups and the line assembly (the basic operations of the
+ * dragger and the shove) are timed on all the segments of the board.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <set>
+
+#include <boost/foreach.hpp>
+
+#include <fctsys.h>
+#include <macros.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <io_mgr.h>
+#include <ratsnest_data.h>
+#include <profile.h>
+
+#include <router/pns_router.h>
+#include <router/pns_logger.h>
+#include <router/pns_itemset.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+#include <router/pns_line.h>
+
+static const char* eventNames[] =
+{
+    "start route",
+    "start drag",
+    "move",
+    "fix",
+    "stop",
+    "switch layer",
+    "toggle via",
+    "flip posture",
+    "sizes"
+};
+
+static const int EVENT_TYPES = sizeof( eventNames ) / sizeof( eventNames[0] );
+
+
+///> Finds the item recorded with an event, among the items under the event position.
+static PNS_ITEM* findItem( PNS_ROUTER* aRouter, const PNS_LOGGER::EVENT_ENTRY& aEvent )
+{
+    if( !aEvent.itemKind )
+        return NULL;
+
+    PNS_ITEMSET items = aRouter->QueryHoverItems( aEvent.p );
+
+    BOOST_FOREACH( PNS_ITEM* item, items.Items() )
+    {
+        if( item->Kind() == aEvent.itemKind && item->Net() == aEvent.itemNet
+                && item->Layers().Start() == aEvent.itemLayer )
+            return item;
+    }
+
+    return NULL;
+}
+
+
+static void replayEvent( PNS_ROUTER* aRouter, const PNS_LOGGER::EVENT_ENTRY& aEvent )
+{
+    switch( aEvent.type )
+    {
+    case PNS_LOGGER::EVT_START_ROUTE:
+        aRouter->SyncWorld();
+        aRouter->SetMode( (PNS_ROUTER_MODE) aEvent.args[1] );
+        aRouter->Settings().SetMode( (PNS_MODE) aEvent.args[2] );
+        aRouter->EnableSnapping( aEvent.args[3] );
+        aRouter->StartRouting( aEvent.p, findItem( aRouter, aEvent ), aEvent.args[0] );
+        break;
+
+    case PNS_LOGGER::EVT_START_DRAG:
+        aRouter->SyncWorld();
+        aRouter->Settings().SetMode( (PNS_MODE) aEvent.args[0] );
+        aRouter->EnableSnapping( aEvent.args[1] );
+        aRouter->StartDragging( aEvent.p, findItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_MOVE:
+        aRouter->Move( aEvent.p, findItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_FIX:
+        aRouter->FixRoute( aEvent.p, findItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_STOP:
+        aRouter->StopRouting();
+        break;
+
+    case PNS_LOGGER::EVT_SWITCH_LAYER:
+        aRouter->SwitchLayer( aEvent.args[0] );
+        break;
+
+    case PNS_LOGGER::EVT_TOGGLE_VIA:
+        aRouter->ToggleViaPlacement();
+        break;
+
+    case PNS_LOGGER::EVT_FLIP_POSTURE:
+        aRouter->FlipPosture();
+        break;
+
+    case PNS_LOGGER::EVT_SIZES:
+    {
+        PNS_SIZES_SETTINGS sizes( aRouter->Sizes() );
+
+        sizes.SetTrackWidth( aEvent.args[0] );
+        sizes.SetViaDiameter( aEvent.args[1] );
+        sizes.SetViaDrill( aEvent.args[2] );
+        aRouter->UpdateSizes( sizes );
+        break;
+    }
+    }
+}
+
+
+///> Hash of the tracks and vias of the board, independent of their order in the board list.
+static unsigned long long geometryHash( BOARD* aBoard )
+{
+    std::vector<std::vector<int> > tracks;
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        std::vector<int> t;
+
+        t.push_back( track->Type() );
+        t.push_back( track->GetStart().x );
+        t.push_back( track->GetStart().y );
+        t.push_back( track->GetEnd().x );
+        t.push_back( track->GetEnd().y );
+        t.push_back( track->GetWidth() );
+        t.push_back( track->GetNetCode() );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            LAYER_ID top, bottom;
+
+            static_cast<VIA*>( track )->LayerPair( &top, &bottom );
+            t.push_back( top );
+            t.push_back( bottom );
+        }
+        else
+        {
+            t.push_back( track->GetLayer() );
+        }
+
+        tracks.push_back( t );
+    }
+
+    std::sort( tracks.begin(), tracks.end() );
+
+    // FNV-1a
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for( unsigned i = 0; i < tracks.size(); ++i )
+    {
+        for( unsigned j = 0; j < tracks[i].size(); ++j )
+        {
+            unsigned int v = tracks[i][j];
+
+            for( int k = 0; k < 4; ++k )
+            {
+                hash ^= ( v >> ( 8 * k ) ) & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        }
+    }
+
+    return hash;
+}
+
+
+///> Times FindJoint() and AssembleLine() for all the segments of the world.
+static void benchmarkWorld( PNS_ROUTER* aRouter, BOARD* aBoard )
+{
+    const int repeats = 10;
+    PNS_NODE* world = aRouter->GetWorld();
+    std::vector<PNS_SEGMENT*> segs;
+    prof_counter cnt;
+
+    for( unsigned net = 0; net < aBoard->GetNetCount(); net++ )
+    {
+        std::set<PNS_ITEM*> items;
+
+        world->AllItemsInNet( net, items );
+
+        BOOST_FOREACH( PNS_ITEM* item, items )
+        {
+            if( item->OfKind( PNS_ITEM::SEGMENT ) )
+                segs.push_back( static_cast<PNS_SEGMENT*>( item ) );
+        }
+    }
+
+    if( segs.empty() )
+        return;
+
+    int found = 0;
+
+    prof_start( &cnt );
+
+    for( int r = 0; r < repeats; r++ )
+    {
+        BOOST_FOREACH( PNS_SEGMENT* seg, segs )
+        {
+            if( world->FindJoint( seg->Seg().A, seg ) )
+                found++;
+
+            if( world->FindJoint( seg->Seg().B, seg ) )
+                found++;
+        }
+    }
+
+    prof_end( &cnt );
+
+    printf( "joint lookups:     %d, %.1f ns/lookup (%d found)\n", 2 * repeats * (int) segs.size(),
+            cnt.usecs() * 1000.0 / ( 2 * repeats * segs.size() ), found );
+
+    int points = 0;
+
+    prof_start( &cnt );
+
+    for( int r = 0; r < repeats; r++ )
+    {
+        BOOST_FOREACH( PNS_SEGMENT* seg, segs )
+        {
+            PNS_LINE line = world->AssembleLine( seg );
+
+            points += line.PointCount();
+        }
+    }
+
+    prof_end( &cnt );
+
+    printf( "line assembly:     %d, %.2f us/line (%d points)\n", repeats * (int) segs.size(),
+            (double) cnt.usecs() / ( repeats * segs.size() ), points );
+}
+
+
+static double percentile( const std::vector<double>& aSorted, double aFraction )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    unsigned idx = (unsigned) ( aFraction * ( aSorted.size() - 1 ) + 0.5 );
+
+    return aSorted[idx];
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+    {
+        printf( "usage: %s board.kicad_pcb [events.log]\n", argv[0] );
+        return 1;
+    }
+
+    std::vector<PNS_LOGGER::EVENT_ENTRY> events;
+
+    if( argc > 2 && !PNS_LOGGER::LoadEvents( argv[2], events ) )
+    {
+        printf( "Can't read the events from '%s'\n", argv[2] );
+        return 1;
+    }
+
+    BOARD* board = NULL;
+
+    try
+    {
+        board = IO_MGR::Load( IO_MGR::KICAD, FROM_UTF8( argv[1] ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        printf( "Can't load '%s': %s\n", argv[1], TO_UTF8( ioe.errorText ) );
+        return 1;
+    }
+
+    board->GetRatsnest()->ProcessBoard();
+
+    std::vector<double> latency[EVENT_TYPES];
+    std::vector<double> all;
+    prof_counter cnt;
+
+    {
+        PNS_ROUTER router;
+
+        router.ClearWorld();
+        router.SetBoard( board );
+
+        prof_start( &cnt );
+        router.SyncWorld();
+        prof_end( &cnt );
+
+        printf( "world sync:        %.1f ms\n", cnt.msecs() );
+
+        benchmarkWorld( &router, board );
+
+        // the optimizer time limit would make the results depend on the machine load
+        PNS_ROUTING_SETTINGS settings;
+        settings.SetOptimizerTimeLimit( 0 );
+        router.LoadSettings( settings );
+
+        for( unsigned i = 0; i < events.size(); ++i )
+        {
+            const PNS_LOGGER::EVENT_ENTRY& evt = events[i];
+
+            if( evt.type < 0 || evt.type >= EVENT_TYPES )
+                continue;
+
+            prof_start( &cnt );
+            replayEvent( &router, evt );
+            prof_end( &cnt );
+
+            latency[evt.type].push_back( cnt.msecs() );
+            all.push_back( cnt.msecs() );
+        }
+
+        router.StopRouting();
+
+        printf( "%d events replayed\n", (int) all.size() );
+        printf( "%-16s %8s %10s %10s %10s %10s\n", "event", "count", "p50 [ms]", "p90 [ms]",
+                "p99 [ms]", "max [ms]" );
+
+        for( int t = 0; t <= EVENT_TYPES; ++t )
+        {
+            std::vector<double>& l = ( t < EVENT_TYPES ) ? latency[t] : all;
+
+            if( l.empty() )
+                continue;
+
+            std::sort( l.begin(), l.end() );
+
+            printf( "%-16s %8d %10.2f %10.2f %10.2f %10.2f\n",
+                    t < EVENT_TYPES ? eventNames[t] : "all", (int) l.size(),
+                    percentile( l, 0.5 ), percentile( l, 0.9 ), percentile( l, 0.99 ),
+                    l.back() );
+        }
+
+        printf( "shove iterations:  %lld\n", router.ShoveIterations() );
+    }
+
+    printf( "geometry hash:     %016llx\n", geometryHash( board ) );
+
+    delete board;
+
+    return 0;
+}